@@ -2,13 +2,23 @@
  * @file error.c
  * @brief 错误处理源文件
  * @author Jia Zhenyu
- * @date 2025-05-05
- * @version 1.0.1
+ * @date 2026-10-16
+ * @version 1.1.0
  */
 
 #include <stdio.h>
 #include "error.h"
 
+#ifdef ERROR_TPRINTF
+/**
+ * @brief tprintf 的输出函数，直接写入文件
+ */
+static void error_sink(void *ctx, const char *s, unsigned int len)
+{
+    fwrite(s, 1, len, (FILE *)ctx);
+}
+#endif
+
 /**
  * @brief 错误处理函数（弱定义）
  *        该函数用于处理错误信息，可以根据需要进行重定义
@@ -22,8 +32,13 @@ __attribute__((weak)) void error_handle(ERRORType err)
         // fprintf(stdout, "[Error %d]: %s at \"%s\":[%d] in function [%s]\r\n",
         //         err.code, err.message, err.file, err.line, err.function);
 
+#ifdef ERROR_TPRINTF
+        tprintf_format(error_sink, stderr, "[Error %d]: %s at \"%s\":[%d] in function [%s]\r\n",
+                       err.code, err.message, err.file, err.line, err.function);
+#else
         fprintf(stderr, "[Error %d]: %s at \"%s\":[%d] in function [%s]\r\n",
                 err.code, err.message, err.file, err.line, err.function);
+#endif
 
         // 彩色输出
         // fprintf(stdout, "\033[31m[Error %d]: %s at \"%s\":[%d] in function [%s]\033[0m\r\n",
@@ -2,8 +2,8 @@
  * @file error.h
  * @brief 错误处理头文件
  * @author Jia Zhenyu
- * @date 2025-05-05
- * @version 1.0.1
+ * @date 2026-10-16
+ * @version 1.1.0
  */
 
 #ifndef __ERROR_H__
@@ -21,6 +21,16 @@ extern "C"
 #define ERROR_MSG_BUFFER_SIZE 256
 #endif
 
+/* 定义 ERROR_TPRINTF 后错误消息使用 tprintf 格式化（只支持整数），需要编译 tprintf.c */
+// #define ERROR_TPRINTF
+
+#ifdef ERROR_TPRINTF
+#include "tprintf.h"
+#define ERROR_SNPRINTF tprintf_snprintf
+#else
+#define ERROR_SNPRINTF snprintf
+#endif
+
 /* 常用错误类型宏定义 */
 // 通用错误
 #define ERROR_NONE 0                 // 无错误
@@ -65,7 +75,7 @@ extern "C"
         if (!(expr))                                                                    \
         {                                                                               \
             char _err_msg_buf[ERROR_MSG_BUFFER_SIZE];                                   \
-            snprintf(_err_msg_buf, sizeof(_err_msg_buf), (fmt), ##__VA_ARGS__);         \
+            ERROR_SNPRINTF(_err_msg_buf, sizeof(_err_msg_buf), (fmt), ##__VA_ARGS__);   \
             ERRORType err = {err_code, _err_msg_buf, __FILE__, __FUNCTION__, __LINE__}; \
             error_handle(err);                                                          \
         }                                                                               \
@@ -77,7 +87,7 @@ extern "C"
     do                                                                              \
     {                                                                               \
         char _err_msg_buf[ERROR_MSG_BUFFER_SIZE];                                   \
-        snprintf(_err_msg_buf, sizeof(_err_msg_buf), (fmt), ##__VA_ARGS__);         \
+        ERROR_SNPRINTF(_err_msg_buf, sizeof(_err_msg_buf), (fmt), ##__VA_ARGS__);   \
         ERRORType err = {err_code, _err_msg_buf, __FILE__, __FUNCTION__, __LINE__}; \
         error_handle(err);                                                          \
     } while (0)
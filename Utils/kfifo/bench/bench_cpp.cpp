@@ -0,0 +1,124 @@
+/*
+ * bench_cpp.cpp
+ * mcu::kfifo<T, N> (kfifo.hpp) against the kfifo.h macros on a fifo of the
+ * same size: push()/pop() against kfifo_put()/kfifo_get() with uint32_t
+ * elements, push_bulk()/pop_bulk() against kfifo_in()/kfifo_out() with
+ * bytes. The macro loops live in bench_cpp_c.c and are built as C.
+ *
+ * Build (Linux):
+ *   gcc -O2 -std=gnu11 -I.. -c bench_cpp_c.c ../kfifo.c
+ *   g++ -O2 -std=c++17 -I.. bench_cpp.cpp bench_cpp_c.o kfifo.o -o bench_cpp
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <ctime>
+#include "kfifo.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLES() __rdtsc()
+#define UNIT "cycles"
+#else
+static inline uint64_t ns_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#define CYCLES() ns_now()
+#define UNIT "ns"
+#endif
+
+#define FIFO_SIZE 256
+#define ROUNDS 20000000U
+
+extern "C" unsigned int bench_c_put_get(unsigned int rounds);
+extern "C" unsigned int bench_c_in_out(unsigned int rounds, unsigned int n);
+
+static mcu::kfifo<uint32_t, FIFO_SIZE> fifo32;
+static mcu::kfifo<uint8_t, FIFO_SIZE> fifo8;
+
+/* keep the compiler from optimizing the loops away */
+static volatile unsigned int sink;
+
+__attribute__((noinline)) static unsigned int bench_cpp_put_get(unsigned int rounds)
+{
+    unsigned int r, ret = 0;
+    uint32_t v = 0;
+
+    fifo32.reset();
+    for (r = 0; r < rounds; r++)
+    {
+        ret += fifo32.push(r);
+        ret += fifo32.pop(v);
+        ret += v != r;
+    }
+    return ret;
+}
+
+__attribute__((noinline)) static unsigned int bench_cpp_in_out(unsigned int rounds, unsigned int n)
+{
+    unsigned char src[64], dst[64];
+    unsigned int r, ret = 0;
+
+    fifo8.reset();
+    memset(src, 0x5a, sizeof(src));
+    for (r = 0; r < rounds; r++)
+    {
+        ret += fifo8.push_bulk(src, n);
+        ret += fifo8.pop_bulk(dst, n);
+    }
+    return ret + (memcmp(src, dst, n) != 0);
+}
+
+static double per_round(uint64_t t0, uint64_t t1)
+{
+    return (double)(t1 - t0) / ROUNDS;
+}
+
+int main(void)
+{
+    static const unsigned int lens[] = {1, 8, 64};
+    uint64_t t0, t1;
+    double c, cpp;
+    unsigned int i, ret;
+
+    printf("%s per round (C macros -> C++ wrapper)\n", UNIT);
+
+    t0 = CYCLES();
+    ret = bench_c_put_get(ROUNDS);
+    t1 = CYCLES();
+    c = per_round(t0, t1);
+    t0 = CYCLES();
+    ret += bench_cpp_put_get(ROUNDS);
+    t1 = CYCLES();
+    cpp = per_round(t0, t1);
+    if (ret != 4 * ROUNDS)
+        printf("data error for put/get\n");
+    printf("%-22s %7.2f -> %7.2f\n", "put + get (u32)", c, cpp);
+
+    for (i = 0; i < sizeof(lens) / sizeof(lens[0]); i++)
+    {
+        char name[32];
+
+        t0 = CYCLES();
+        ret = bench_c_in_out(ROUNDS, lens[i]);
+        t1 = CYCLES();
+        c = per_round(t0, t1);
+        t0 = CYCLES();
+        ret += bench_cpp_in_out(ROUNDS, lens[i]);
+        t1 = CYCLES();
+        cpp = per_round(t0, t1);
+        if (ret != 4 * ROUNDS * lens[i])
+            printf("data error for n = %u\n", lens[i]);
+
+        snprintf(name, sizeof(name), "in + out, n = %u", lens[i]);
+        printf("%-22s %7.2f -> %7.2f\n", name, c, cpp);
+    }
+
+    sink = ret;
+    return 0;
+}
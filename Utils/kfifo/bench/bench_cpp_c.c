@@ -0,0 +1,47 @@
+/*
+ * bench_cpp_c.c
+ * C half of bench_cpp.cpp: the same loops with the kfifo.h macros, which
+ * only compile as C.
+ *
+ * Build: see bench_cpp.cpp
+ */
+
+#include <string.h>
+#include "kfifo.h"
+
+#define FIFO_SIZE 256
+
+static DECLARE_KFIFO(fifo32, uint32_t, FIFO_SIZE);
+static DECLARE_KFIFO(fifo8, uint8_t, FIFO_SIZE);
+
+/* one kfifo_put() and one kfifo_get() per round */
+unsigned int bench_c_put_get(unsigned int rounds)
+{
+    unsigned int r, ret = 0;
+    uint32_t v = 0;
+
+    INIT_KFIFO(fifo32);
+    for (r = 0; r < rounds; r++)
+    {
+        ret += kfifo_put(&fifo32, r);
+        ret += kfifo_get(&fifo32, &v);
+        ret += v != r;
+    }
+    return ret;
+}
+
+/* one kfifo_in() and one kfifo_out() of @n bytes per round */
+unsigned int bench_c_in_out(unsigned int rounds, unsigned int n)
+{
+    unsigned char src[64], dst[64];
+    unsigned int r, ret = 0;
+
+    INIT_KFIFO(fifo8);
+    memset(src, 0x5a, sizeof(src));
+    for (r = 0; r < rounds; r++)
+    {
+        ret += kfifo_in(&fifo8, src, n);
+        ret += kfifo_out(&fifo8, dst, n);
+    }
+    return ret + (memcmp(src, dst, n) != 0);
+}
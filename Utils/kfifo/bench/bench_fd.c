@@ -0,0 +1,111 @@
+/*
+ * bench_fd.c
+ * Streaming a byte fifo into a pipe (like a host tool forwarding a UART
+ * capture): kfifo_out() into a bounce buffer followed by write(), against
+ * kfifo_out_fd() handing both parts of the fifo to one writev(), in MB/s.
+ * A reader thread drains the pipe, the fifo wraps on most rounds.
+ *
+ * Build (Linux), optionally with -DKFIFO_SMP:
+ *   gcc -O2 -std=gnu11 -pthread -I.. bench_fd.c ../kfifo_linux.c ../kfifo.c -o bench_fd
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "kfifo_linux.h"
+
+#define FIFO_SIZE 65536
+#define CHUNK 12000
+#define TOTAL (256U << 20)
+
+static DECLARE_KFIFO(fifo, unsigned char, FIFO_SIZE);
+
+static unsigned char chunk[CHUNK];
+static unsigned char bounce[FIFO_SIZE];
+
+static double now_sec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void *drain(void *arg)
+{
+    static unsigned char buf[FIFO_SIZE];
+    int fd = *(int *)arg;
+
+    while (read(fd, buf, sizeof(buf)) > 0)
+        ;
+    return NULL;
+}
+
+/* the pipe is blocking, partial writes only happen on signals */
+static void write_all(int fd, const unsigned char *p, unsigned int len)
+{
+    ssize_t n;
+
+    while (len)
+    {
+        n = write(fd, p, len);
+        if (n <= 0)
+            return;
+        p += n;
+        len -= (unsigned int)n;
+    }
+}
+
+static double run(int use_fd)
+{
+    pthread_t th;
+    unsigned int sent = 0, n;
+    ssize_t w;
+    double t;
+    int fd[2];
+
+    if (pipe(fd))
+        return 0;
+    INIT_KFIFO(fifo);
+    pthread_create(&th, NULL, drain, &fd[0]);
+
+    t = now_sec();
+    while (sent < TOTAL)
+    {
+        while (kfifo_avail(&fifo) >= CHUNK)
+            kfifo_in(&fifo, chunk, CHUNK);
+
+        if (use_fd)
+        {
+            w = kfifo_out_fd(&fifo, fd[1], ~0U);
+            n = w > 0 ? (unsigned int)w : 0;
+        }
+        else
+        {
+            n = kfifo_out(&fifo, bounce, sizeof(bounce));
+            write_all(fd[1], bounce, n);
+        }
+        sent += n;
+    }
+    t = now_sec() - t;
+
+    close(fd[1]);
+    pthread_join(th, NULL);
+    close(fd[0]);
+
+    return sent / t / 1e6;
+}
+
+int main(void)
+{
+    double copy, vec;
+
+    printf("fifo -> pipe, %u MB, MB/s (kfifo_out + write -> kfifo_out_fd)\n", TOTAL >> 20);
+
+    copy = run(0);
+    vec = run(1);
+    printf("fifo %u     %8.1f -> %8.1f\n", FIFO_SIZE, copy, vec);
+
+    return 0;
+}
@@ -0,0 +1,216 @@
+/*
+ * bench_frame.c
+ * Payload throughput of COBS/SLIP framing through a fifo: a byte-at-a-time
+ * codec with kfifo_put()/kfifo_get() ("before") against
+ * kfifo_frame_encode()/kfifo_frame_decode() ("after"), for random payloads
+ * of 64 and 1024 bytes (about 1 in 64 bytes is 0x00 / 0xC0 / 0xDB).
+ *
+ * Build (Linux):
+ *   gcc -O2 -std=gnu11 -I.. bench_frame.c ../kfifo_frame.c ../kfifo.c -o bench_frame
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "kfifo_frame.h"
+
+#define FIFO_SIZE 4096
+#define TOTAL_BYTES (64U << 20)
+
+static DECLARE_KFIFO(fifo, unsigned char, FIFO_SIZE);
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* byte-at-a-time reference codecs, the way they are usually written */
+static void put_cobs_block(const unsigned char *block, unsigned int k)
+{
+    unsigned int j;
+
+    kfifo_put(&fifo, k + 1);
+    for (j = 0; j < k; j++)
+        kfifo_put(&fifo, block[j]);
+}
+
+static void put_cobs(const unsigned char *s, unsigned int len)
+{
+    unsigned char block[254];
+    unsigned int i, k = 0;
+
+    for (i = 0; i < len; i++)
+    {
+        if (s[i] == 0)
+        {
+            put_cobs_block(block, k);
+            k = 0;
+            continue;
+        }
+        block[k++] = s[i];
+        if (k == 254)
+        {
+            put_cobs_block(block, k);
+            k = 0;
+        }
+    }
+    put_cobs_block(block, k);
+    kfifo_put(&fifo, 0);
+}
+
+static unsigned int get_cobs(unsigned char *frame)
+{
+    static unsigned int len, rem, zero;
+    unsigned char c;
+
+    while (kfifo_get(&fifo, &c))
+    {
+        if (!c)
+        {
+            unsigned int n = len;
+
+            len = rem = zero = 0;
+            if (n)
+                return n;
+            continue;
+        }
+        if (rem)
+        {
+            frame[len++] = c;
+            rem--;
+            continue;
+        }
+        if (zero)
+            frame[len++] = 0;
+        rem = c - 1;
+        zero = c != 0xff;
+    }
+    return 0;
+}
+
+static void put_slip(const unsigned char *s, unsigned int len)
+{
+    unsigned int i;
+
+    kfifo_put(&fifo, KFIFO_SLIP_END);
+    for (i = 0; i < len; i++)
+    {
+        if (s[i] == KFIFO_SLIP_END)
+        {
+            kfifo_put(&fifo, KFIFO_SLIP_ESC);
+            kfifo_put(&fifo, KFIFO_SLIP_ESC_END);
+        }
+        else if (s[i] == KFIFO_SLIP_ESC)
+        {
+            kfifo_put(&fifo, KFIFO_SLIP_ESC);
+            kfifo_put(&fifo, KFIFO_SLIP_ESC_ESC);
+        }
+        else
+        {
+            kfifo_put(&fifo, s[i]);
+        }
+    }
+    kfifo_put(&fifo, KFIFO_SLIP_END);
+}
+
+static unsigned int get_slip(unsigned char *frame)
+{
+    static unsigned int len, esc;
+    unsigned char c;
+
+    while (kfifo_get(&fifo, &c))
+    {
+        if (esc)
+        {
+            frame[len++] = c == KFIFO_SLIP_ESC_END ? KFIFO_SLIP_END : KFIFO_SLIP_ESC;
+            esc = 0;
+        }
+        else if (c == KFIFO_SLIP_ESC)
+        {
+            esc = 1;
+        }
+        else if (c == KFIFO_SLIP_END)
+        {
+            unsigned int n = len;
+
+            len = 0;
+            if (n)
+                return n;
+        }
+        else
+        {
+            frame[len++] = c;
+        }
+    }
+    return 0;
+}
+
+static double run(KFIFO_FRAME_TYPE type, int after, const unsigned char *payload, unsigned int len)
+{
+    static unsigned char frame[2048];
+    struct kfifo_frame_decoder dec;
+    unsigned int r, rounds = TOTAL_BYTES / len, errors = 0;
+    double t0, t1;
+
+    INIT_KFIFO(fifo);
+    kfifo_frame_decoder_init(&dec, type, frame, sizeof(frame));
+
+    t0 = now();
+    for (r = 0; r < rounds; r++)
+    {
+        unsigned int n;
+
+        if (after)
+        {
+            kfifo_frame_encode(&fifo, type, payload, len);
+            n = kfifo_frame_decode(&fifo, &dec);
+        }
+        else if (type == KFIFO_FRAME_COBS)
+        {
+            put_cobs(payload, len);
+            n = get_cobs(frame);
+        }
+        else
+        {
+            put_slip(payload, len);
+            n = get_slip(frame);
+        }
+        errors += n != len || frame[len - 1] != payload[len - 1];
+    }
+    t1 = now();
+
+    if (errors || memcmp(frame, payload, len) != 0)
+        printf("data error\n");
+    return (double)rounds * len / (t1 - t0) / 1e6;
+}
+
+int main(void)
+{
+    static const unsigned int lens[] = {64, 1024};
+    static unsigned char payload[1024];
+    unsigned int i;
+
+    srand(1);
+    for (i = 0; i < sizeof(payload); i++)
+    {
+        int r = rand() % 64;
+
+        payload[i] = r == 0 ? 0x00 : r == 1 ? KFIFO_SLIP_END : r == 2 ? KFIFO_SLIP_ESC : (unsigned char)(rand() | 1);
+    }
+
+    printf("encode + decode through a fifo, MB/s of payload (before -> after)\n");
+    for (i = 0; i < sizeof(lens) / sizeof(lens[0]); i++)
+    {
+        printf("COBS %4u bytes   %8.1f -> %8.1f\n", lens[i],
+               run(KFIFO_FRAME_COBS, 0, payload, lens[i]), run(KFIFO_FRAME_COBS, 1, payload, lens[i]));
+        printf("SLIP %4u bytes   %8.1f -> %8.1f\n", lens[i],
+               run(KFIFO_FRAME_SLIP, 0, payload, lens[i]), run(KFIFO_FRAME_SLIP, 1, payload, lens[i]));
+    }
+
+    return 0;
+}
@@ -0,0 +1,180 @@
+/*
+ * bench_mpmc.c
+ * Contention benchmark of the mpmc kfifo against a kfifo guarded by one
+ * global mutex, with 1..16 producer and 1..16 consumer threads.
+ *
+ * Build (Linux):
+ *   gcc -O2 -std=gnu11 -pthread -I.. bench_mpmc.c ../kfifo_mpmc.c ../kfifo.c -o bench_mpmc
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <time.h>
+#include "kfifo.h"
+#include "kfifo_mpmc.h"
+
+#define FIFO_SIZE 1024
+#define TOTAL_ITEMS (4U * 1000U * 1000U)
+#define MAX_THREADS 16
+
+static DECLARE_KFIFO_MPMC(mpmc_fifo, uint32_t, FIFO_SIZE);
+static DECLARE_KFIFO(lock_fifo, uint32_t, FIFO_SIZE);
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+static unsigned int nthreads;
+static _Atomic unsigned long long consumed_sum;
+static _Atomic unsigned int consumed;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void *mpmc_producer(void *arg)
+{
+    unsigned int id = (unsigned int)(uintptr_t)arg;
+    uint32_t v;
+
+    for (v = id; v < TOTAL_ITEMS; v += nthreads)
+        while (!kfifo_mpmc_put(&mpmc_fifo, v))
+            sched_yield();
+    return NULL;
+}
+
+static void *mpmc_consumer(void *arg)
+{
+    unsigned long long sum = 0;
+    unsigned int n = 0;
+    uint32_t v;
+
+    (void)arg;
+    while (atomic_load_explicit(&consumed, memory_order_relaxed) < TOTAL_ITEMS)
+    {
+        if (kfifo_mpmc_get(&mpmc_fifo, &v))
+        {
+            sum += v;
+            n++;
+            if ((n & 63) == 0)
+            {
+                atomic_fetch_add(&consumed, n);
+                n = 0;
+            }
+        }
+        else
+        {
+            atomic_fetch_add(&consumed, n);
+            n = 0;
+            sched_yield();
+        }
+    }
+    atomic_fetch_add(&consumed, n);
+    atomic_fetch_add(&consumed_sum, sum);
+    return NULL;
+}
+
+static void *lock_producer(void *arg)
+{
+    unsigned int id = (unsigned int)(uintptr_t)arg;
+    uint32_t v;
+
+    for (v = id; v < TOTAL_ITEMS; v += nthreads)
+    {
+        for (;;)
+        {
+            unsigned int ret;
+
+            pthread_mutex_lock(&lock);
+            ret = kfifo_put(&lock_fifo, v);
+            pthread_mutex_unlock(&lock);
+            if (ret)
+                break;
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *lock_consumer(void *arg)
+{
+    unsigned long long sum = 0;
+    uint32_t v;
+
+    (void)arg;
+    while (atomic_load_explicit(&consumed, memory_order_relaxed) < TOTAL_ITEMS)
+    {
+        unsigned int ret;
+
+        pthread_mutex_lock(&lock);
+        ret = kfifo_get(&lock_fifo, &v);
+        pthread_mutex_unlock(&lock);
+        if (ret)
+        {
+            sum += v;
+            atomic_fetch_add(&consumed, 1);
+        }
+        else
+        {
+            sched_yield();
+        }
+    }
+    atomic_fetch_add(&consumed_sum, sum);
+    return NULL;
+}
+
+static double run(void *(*producer)(void *), void *(*consumer)(void *), int *ok)
+{
+    pthread_t p[MAX_THREADS], c[MAX_THREADS];
+    unsigned long long expect = (unsigned long long)TOTAL_ITEMS * (TOTAL_ITEMS - 1) / 2;
+    double t0, t1;
+    unsigned int i;
+
+    INIT_KFIFO_MPMC(mpmc_fifo);
+    INIT_KFIFO(lock_fifo);
+    atomic_store(&consumed, 0);
+    atomic_store(&consumed_sum, 0);
+
+    t0 = now_sec();
+    for (i = 0; i < nthreads; i++)
+    {
+        pthread_create(&c[i], NULL, consumer, NULL);
+        pthread_create(&p[i], NULL, producer, (void *)(uintptr_t)i);
+    }
+    for (i = 0; i < nthreads; i++)
+    {
+        pthread_join(p[i], NULL);
+        pthread_join(c[i], NULL);
+    }
+    t1 = now_sec();
+
+    *ok = atomic_load(&consumed_sum) == expect;
+    return TOTAL_ITEMS / (t1 - t0) / 1e6;
+}
+
+int main(void)
+{
+    int errors = 0;
+
+    printf("MPMC contention, %u x uint32_t, fifo size %d, %ld online cpus\n",
+           TOTAL_ITEMS, FIFO_SIZE, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-10s %16s %16s %8s\n", "P x C", "mpmc (Mops/s)", "mutex (Mops/s)", "ratio");
+
+    for (nthreads = 1; nthreads <= MAX_THREADS; nthreads *= 2)
+    {
+        int ok1, ok2;
+        double m = run(mpmc_producer, mpmc_consumer, &ok1);
+        double l = run(lock_producer, lock_consumer, &ok2);
+
+        printf("%2u x %-5u %16.2f %16.2f %7.2fx%s\n", nthreads, nthreads, m, l, m / l,
+               (ok1 && ok2) ? "" : "  CHECKSUM ERROR");
+        errors += !ok1 + !ok2;
+    }
+
+    return errors ? 2 : 0;
+}
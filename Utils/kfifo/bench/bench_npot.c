@@ -0,0 +1,102 @@
+/*
+ * bench_npot.c
+ * Speed cost of non power of 2 capacity (kfifo_init_npot) against the
+ * power of 2 fifo kfifo_init() makes from the same 3000 byte buffer, which
+ * only uses 2048 bytes of it.
+ *
+ * Build both variants to also see the cost of KFIFO_NPOT for power of 2
+ * fifos (Linux):
+ *   gcc -O2 -std=gnu11 -I.. bench_npot.c ../kfifo.c -o bench_npot
+ *   gcc -O2 -std=gnu11 -DKFIFO_NPOT -I.. bench_npot.c ../kfifo.c -o bench_npot
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include "kfifo.h"
+
+#define BUF_SIZE 3000
+#define ITEMS (64U * 1000U * 1000U)
+#define CHUNK 64
+
+static unsigned char buffer[BUF_SIZE];
+
+/* keep the compiler from optimizing the loops away */
+static volatile unsigned int sink;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* single elements, the fifo is kept half full so that reads and writes wrap */
+static double bench_put_get(struct kfifo *fifo)
+{
+    unsigned int i, sum = 0;
+    unsigned char v = 0;
+    double t0;
+
+    kfifo_reset(fifo);
+    for (i = 0; i < kfifo_size(fifo) / 2; i++)
+        sum += kfifo_put(fifo, (unsigned char)i);
+
+    t0 = now_sec();
+    for (i = 0; i < ITEMS; i++)
+    {
+        sum += kfifo_put(fifo, (unsigned char)i);
+        sum += kfifo_get(fifo, &v);
+        sum += v;
+    }
+    sink = sum;
+    return (now_sec() - t0) * 1e9 / ITEMS;
+}
+
+static double bench_in_out(struct kfifo *fifo)
+{
+    unsigned char in[CHUNK] = {0}, out[CHUNK];
+    unsigned int i, sum = 0;
+    double t0;
+
+    kfifo_reset(fifo);
+    for (i = 0; i < kfifo_size(fifo) / 2; i++)
+        sum += kfifo_put(fifo, (unsigned char)i);
+
+    t0 = now_sec();
+    for (i = 0; i < ITEMS / CHUNK; i++)
+    {
+        sum += kfifo_in(fifo, in, CHUNK);
+        sum += kfifo_out(fifo, out, CHUNK);
+        sum += out[0];
+    }
+    sink = sum;
+    return (now_sec() - t0) * 1e9 / ITEMS;
+}
+
+int main(void)
+{
+    struct kfifo fifo;
+
+    printf("%s build, %d byte buffer, ns per byte\n",
+#ifdef KFIFO_NPOT
+           "KFIFO_NPOT",
+#else
+           "default",
+#endif
+           BUF_SIZE);
+    printf("%-22s %10s %12s %14s\n", "fifo", "usable", "put + get", "in + out (64)");
+
+    if (kfifo_init(&fifo, buffer, sizeof(buffer)) == 0)
+        printf("%-22s %10u %12.2f %14.2f\n", "kfifo_init (pow2)",
+               kfifo_size(&fifo), bench_put_get(&fifo), bench_in_out(&fifo));
+
+#ifdef KFIFO_NPOT
+    if (kfifo_init_npot(&fifo, buffer, sizeof(buffer)) == 0)
+        printf("%-22s %10u %12.2f %14.2f\n", "kfifo_init_npot",
+               kfifo_size(&fifo), bench_put_get(&fifo), bench_in_out(&fifo));
+#endif /* KFIFO_NPOT */
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+/*
+ * bench_records.c
+ * Draining a record fifo full of small records (like a logger task that
+ * wakes up periodically): one kfifo_out() per record against a single
+ * kfifo_out_records() call, in ns per record.
+ *
+ * Build (Linux), optionally with -DKFIFO_SMP:
+ *   gcc -O2 -std=gnu11 -I.. bench_records.c ../kfifo.c -o bench_records
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include "kfifo.h"
+
+#define FIFO_SIZE 8192
+#define RECORDS 300
+#define ROUNDS 20000U
+
+static STRUCT_KFIFO_REC_1(FIFO_SIZE) rfifo;
+static STRUCT_KFIFO_REC_2(FIFO_SIZE) rfifo2;
+
+/* keep the compiler from optimizing the loops away */
+static volatile unsigned int sink;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+#define DEFINE_BENCH(name, fifo)                                                    \
+    static void bench_##name(double *loop, double *batch)                           \
+    {                                                                               \
+        unsigned char rec[32] = {0}, buf[FIFO_SIZE];                                \
+        unsigned int lens[RECORDS];                                                 \
+        unsigned int r, i, n, sum = 0;                                              \
+        double t, t_loop = 0, t_batch = 0;                                          \
+                                                                                    \
+        INIT_KFIFO(fifo);                                                           \
+        for (r = 0; r < ROUNDS; r++)                                                \
+        {                                                                           \
+            /* event records of 8..23 bytes */                                      \
+            for (i = 0; i < RECORDS; i++)                                           \
+                sum += kfifo_in(&fifo, rec, 8 + i % 16);                            \
+            t = now_sec();                                                          \
+            for (i = 0; i < RECORDS; i++)                                           \
+                sum += kfifo_out(&fifo, buf + i * 24, 24);                          \
+            t_loop += now_sec() - t;                                                \
+                                                                                    \
+            for (i = 0; i < RECORDS; i++)                                           \
+                sum += kfifo_in(&fifo, rec, 8 + i % 16);                            \
+            t = now_sec();                                                          \
+            n = kfifo_out_records(&fifo, buf, sizeof(buf), lens, RECORDS);          \
+            t_batch += now_sec() - t;                                               \
+            if (n != RECORDS || !kfifo_is_empty(&fifo))                             \
+                printf("data error for " #name "\n");                               \
+            sum += n;                                                               \
+        }                                                                           \
+        sink = sum;                                                                 \
+        *loop = t_loop * 1e9 / ((double)ROUNDS * RECORDS);                          \
+        *batch = t_batch * 1e9 / ((double)ROUNDS * RECORDS);                        \
+    }
+
+DEFINE_BENCH(rec1, rfifo)
+DEFINE_BENCH(rec2, rfifo2)
+
+int main(void)
+{
+    double loop, batch;
+
+    printf("drain %u records, ns per record (kfifo_out loop -> kfifo_out_records)\n", RECORDS);
+
+    bench_rec1(&loop, &batch);
+    printf("recsize 1   %6.2f -> %6.2f\n", loop, batch);
+    bench_rec2(&loop, &batch);
+    printf("recsize 2   %6.2f -> %6.2f\n", loop, batch);
+
+    return 0;
+}
@@ -0,0 +1,209 @@
+/*
+ * bench_spsc.c
+ * One producer / one consumer throughput of the KFIFO_SMP backend against
+ * a mutex-guarded ring queue.
+ *
+ * Build (Linux):
+ *   gcc -O2 -std=gnu11 -DKFIFO_SMP -pthread -I.. bench_spsc.c ../kfifo.c -o bench_spsc
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <time.h>
+#include "kfifo.h"
+
+#ifndef KFIFO_SMP
+#error "bench_spsc.c must be built with -DKFIFO_SMP"
+#endif
+
+#define FIFO_SIZE 4096
+#define TOTAL_ITEMS (20U * 1000U * 1000U)
+
+/* mutex-guarded ring with the same capacity, used as the baseline */
+struct mutex_queue
+{
+    pthread_mutex_t lock;
+    unsigned int in;
+    unsigned int out;
+    uint32_t buf[FIFO_SIZE];
+};
+
+static DECLARE_KFIFO(spsc_fifo, uint32_t, FIFO_SIZE);
+static struct mutex_queue mq;
+static unsigned int batch;
+static volatile int errors;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned int mq_in(const uint32_t *buf, unsigned int n)
+{
+    unsigned int i;
+
+    pthread_mutex_lock(&mq.lock);
+    for (i = 0; i < n && mq.in - mq.out < FIFO_SIZE; i++)
+        mq.buf[mq.in++ & (FIFO_SIZE - 1)] = buf[i];
+    pthread_mutex_unlock(&mq.lock);
+    return i;
+}
+
+static unsigned int mq_out(uint32_t *buf, unsigned int n)
+{
+    unsigned int i;
+
+    pthread_mutex_lock(&mq.lock);
+    for (i = 0; i < n && mq.in != mq.out; i++)
+        buf[i] = mq.buf[mq.out++ & (FIFO_SIZE - 1)];
+    pthread_mutex_unlock(&mq.lock);
+    return i;
+}
+
+static void *kfifo_producer(void *arg)
+{
+    uint32_t buf[256];
+    uint32_t seq = 0;
+
+    (void)arg;
+    while (seq < TOTAL_ITEMS)
+    {
+        unsigned int n = TOTAL_ITEMS - seq < batch ? TOTAL_ITEMS - seq : batch;
+        unsigned int i, ret;
+
+        if (n == 1)
+        {
+            ret = kfifo_put(&spsc_fifo, seq);
+        }
+        else
+        {
+            for (i = 0; i < n; i++)
+                buf[i] = seq + i;
+            ret = kfifo_in(&spsc_fifo, buf, n);
+        }
+        if (!ret)
+            sched_yield();
+        seq += ret;
+    }
+    return NULL;
+}
+
+static void *kfifo_consumer(void *arg)
+{
+    uint32_t buf[256];
+    uint32_t seq = 0;
+
+    (void)arg;
+    while (seq < TOTAL_ITEMS)
+    {
+        unsigned int i, ret;
+
+        if (batch == 1)
+            ret = kfifo_get(&spsc_fifo, buf);
+        else
+            ret = kfifo_out(&spsc_fifo, buf, batch);
+        if (!ret)
+            sched_yield();
+        for (i = 0; i < ret; i++)
+            if (buf[i] != seq + i)
+                errors++;
+        seq += ret;
+    }
+    return NULL;
+}
+
+static void *mq_producer(void *arg)
+{
+    uint32_t buf[256];
+    uint32_t seq = 0;
+
+    (void)arg;
+    while (seq < TOTAL_ITEMS)
+    {
+        unsigned int n = TOTAL_ITEMS - seq < batch ? TOTAL_ITEMS - seq : batch;
+        unsigned int i, ret;
+
+        for (i = 0; i < n; i++)
+            buf[i] = seq + i;
+        ret = mq_in(buf, n);
+        if (!ret)
+            sched_yield();
+        seq += ret;
+    }
+    return NULL;
+}
+
+static void *mq_consumer(void *arg)
+{
+    uint32_t buf[256];
+    uint32_t seq = 0;
+
+    (void)arg;
+    while (seq < TOTAL_ITEMS)
+    {
+        unsigned int i, ret = mq_out(buf, batch);
+
+        if (!ret)
+            sched_yield();
+        for (i = 0; i < ret; i++)
+            if (buf[i] != seq + i)
+                errors++;
+        seq += ret;
+    }
+    return NULL;
+}
+
+static double run(void *(*producer)(void *), void *(*consumer)(void *))
+{
+    pthread_t p, c;
+    double t0, t1;
+
+    INIT_KFIFO(spsc_fifo);
+    mq.in = mq.out = 0;
+
+    t0 = now_sec();
+    pthread_create(&c, NULL, consumer, NULL);
+    pthread_create(&p, NULL, producer, NULL);
+    pthread_join(p, NULL);
+    pthread_join(c, NULL);
+    t1 = now_sec();
+
+    return TOTAL_ITEMS / (t1 - t0) / 1e6;
+}
+
+int main(void)
+{
+    static const unsigned int batches[] = {1, 16, 256};
+    unsigned int i;
+
+    pthread_mutex_init(&mq.lock, NULL);
+
+    printf("SPSC throughput, %u x uint32_t, fifo size %d, %ld online cpus\n",
+           TOTAL_ITEMS, FIFO_SIZE, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-8s %16s %16s %8s\n", "batch", "kfifo (Mops/s)", "mutex (Mops/s)", "ratio");
+
+    for (i = 0; i < sizeof(batches) / sizeof(batches[0]); i++)
+    {
+        double k, m;
+
+        batch = batches[i];
+        k = run(kfifo_producer, kfifo_consumer);
+        m = run(mq_producer, mq_consumer);
+        printf("%-8u %16.2f %16.2f %7.2fx\n", batch, k, m, k / m);
+    }
+
+    if (errors)
+    {
+        printf("%d sequence error(s)\n", errors);
+        return 2;
+    }
+    return 0;
+}
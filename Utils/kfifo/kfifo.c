@@ -11,9 +11,17 @@
  * - `__kfifo_alloc`：动态分配 FIFO 缓冲区。
  * - `__kfifo_free`：释放动态分配的 FIFO 缓冲区。
  * - `__kfifo_in` 和 `__kfifo_out`：向 FIFO 写入和读取数据。
+ * - `__kfifo_in_overwrite` 和 `__kfifo_in_overwrite_r`：空间不足时丢弃最旧的数据/记录后写入（覆盖模式，`KFIFO_OVERWRITE`）。
+ * - `__kfifo_out_peek_at` 和 `__kfifo_find_byte`：从指定偏移查看数据、原地查找字节（不拷贝）。
+ * - `__kfifo_in_linear`：获取可直接写入的连续空闲空间（零拷贝写入）。
  * - `__kfifo_in_r` 和 `__kfifo_out_r`：基于记录的写入和读取操作。
+ * - `__kfifo_out_records_r`：一次取出多条记录，只更新一次 out。
  * - `__kfifo_len_r`：获取记录的长度。
+ * - 4 字节记录头：记录按 4 字节对齐且不会在缓冲区末尾拆开，放不下时写入跳转标记，从缓冲区开头继续。
  * - `__kfifo_skip_r`：跳过记录。
+ * - `__kfifo_dma_in_prepare` 和 `__kfifo_dma_out_prepare`：生成描述空闲/已用区域的 DMA 分段（最多两段）。
+ * - `__kfifo_set_watermark`：设置高/低水位回调（`KFIFO_WATERMARK`）。
+ * - `__kfifo_stats` 和 `kfifo_stats_foreach`：统计快照和已登记 FIFO 的遍历（`KFIFO_STATS`）。
  *
  * 设计限制：
  * - FIFO 的大小必须为 2 的幂。
@@ -38,6 +46,9 @@
 })
 #define is_power_of_2(x) ((x) != 0 && (((x) & ((x) - 1)) == 0))
 
+/* 从 off 开始不回绕可连续访问的长度，镜像映射时为整个缓冲区 */
+#define kfifo_span(fifo, size, off) (__kfifo_is_mirror(fifo) ? (size) : (size) - (off))
+
 /* 找到最高位的 1，返回位置（1 开始计数），0 表示没有 1 */
 static inline unsigned int fls(unsigned int x)
 {
@@ -53,15 +64,6 @@ static inline unsigned int fls(unsigned int x)
     return pos;
 }
 
-/* 向上取最近的 2 的幂 */
-static inline unsigned int roundup_pow_of_two(unsigned int n)
-{
-    if (n == 0)
-        return 1;
-
-    return 1U << fls(n - 1);
-}
-
 /* 向下取最近的 2 的幂 */
 static inline unsigned int rounddown_pow_of_two(unsigned int n)
 {
@@ -71,14 +73,6 @@ static inline unsigned int rounddown_pow_of_two(unsigned int n)
     return 1U << (fls(n) - 1);
 }
 
-/*
- * internal helper to calculate the unused elements in a fifo
- */
-static inline unsigned int kfifo_unused(struct __kfifo *fifo)
-{
-    return (fifo->mask + 1) - (fifo->in - fifo->out);
-}
-
 int __kfifo_alloc(struct __kfifo *fifo, unsigned int size,
                   size_t esize)
 {
@@ -86,11 +80,16 @@ int __kfifo_alloc(struct __kfifo *fifo, unsigned int size,
      * round up to the next power of 2, since our 'let the indices
      * wrap' technique works only in this case.
      */
-    size = roundup_pow_of_two(size);
+    size = __kfifo_roundup_pow_of_two(size);
 
     fifo->in = 0;
     fifo->out = 0;
     fifo->esize = esize;
+    __kfifo_reset_discarded(fifo);
+    __kfifo_reset_flags(fifo);
+    __kfifo_reset_cache(fifo);
+    __kfifo_reset_wm(fifo);
+    __kfifo_init_stats(fifo);
 
     if (size < 2)
     {
@@ -113,10 +112,27 @@ int __kfifo_alloc(struct __kfifo *fifo, unsigned int size,
 
 void __kfifo_free(struct __kfifo *fifo)
 {
+#ifdef KFIFO_STATS
+    __kfifo_stats_unregister(fifo);
+#endif /* KFIFO_STATS */
+
+#ifdef KFIFO_MIRROR
+    if (__kfifo_is_mirror(fifo))
+    {
+        __kfifo_free_mirror(fifo);
+        return;
+    }
+#endif /* KFIFO_MIRROR */
+
     free(fifo->data);
     fifo->in = 0;
     fifo->out = 0;
     fifo->esize = 0;
+    __kfifo_reset_discarded(fifo);
+    __kfifo_reset_flags(fifo);
+    __kfifo_reset_cache(fifo);
+    __kfifo_reset_wm(fifo);
+    __kfifo_init_stats(fifo);
     fifo->data = NULL;
     fifo->mask = 0;
 }
@@ -133,6 +149,11 @@ int __kfifo_init(struct __kfifo *fifo, void *buffer,
     fifo->out = 0;
     fifo->esize = esize;
     fifo->data = buffer;
+    __kfifo_reset_discarded(fifo);
+    __kfifo_reset_flags(fifo);
+    __kfifo_reset_cache(fifo);
+    __kfifo_reset_wm(fifo);
+    __kfifo_init_stats(fifo);
 
     if (size < 2)
     {
@@ -144,8 +165,246 @@ int __kfifo_init(struct __kfifo *fifo, void *buffer,
     return 0;
 }
 
-static void kfifo_copy_in(struct __kfifo *fifo, const void *src,
-                          unsigned int len, unsigned int off)
+/* 4 字节记录头按 uint32_t 读写：缓冲区必须 4 字节对齐，大小必须是 4 的倍数 */
+int __kfifo_rec_4_check(struct __kfifo *fifo, int owned)
+{
+    if (!((uintptr_t)fifo->data & 3) && !((fifo->mask + 1) & 3))
+        return 0;
+
+    if (owned)
+    {
+        __kfifo_free(fifo);
+    }
+    else
+    {
+        __kfifo_reset_flags(fifo);
+        fifo->mask = 0;
+    }
+    return -EINVAL;
+}
+
+#ifdef KFIFO_NPOT
+/* 容量不是 2 的幂时设置 KFIFO_F_NPOT，是 2 的幂时仍然使用 & mask */
+static int kfifo_setup_npot(struct __kfifo *fifo, void *buffer,
+                            unsigned int size, size_t esize)
+{
+    fifo->in = 0;
+    fifo->out = 0;
+    fifo->esize = esize;
+    fifo->data = buffer;
+    __kfifo_reset_discarded(fifo);
+    __kfifo_reset_flags(fifo);
+    __kfifo_reset_cache(fifo);
+    __kfifo_reset_wm(fifo);
+    __kfifo_init_stats(fifo);
+
+    /* in/out 在 [0, 2 * size) 内回绕，2 * size 不能溢出 */
+    if (size < 2 || size > (~0U >> 1))
+    {
+        fifo->mask = 0;
+        return -EINVAL;
+    }
+    fifo->mask = size - 1;
+
+    if (!is_power_of_2(size))
+        fifo->flags = KFIFO_F_NPOT;
+
+    return 0;
+}
+
+int __kfifo_alloc_npot(struct __kfifo *fifo, unsigned int size,
+                       size_t esize)
+{
+    void *buffer = NULL;
+    int ret;
+
+    if (size >= 2)
+    {
+        buffer = malloc(esize * size);
+        if (!buffer)
+        {
+            kfifo_setup_npot(fifo, NULL, 0, esize);
+            return -ENOMEM;
+        }
+    }
+
+    ret = kfifo_setup_npot(fifo, buffer, size, esize);
+    if (ret)
+    {
+        free(buffer);
+        fifo->data = NULL;
+    }
+
+    return ret;
+}
+
+int __kfifo_init_npot(struct __kfifo *fifo, void *buffer,
+                      unsigned int size, size_t esize)
+{
+    return kfifo_setup_npot(fifo, buffer, size / esize, esize);
+}
+#endif /* KFIFO_NPOT */
+
+#ifdef KFIFO_WATERMARK
+/* 设置水位状态并返回原来的状态，读写两端都会修改 */
+static inline unsigned int kfifo_wm_swap(struct kfifo_watermark *wm, unsigned int v)
+{
+#ifdef KFIFO_SMP
+    return atomic_exchange_explicit(&wm->above, v, memory_order_relaxed);
+#else /* KFIFO_SMP */
+    unsigned int old = wm->above;
+
+    wm->above = v;
+    return old;
+#endif /* KFIFO_SMP */
+}
+
+/*
+ * 切换水位状态并调用回调，之后重新读取两端索引。调用方的判断用的是切换前的快照：
+ * 例如读端判断已降到低水位后，写端写到高水位以上，但看到 above 仍为 1 而没有调用
+ * on_high；读端随后切换为 0 并调用 on_low，FIFO 停在高水位以上却不会再有 on_high。
+ * 所以切换后若另一条水位的条件成立，由本端切换回去并调用对应的回调。
+ * 全屏障保证本端切换状态之后读取的对端索引，与对端发布索引之后读取的状态至少有一方是新的
+ */
+static void kfifo_wm_edge(struct __kfifo *fifo, unsigned int above)
+{
+    struct kfifo_watermark *wm = fifo->wm;
+    unsigned int used;
+
+    while (kfifo_wm_swap(wm, above) != above)
+    {
+        if (above && wm->on_high)
+            wm->on_high(wm->arg);
+        else if (!above && wm->on_low)
+            wm->on_low(wm->arg);
+
+        smp_mb();
+        used = __kfifo_dist(fifo, __kfifo_load_acquire(&fifo->in), __kfifo_load_acquire(&fifo->out));
+        if (above ? used > wm->low : used < wm->high)
+            return;
+        above = !above;
+    }
+}
+
+/*
+ * 写端：已用数达到高水位且尚未调用 on_high 时调用。out 每次重新读取，
+ * 不使用缓存的 out，否则读端已经取走的数据会被算作已用
+ */
+void __kfifo_wm_in(struct __kfifo *fifo)
+{
+    struct kfifo_watermark *wm = fifo->wm;
+    unsigned int used = __kfifo_dist(fifo, __kfifo_load(&fifo->in), __kfifo_load_acquire(&fifo->out));
+
+    if (used < wm->high)
+        return;
+
+    /* 发布 in 之后再读取状态 */
+    smp_mb();
+    if (!__kfifo_load(&wm->above))
+        kfifo_wm_edge(fifo, 1);
+}
+
+/* 读端：已用数降到低水位且已经调用过 on_high 时调用 */
+void __kfifo_wm_out(struct __kfifo *fifo)
+{
+    struct kfifo_watermark *wm = fifo->wm;
+    unsigned int used = __kfifo_dist(fifo, __kfifo_load_acquire(&fifo->in), __kfifo_load(&fifo->out));
+
+    if (used > wm->low)
+        return;
+
+    /* 发布 out 之后再读取状态 */
+    smp_mb();
+    if (__kfifo_load(&wm->above))
+        kfifo_wm_edge(fifo, 0);
+}
+
+int __kfifo_set_watermark(struct __kfifo *fifo, struct kfifo_watermark *wm)
+{
+    if (wm && wm->low >= wm->high)
+        return -EINVAL;
+
+    fifo->wm = wm;
+    if (wm)
+    {
+        wm->above = 0;
+        __kfifo_wm_in(fifo);
+    }
+    return 0;
+}
+#endif /* KFIFO_WATERMARK */
+
+#ifdef KFIFO_STATS
+/* 已登记的 FIFO，只在初始化阶段修改 */
+static struct __kfifo *kfifo_stats_list;
+
+void __kfifo_stats(struct __kfifo *fifo, struct kfifo_stats *st)
+{
+    st->name = fifo->name;
+    st->size = fifo->mask + 1;
+    st->len = __kfifo_dist(fifo, __kfifo_load_acquire(&fifo->in), __kfifo_load_acquire(&fifo->out));
+    st->peak = fifo->wstats.peak;
+    st->truncated = fifo->wstats.truncated;
+    st->dropped = fifo->wstats.dropped;
+#ifdef KFIFO_OVERWRITE
+    st->discarded = fifo->discarded;
+#else /* KFIFO_OVERWRITE */
+    st->discarded = 0;
+#endif /* KFIFO_OVERWRITE */
+    st->empty = fifo->rstats.empty;
+    st->bytes_in = fifo->wstats.bytes;
+    st->bytes_out = fifo->rstats.bytes;
+}
+
+void __kfifo_stats_reset(struct __kfifo *fifo)
+{
+    __kfifo_reset_stats(fifo);
+    __kfifo_reset_discarded(fifo);
+    fifo->wstats.peak = __kfifo_dist(fifo, __kfifo_load(&fifo->in), __kfifo_load(&fifo->out));
+}
+
+void __kfifo_stats_register(struct __kfifo *fifo, const char *name)
+{
+    struct __kfifo *p;
+
+    fifo->name = name;
+    for (p = kfifo_stats_list; p; p = p->next)
+        if (p == fifo)
+            return;
+
+    fifo->next = kfifo_stats_list;
+    kfifo_stats_list = fifo;
+}
+
+void __kfifo_stats_unregister(struct __kfifo *fifo)
+{
+    struct __kfifo **pp;
+
+    for (pp = &kfifo_stats_list; *pp; pp = &(*pp)->next)
+    {
+        if (*pp == fifo)
+        {
+            *pp = fifo->next;
+            return;
+        }
+    }
+}
+
+void kfifo_stats_foreach(void (*fn)(const struct kfifo_stats *st, void *arg), void *arg)
+{
+    struct kfifo_stats st;
+    struct __kfifo *p;
+
+    for (p = kfifo_stats_list; p; p = p->next)
+    {
+        __kfifo_stats(p, &st);
+        fn(&st, arg);
+    }
+}
+#endif /* KFIFO_STATS */
+
+void __kfifo_copy_in(struct __kfifo *fifo, const void *src,
+                     unsigned int len, unsigned int off)
 {
     unsigned int size = fifo->mask + 1;
     unsigned int esize = fifo->esize;
@@ -153,42 +412,73 @@ static void kfifo_copy_in(struct __kfifo *fifo, const void *src,
     unsigned char *data = (unsigned char *)fifo->data;
     const unsigned char *s = (const unsigned char *)src;
 
-    off &= fifo->mask;
+    off = __kfifo_off(fifo, off);
     if (esize != 1)
     {
         off *= esize;
         size *= esize;
         len *= esize;
     }
-    l = min(len, size - off);
+    l = min(len, kfifo_span(fifo, size, off));
 
     // memcpy(fifo->data + off, src, l);
     // memcpy(fifo->data, src + l, len - l);
     memcpy(data + off, s, l);
-    memcpy(data, s + l, len - l);
+    if (len > l)
+        memcpy(data, s + l, len - l);
+}
+
+unsigned int __kfifo_in(struct __kfifo *fifo,
+                        const void *buf, unsigned int len)
+{
+    unsigned int l;
+
+    l = __kfifo_unused(fifo, len);
+    if (len > l)
+    {
+        __kfifo_stats_short(fifo, len - l);
+        len = l;
+    }
+
+    __kfifo_copy_in(fifo, buf, len, __kfifo_load(&fifo->in));
     /*
      * make sure that the data in the fifo is up to date before
      * incrementing the fifo->in index counter
      */
-    smp_wmb();
+    __kfifo_add_in(fifo, len);
+    return len;
 }
 
-unsigned int __kfifo_in(struct __kfifo *fifo,
-                        const void *buf, unsigned int len)
+#ifdef KFIFO_OVERWRITE
+unsigned int __kfifo_in_overwrite(struct __kfifo *fifo,
+                                  const void *buf, unsigned int len)
 {
+    unsigned int size = fifo->mask + 1;
     unsigned int l;
 
-    l = kfifo_unused(fifo);
+    /* only the newest size elements of buf can be kept */
+    if (len > size)
+    {
+        fifo->discarded += len - size;
+        buf = (const unsigned char *)buf + (len - size) * fifo->esize;
+        len = size;
+    }
+
+    l = __kfifo_unused(fifo, len);
     if (len > l)
-        len = l;
+    {
+        __kfifo_drop_out(fifo, len - l);
+        fifo->discarded += len - l;
+    }
 
-    kfifo_copy_in(fifo, buf, len, fifo->in);
-    fifo->in += len;
+    __kfifo_copy_in(fifo, buf, len, __kfifo_load(&fifo->in));
+    __kfifo_add_in(fifo, len);
     return len;
 }
+#endif /* KFIFO_OVERWRITE */
 
-static void kfifo_copy_out(struct __kfifo *fifo, void *dst,
-                           unsigned int len, unsigned int off)
+void __kfifo_copy_out(struct __kfifo *fifo, void *dst,
+                      unsigned int len, unsigned int off)
 {
     unsigned int size = fifo->mask + 1;
     unsigned int esize = fifo->esize;
@@ -196,24 +486,20 @@ static void kfifo_copy_out(struct __kfifo *fifo, void *dst,
     unsigned char *data = (unsigned char *)fifo->data;
     unsigned char *d = (unsigned char *)dst;
 
-    off &= fifo->mask;
+    off = __kfifo_off(fifo, off);
     if (esize != 1)
     {
         off *= esize;
         size *= esize;
         len *= esize;
     }
-    l = min(len, size - off);
+    l = min(len, kfifo_span(fifo, size, off));
 
     // memcpy(dst, fifo->data + off, l);
     // memcpy(dst + l, fifo->data, len - l);
     memcpy(d, data + off, l);
-    memcpy(d + l, data, len - l);
-    /*
-     * make sure that the data is copied before
-     * incrementing the fifo->out index counter
-     */
-    smp_wmb();
+    if (len > l)
+        memcpy(d + l, data, len - l);
 }
 
 unsigned int __kfifo_out_peek(struct __kfifo *fifo,
@@ -221,66 +507,236 @@ unsigned int __kfifo_out_peek(struct __kfifo *fifo,
 {
     unsigned int l;
 
-    l = fifo->in - fifo->out;
+    l = __kfifo_used(fifo, len);
+    if (len > l)
+        len = l;
+
+    __kfifo_copy_out(fifo, buf, len, __kfifo_load(&fifo->out));
+    return len;
+}
+
+unsigned int __kfifo_out_peek_at(struct __kfifo *fifo,
+                                 void *buf, unsigned int len, unsigned int offset)
+{
+    unsigned int l;
+
+    l = __kfifo_used(fifo, offset + len);
+    if (offset >= l)
+        return 0;
+
+    l -= offset;
     if (len > l)
         len = l;
 
-    kfifo_copy_out(fifo, buf, len, fifo->out);
+    __kfifo_copy_out(fifo, buf, len, __kfifo_load(&fifo->out) + offset);
     return len;
 }
 
+int __kfifo_find_byte(struct __kfifo *fifo, unsigned char c, unsigned int start)
+{
+    unsigned int size = fifo->mask + 1;
+    unsigned int l = __kfifo_used(fifo, size);
+    unsigned int off;
+    const unsigned char *data = (const unsigned char *)fifo->data;
+    const unsigned char *p;
+
+    if (start >= l)
+        return -1;
+
+    l -= start;
+    off = __kfifo_off(fifo, __kfifo_load(&fifo->out) + start);
+
+    /* scan the part till the end of the buffer, then the wrapped part */
+    if (l > kfifo_span(fifo, size, off))
+    {
+        p = memchr(data + off, c, size - off);
+        if (p)
+            return (int)(start + (p - (data + off)));
+        start += size - off;
+        l -= size - off;
+        off = 0;
+    }
+
+    p = memchr(data + off, c, l);
+    if (p)
+        return (int)(start + (p - (data + off)));
+    return -1;
+}
+
 unsigned int __kfifo_out_linear(struct __kfifo *fifo,
                                 unsigned int *tail, unsigned int n)
 {
     unsigned int size = fifo->mask + 1;
-    unsigned int off = fifo->out & fifo->mask;
+    unsigned int off = __kfifo_off(fifo, __kfifo_load(&fifo->out));
 
     if (tail)
         *tail = off;
 
-    return min3(n, fifo->in - fifo->out, size - off);
+    return min3(n, __kfifo_used(fifo, n), kfifo_span(fifo, size, off));
+}
+
+unsigned int __kfifo_in_linear(struct __kfifo *fifo,
+                               unsigned int *head, unsigned int n)
+{
+    unsigned int size = fifo->mask + 1;
+    unsigned int off = __kfifo_off(fifo, __kfifo_load(&fifo->in));
+
+    if (head)
+        *head = off;
+
+    return min3(n, __kfifo_unused(fifo, n), kfifo_span(fifo, size, off));
 }
 
 unsigned int __kfifo_out(struct __kfifo *fifo,
                          void *buf, unsigned int len)
 {
-    len = __kfifo_out_peek(fifo, buf, len);
-    fifo->out += len;
-    return len;
+    unsigned int l = __kfifo_out_peek(fifo, buf, len);
+
+    if (!l && len)
+        __kfifo_stats_empty(fifo);
+    /*
+     * make sure that the data is copied before
+     * incrementing the fifo->out index counter
+     */
+    __kfifo_add_out(fifo, l);
+    return l;
 }
 
+static unsigned int setup_seg_buf(struct __kfifo *fifo, struct kfifo_dma_seg *seg,
+                                  int nents, unsigned int len, unsigned int off)
+{
+    if (!nents || !len)
+        return 0;
+
+    seg->addr = (unsigned char *)fifo->data + off;
+    seg->len = len;
+    return 1;
+}
+
+static unsigned int setup_seg(struct __kfifo *fifo, struct kfifo_dma_seg *seg,
+                              int nents, unsigned int len, unsigned int off)
+{
+    unsigned int size = fifo->mask + 1;
+    unsigned int esize = fifo->esize;
+    unsigned int len_to_end;
+    unsigned int n;
+
+    off = __kfifo_off(fifo, off);
+    if (esize != 1)
+    {
+        off *= esize;
+        size *= esize;
+        len *= esize;
+    }
+    len_to_end = min(len, kfifo_span(fifo, size, off));
+
+    n = setup_seg_buf(fifo, seg, nents, len_to_end, off);
+    n += setup_seg_buf(fifo, seg + n, nents - n, len - len_to_end, 0);
+
+    return n;
+}
+
+unsigned int __kfifo_dma_in_prepare(struct __kfifo *fifo,
+                                    struct kfifo_dma_seg *seg, int nents, unsigned int len)
+{
+    unsigned int l;
+
+    l = __kfifo_unused(fifo, len);
+    if (len > l)
+        len = l;
+
+    return setup_seg(fifo, seg, nents, len, __kfifo_load(&fifo->in));
+}
+
+unsigned int __kfifo_dma_out_prepare(struct __kfifo *fifo,
+                                     struct kfifo_dma_seg *seg, int nents, unsigned int len)
+{
+    unsigned int l;
+
+    l = __kfifo_used(fifo, len);
+    if (len > l)
+        len = l;
+
+    return setup_seg(fifo, seg, nents, len, __kfifo_load(&fifo->out));
+}
+
+/* 4 字节记录头的跳转标记：记录从缓冲区开头开始 */
+#define KFIFO_REC_4_SKIP 0xffffffffU
+
+/* 一条记录（含记录头）在缓冲区中占用的字节数，4 字节记录头时按 4 字节对齐 */
+#define kfifo_rec_len(n, recsize) \
+    ((recsize) == 4 ? (((n) + 3U) & ~3U) + 4 : (n) + (recsize))
+
+/* 4 字节记录头在缓冲区中的位置，off 总是 4 字节对齐 */
+#define __KFIFO_REC_4(fifo, off) \
+    (*(uint32_t *)((unsigned char *)(fifo)->data + (off)))
+
 unsigned int __kfifo_max_r(unsigned int len, size_t recsize)
 {
-    unsigned int max = (1 << (recsize << 3)) - 1;
+    unsigned int max = (recsize < 4) ? (1U << (recsize << 3)) - 1 : KFIFO_REC_4_SKIP - 1;
 
     if (len > max)
         return max;
     return len;
 }
 
-#define __KFIFO_PEEK(data, out, mask) \
-    ((data)[(out) & (mask)])
+#define __KFIFO_PEEK(fifo, data, out) \
+    ((data)[__kfifo_off(fifo, out)])
 /*
  * __kfifo_peek_n internal helper function for determinate the length of
  * the next record in the fifo
  */
-static unsigned int __kfifo_peek_n(struct __kfifo *fifo, size_t recsize)
+/*
+ * kfifo_rec_4_out internal helper for the reader to step over the skip
+ * marker at the end of the buffer, returns the index of the next header
+ */
+static unsigned int kfifo_rec_4_out(struct __kfifo *fifo)
+{
+    unsigned int out = __kfifo_load(&fifo->out);
+    unsigned int off = __kfifo_off(fifo, out);
+
+    if (__kfifo_used(fifo, 1) && __KFIFO_REC_4(fifo, off) == KFIFO_REC_4_SKIP)
+    {
+        __kfifo_add_out(fifo, fifo->mask + 1 - off);
+        out = __kfifo_load(&fifo->out);
+    }
+    return out;
+}
+
+/*
+ * kfifo_peek_n_at internal helper to read the length of the record at @out
+ */
+static unsigned int kfifo_peek_n_at(struct __kfifo *fifo, unsigned int out, size_t recsize)
 {
     unsigned int l;
-    unsigned int mask = fifo->mask;
     unsigned char *data = fifo->data;
 
-    l = __KFIFO_PEEK(data, fifo->out, mask);
+    if (recsize == 4)
+        return __KFIFO_REC_4(fifo, __kfifo_off(fifo, out));
+
+    l = __KFIFO_PEEK(fifo, data, out);
 
     if (--recsize)
-        l |= __KFIFO_PEEK(data, fifo->out + 1, mask) << 8;
+        l |= __KFIFO_PEEK(fifo, data, out + 1) << 8;
 
     return l;
 }
 
-#define __KFIFO_POKE(data, in, mask, val) \
+static unsigned int __kfifo_peek_n(struct __kfifo *fifo, size_t recsize)
+{
+    unsigned int out;
+
+    if (recsize == 4)
+        out = kfifo_rec_4_out(fifo);
+    else
+        out = __kfifo_load(&fifo->out);
+
+    return kfifo_peek_n_at(fifo, out, recsize);
+}
+
+#define __KFIFO_POKE(fifo, data, in, val) \
     (                                     \
-        (data)[(in) & (mask)] = (unsigned char)(val))
+        (data)[__kfifo_off(fifo, in)] = (unsigned char)(val))
 
 /*
  * __kfifo_poke_n internal helper function for storing the length of
@@ -288,13 +744,87 @@ static unsigned int __kfifo_peek_n(struct __kfifo *fifo, size_t recsize)
  */
 static void __kfifo_poke_n(struct __kfifo *fifo, unsigned int n, size_t recsize)
 {
-    unsigned int mask = fifo->mask;
     unsigned char *data = fifo->data;
 
-    __KFIFO_POKE(data, fifo->in, mask, n);
+    unsigned int in = __kfifo_load(&fifo->in);
+
+    __KFIFO_POKE(fifo, data, in, n);
 
     if (recsize > 1)
-        __KFIFO_POKE(data, fifo->in + 1, mask, n >> 8);
+        __KFIFO_POKE(fifo, data, in + 1, n >> 8);
+}
+
+/*
+ * kfifo_rec_max internal helper for the largest record (header included)
+ * the fifo can take. Records with 4 byte header are never split, they are
+ * limited to half the buffer so that an empty fifo always has room.
+ */
+static unsigned int kfifo_rec_max(struct __kfifo *fifo, size_t recsize)
+{
+    unsigned int size = fifo->mask + 1;
+
+    if (recsize == 4 && !__kfifo_is_mirror(fifo))
+        return size / 2;
+    return size;
+}
+
+/*
+ * kfifo_rec_need internal helper for the bytes a record of @len bytes
+ * takes at the current in, including the bytes skipped at the end of the
+ * buffer for records with 4 byte header
+ */
+static unsigned int kfifo_rec_need(struct __kfifo *fifo, unsigned int len, size_t recsize)
+{
+    unsigned int size = fifo->mask + 1;
+    unsigned int n = kfifo_rec_len(len, recsize);
+    unsigned int off;
+
+    if (recsize != 4)
+        return n;
+
+    off = __kfifo_off(fifo, __kfifo_load(&fifo->in));
+    if (n > kfifo_span(fifo, size, off))
+        n += size - off;
+    return n;
+}
+
+/*
+ * kfifo_rec_4_reserve internal helper to make room for a record with 4 byte
+ * header. The header slot at in is set to the skip marker if the record
+ * starts at the begin of the buffer. Returns the number of bytes taken
+ * including the skipped ones, or 0 if there is no room.
+ */
+static unsigned int kfifo_rec_4_reserve(struct __kfifo *fifo, unsigned int len)
+{
+    unsigned int off = __kfifo_off(fifo, __kfifo_load(&fifo->in));
+    unsigned int n;
+
+    if (len > fifo->mask + 1 || kfifo_rec_len(len, 4) > kfifo_rec_max(fifo, 4))
+        return 0;
+
+    n = kfifo_rec_need(fifo, len, 4);
+    if (n > __kfifo_unused(fifo, n))
+        return 0;
+
+    __KFIFO_REC_4(fifo, off) = (n != kfifo_rec_len(len, 4)) ? KFIFO_REC_4_SKIP : 0;
+    return n;
+}
+
+static unsigned int kfifo_rec_4_in(struct __kfifo *fifo, const void *buf,
+                                   unsigned int len)
+{
+    unsigned int n = kfifo_rec_4_reserve(fifo, len);
+    unsigned int in;
+
+    if (!n)
+        return 0;
+
+    in = __kfifo_load(&fifo->in) + n - kfifo_rec_len(len, 4);
+    __KFIFO_REC_4(fifo, __kfifo_off(fifo, in)) = len;
+
+    __kfifo_copy_in(fifo, buf, len, in + 4);
+    __kfifo_add_in(fifo, n);
+    return len;
 }
 
 unsigned int __kfifo_len_r(struct __kfifo *fifo, size_t recsize)
@@ -305,16 +835,68 @@ unsigned int __kfifo_len_r(struct __kfifo *fifo, size_t recsize)
 unsigned int __kfifo_in_r(struct __kfifo *fifo, const void *buf,
                           unsigned int len, size_t recsize)
 {
-    if (len + recsize > kfifo_unused(fifo))
+    unsigned int n;
+
+    if (recsize == 4)
+    {
+        n = kfifo_rec_4_in(fifo, buf, len);
+        if (n != len)
+            __kfifo_stats_short(fifo, len);
+        return n;
+    }
+
+    if (len + recsize > __kfifo_unused(fifo, len + recsize))
+    {
+        __kfifo_stats_short(fifo, len);
         return 0;
+    }
 
     __kfifo_poke_n(fifo, len, recsize);
 
-    kfifo_copy_in(fifo, buf, len, fifo->in + recsize);
-    fifo->in += len + recsize;
+    __kfifo_copy_in(fifo, buf, len, __kfifo_load(&fifo->in) + recsize);
+    __kfifo_add_in(fifo, len + recsize);
     return len;
 }
 
+#ifdef KFIFO_OVERWRITE
+unsigned int __kfifo_in_overwrite_r(struct __kfifo *fifo, const void *buf,
+                                    unsigned int len, size_t recsize)
+{
+    unsigned int n, out, off;
+
+    /* the record can never fit, keep the old records */
+    if (len > __kfifo_max_r(len, recsize) || len > fifo->mask + 1 ||
+        kfifo_rec_len(len, recsize) > kfifo_rec_max(fifo, recsize))
+    {
+        __kfifo_stats_short(fifo, len);
+        return 0;
+    }
+
+    /* drop whole records from the tail until the new one fits */
+    for (;;)
+    {
+        n = kfifo_rec_need(fifo, len, recsize);
+        if (n <= __kfifo_unused(fifo, n))
+            break;
+
+        /* step over a skip marker on the writer side, without the reader's hooks and stats */
+        out = __kfifo_load(&fifo->out);
+        off = __kfifo_off(fifo, out);
+        if (recsize == 4 && __KFIFO_REC_4(fifo, off) == KFIFO_REC_4_SKIP)
+        {
+            __kfifo_drop_out(fifo, fifo->mask + 1 - off);
+            continue;
+        }
+
+        n = kfifo_peek_n_at(fifo, out, recsize);
+        __kfifo_drop_out(fifo, kfifo_rec_len(n, recsize));
+        fifo->discarded++;
+    }
+
+    return __kfifo_in_r(fifo, buf, len, recsize);
+}
+#endif /* KFIFO_OVERWRITE */
+
 static unsigned int kfifo_out_copy_r(struct __kfifo *fifo,
                                      void *buf, unsigned int len, size_t recsize, unsigned int *n)
 {
@@ -323,7 +905,7 @@ static unsigned int kfifo_out_copy_r(struct __kfifo *fifo,
     if (len > *n)
         len = *n;
 
-    kfifo_copy_out(fifo, buf, len, fifo->out + recsize);
+    __kfifo_copy_out(fifo, buf, len, __kfifo_load(&fifo->out) + recsize);
     return len;
 }
 
@@ -332,7 +914,7 @@ unsigned int __kfifo_out_peek_r(struct __kfifo *fifo, void *buf,
 {
     unsigned int n;
 
-    if (fifo->in == fifo->out)
+    if (!__kfifo_used(fifo, 1))
         return 0;
 
     return kfifo_out_copy_r(fifo, buf, len, recsize, &n);
@@ -341,13 +923,16 @@ unsigned int __kfifo_out_peek_r(struct __kfifo *fifo, void *buf,
 unsigned int __kfifo_out_linear_r(struct __kfifo *fifo,
                                   unsigned int *tail, unsigned int n, size_t recsize)
 {
-    if (fifo->in == fifo->out)
+    unsigned int l;
+
+    if (!__kfifo_used(fifo, 1))
         return 0;
 
+    l = __kfifo_peek_n(fifo, recsize);
     if (tail)
-        *tail = fifo->out + recsize;
+        *tail = __kfifo_off(fifo, __kfifo_load(&fifo->out) + recsize);
 
-    return min(n, __kfifo_peek_n(fifo, recsize));
+    return min(n, l);
 }
 
 unsigned int __kfifo_out_r(struct __kfifo *fifo, void *buf,
@@ -355,18 +940,136 @@ unsigned int __kfifo_out_r(struct __kfifo *fifo, void *buf,
 {
     unsigned int n;
 
-    if (fifo->in == fifo->out)
+    if (!__kfifo_used(fifo, 1))
+    {
+        __kfifo_stats_empty(fifo);
         return 0;
+    }
 
     len = kfifo_out_copy_r(fifo, buf, len, recsize, &n);
-    fifo->out += n + recsize;
+    __kfifo_add_out(fifo, kfifo_rec_len(n, recsize));
     return len;
 }
 
+unsigned int __kfifo_out_records_r(struct __kfifo *fifo, void *buf, unsigned int buflen,
+                                   unsigned int *lens, unsigned int max, size_t recsize)
+{
+    unsigned int size = fifo->mask + 1;
+    unsigned int used = __kfifo_used(fifo, size);
+    unsigned int out = __kfifo_load(&fifo->out);
+    unsigned int done = 0, copied = 0;
+    unsigned int i, n, off;
+
+    if (!used)
+        __kfifo_stats_empty(fifo);
+
+    for (i = 0; i < max && done < used; i++)
+    {
+        /* a skip marker is always followed by a record */
+        off = __kfifo_off(fifo, out);
+        if (recsize == 4 && __KFIFO_REC_4(fifo, off) == KFIFO_REC_4_SKIP)
+        {
+            out = __kfifo_next(fifo, out, size - off);
+            done += size - off;
+        }
+
+        n = kfifo_peek_n_at(fifo, out, recsize);
+        if (n > buflen - copied)
+        {
+            if (i)
+                break;
+            /* truncate a first record which never fits, like __kfifo_out_r() */
+            lens[i] = buflen;
+        }
+        else
+        {
+            lens[i] = n;
+        }
+
+        /* record fifos have 1 byte elements, copy unwrapped records directly */
+        off = __kfifo_off(fifo, out + recsize);
+        if (lens[i] <= kfifo_span(fifo, size, off))
+            memcpy((unsigned char *)buf + copied, (unsigned char *)fifo->data + off, lens[i]);
+        else
+            __kfifo_copy_out(fifo, (unsigned char *)buf + copied, lens[i], off);
+        copied += lens[i];
+        out = __kfifo_next(fifo, out, kfifo_rec_len(n, recsize));
+        done += kfifo_rec_len(n, recsize);
+    }
+
+    /* release all records at once */
+    if (done)
+        __kfifo_add_out(fifo, done);
+    return i;
+}
+
+unsigned int __kfifo_dma_in_prepare_r(struct __kfifo *fifo,
+                                      struct kfifo_dma_seg *seg, int nents, unsigned int len, size_t recsize)
+{
+    unsigned int n;
+
+    len = __kfifo_max_r(len, recsize);
+
+    if (recsize == 4)
+    {
+        n = kfifo_rec_4_reserve(fifo, len);
+        if (!n)
+            return 0;
+
+        return setup_seg(fifo, seg, nents, len,
+                         __kfifo_load(&fifo->in) + n - kfifo_rec_len(len, 4) + 4);
+    }
+
+    if (len + recsize > __kfifo_unused(fifo, len + recsize))
+        return 0;
+
+    return setup_seg(fifo, seg, nents, len, __kfifo_load(&fifo->in) + recsize);
+}
+
+void __kfifo_dma_in_finish_r(struct __kfifo *fifo,
+                             unsigned int len, size_t recsize)
+{
+    unsigned int in, off, n;
+
+    len = __kfifo_max_r(len, recsize);
+
+    if (recsize == 4)
+    {
+        /* __kfifo_dma_in_prepare_r() left the skip marker if the record wraps */
+        in = __kfifo_load(&fifo->in);
+        off = __kfifo_off(fifo, in);
+        n = kfifo_rec_len(len, 4);
+        if (__KFIFO_REC_4(fifo, off) == KFIFO_REC_4_SKIP)
+            n += fifo->mask + 1 - off;
+
+        __KFIFO_REC_4(fifo, __kfifo_off(fifo, in + n - kfifo_rec_len(len, 4))) = len;
+        __kfifo_add_in(fifo, n);
+        return;
+    }
+
+    __kfifo_poke_n(fifo, len, recsize);
+    __kfifo_add_in(fifo, len + recsize);
+}
+
+unsigned int __kfifo_dma_out_prepare_r(struct __kfifo *fifo,
+                                       struct kfifo_dma_seg *seg, int nents, unsigned int len, size_t recsize)
+{
+    unsigned int n;
+
+    if (!__kfifo_used(fifo, 1))
+        return 0;
+
+    n = __kfifo_peek_n(fifo, recsize);
+    if (len > n)
+        len = n;
+
+    return setup_seg(fifo, seg, nents, len, __kfifo_load(&fifo->out) + recsize);
+}
+
 void __kfifo_skip_r(struct __kfifo *fifo, size_t recsize)
 {
     unsigned int n;
 
     n = __kfifo_peek_n(fifo, recsize);
-    fifo->out += n + recsize;
+    __kfifo_add_out(fifo, kfifo_rec_len(n, recsize));
 }
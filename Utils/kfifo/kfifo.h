@@ -10,7 +10,7 @@
  * 功能特点：
  * - 支持固定大小和动态分配的 FIFO 缓冲区。
  * - 支持基本数据类型和自定义结构体类型。
- * - 提供基于记录（record）的 FIFO，用于存储变长数据。
+ * - 提供基于记录（record）的 FIFO，用于存储变长数据；4 字节记录头的记录按字对齐，可原地访问。
  * - 高效的内存使用，FIFO 大小必须为 2 的幂。
  *
  * 使用场景：
@@ -37,9 +37,15 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <errno.h>
 #include <string.h>
 #include <stdlib.h>
 
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
 /* 构建时检查函数返回值 */
 #ifndef __must_check
 #define __must_check __attribute__((warn_unused_result)) // GCC 用法
@@ -57,13 +63,111 @@
 #define __must_be_array(a) BUILD_BUG_ON_ZERO(__same_type((a), &(a)[0]))
 #define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]) + __must_be_array(arr))
 
-/* 写内存屏障：在单核 MCU 上可为空 */
+/*
+ * SMP 后端：定义 KFIFO_SMP 后，in/out 使用 C11 原子变量并按 acquire/release 顺序访问，
+ * in 和 out 分别放在独立的 cache line 上，并由读写两端各自缓存对端的索引，
+ * 保证多核/多线程下"一读一写无需加锁"仍然成立。单核 MCU 保持默认（不定义）即可。
+ */
+// #define KFIFO_SMP
+
+#ifndef KFIFO_CACHELINE_SIZE
+#define KFIFO_CACHELINE_SIZE 64 // cache line 大小
+#endif /* KFIFO_CACHELINE_SIZE */
+
+#define __kfifo_cacheline_aligned __attribute__((aligned(KFIFO_CACHELINE_SIZE)))
+
+/*
+ * 镜像映射后端（仅 Linux）：定义 KFIFO_MIRROR 后 struct __kfifo 增加 flags 字段，
+ * kfifo_linux.h 中的 kfifo_alloc_mirror 将同一块物理内存连续映射两次，缓冲区末尾之后
+ * 紧接着的就是缓冲区开头，任意位置起 size 个元素都是连续的，拷贝不再拆成两段，
+ * 线性接口可以返回全部已用/空闲空间。启用后需要同时编译 kfifo_linux.c。
+ */
+// #define KFIFO_MIRROR
+
+/*
+ * 任意容量：定义 KFIFO_NPOT 后可以使用 kfifo_init_npot / kfifo_alloc_npot 初始化容量不是 2 的幂
+ * 的 FIFO，不再向下/向上取整浪费内存。这类 FIFO 的 in/out 在 [0, 2 * size) 内回绕，
+ * 用比较和减法代替 `& mask`，接口不变，"一读一写无需加锁"仍然成立。2 的幂 FIFO 仍然使用 `& mask`，
+ * 只多一次标志判断；不定义时没有任何额外开销。
+ */
+// #define KFIFO_NPOT
+
+/*
+ * 水位回调：定义 KFIFO_WATERMARK 后 struct __kfifo 增加 wm 指针，可以用 kfifo_set_watermark 设置
+ * 高/低水位回调。已用数增加到高水位时调用一次 on_high，之后减少到低水位时调用一次 on_low
+ * （带回差的边沿触发），回调在跨过水位的一端（写端或读端，可以是中断）中执行，可直接投递事件，
+ * 消费者不必周期性查询 kfifo_len。不定义时没有任何额外开销，定义后未设置水位的 FIFO 每次读写多一次判断。
+ */
+// #define KFIFO_WATERMARK
+
+/*
+ * 统计：定义 KFIFO_STATS 后 struct __kfifo 增加统计字段，记录峰值占用、写入不完整的次数和丢弃数、
+ * 读到空 FIFO 的次数以及累计写入/读出的字节数，用 kfifo_stats 获取快照；kfifo_stats_register
+ * 登记的 FIFO 可以用 kfifo_stats_foreach 逐个输出，便于根据现场数据缩小缓冲区。
+ * 写端统计只由写端修改，读端统计只由读端修改，不需要原子操作。不定义时没有任何额外开销。
+ */
+// #define KFIFO_STATS
+
+/*
+ * 覆盖模式：定义 KFIFO_OVERWRITE 后提供 kfifo_put_overwrite / kfifo_in_overwrite（空间不足时丢弃最旧的
+ * 数据后写入），struct __kfifo 增加 discarded 计数，用 kfifo_discarded 读取。不定义时没有任何额外开销。
+ */
+// #define KFIFO_OVERWRITE
+
+#define KFIFO_F_MIRROR (1U << 0) // 缓冲区为镜像映射
+#define KFIFO_F_NPOT (1U << 1)   // 容量不是 2 的幂
+
+#if defined(KFIFO_SMP) && defined(__cplusplus)
+/*
+ * C++17 没有 _Atomic，使用 GCC 的 __atomic 内建函数访问普通 unsigned int，
+ * 内存序与 C 的实现相同，结构体布局与 _Atomic unsigned int 一致，可以与 C 代码共用 FIFO
+ */
+typedef unsigned int __kfifo_index_t;
+
+/* 写内存屏障和全屏障 */
+#define smp_wmb() __atomic_thread_fence(__ATOMIC_RELEASE)
+#define smp_mb() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+#define __kfifo_load(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+#define __kfifo_load_acquire(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define __kfifo_store_release(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#elif defined(KFIFO_SMP)
+#include <stdatomic.h>
+
+typedef _Atomic unsigned int __kfifo_index_t;
+
+/* 写内存屏障和全屏障 */
+#define smp_wmb() atomic_thread_fence(memory_order_release)
+#define smp_mb() atomic_thread_fence(memory_order_seq_cst)
+
+/* 索引访问：本端索引 relaxed 读，对端索引 acquire 读，发布索引 release 写 */
+#define __kfifo_load(p) atomic_load_explicit((p), memory_order_relaxed)
+#define __kfifo_load_acquire(p) atomic_load_explicit((p), memory_order_acquire)
+#define __kfifo_store_release(p, v) atomic_store_explicit((p), (v), memory_order_release)
+#else /* KFIFO_SMP */
+typedef unsigned int __kfifo_index_t;
+
+/* 写内存屏障和全屏障：在单核 MCU 上可为空 */
 #define smp_wmb() \
     do            \
     {             \
     } while (0)
+#define smp_mb() \
+    do           \
+    {            \
+    } while (0)
 
-/* 错误码定义 */
+#define __kfifo_load(p) (*(p))
+#define __kfifo_load_acquire(p) (*(p))
+#define __kfifo_store_release(p, v) \
+    do                              \
+    {                               \
+        smp_wmb();                  \
+        *(p) = (v);                 \
+    } while (0)
+#endif /* KFIFO_SMP */
+
+/* 错误码定义：使用 errno.h 的值，所有源文件一致；errno.h 中没有时使用以下值 */
 #ifndef EINVAL // 无效的参数
 #define EINVAL (1)
 #endif /* EINVAL */
@@ -72,6 +176,89 @@
 #define ENOMEM (2)
 #endif /* ENOMEM */
 
+#ifdef KFIFO_WATERMARK
+/* 水位回调，由调用者分配，kfifo_set_watermark 之后不能再修改 */
+struct kfifo_watermark
+{
+    unsigned int high;           // 已用数（记录 FIFO 为字节数）增加到 high 时调用 on_high
+    unsigned int low;            // 之后减少到 low 时调用 on_low，low 必须小于 high
+    void (*on_high)(void *arg);  // 可以为 NULL
+    void (*on_low)(void *arg);   // 可以为 NULL
+    void *arg;                   // 回调参数
+    __kfifo_index_t above;       // 内部状态：已调用 on_high，尚未调用 on_low
+};
+#endif /* KFIFO_WATERMARK */
+
+#ifdef KFIFO_STATS
+/* 写端统计，只由写端修改 */
+struct __kfifo_wstats
+{
+    unsigned int peak;      // 峰值占用
+    unsigned int truncated; // 写入不完整（含整条记录放不下）的次数
+    unsigned int dropped;   // 因此没有写入的元素数
+    uint64_t bytes;         // 累计写入的字节数
+};
+
+/* 读端统计，只由读端修改 */
+struct __kfifo_rstats
+{
+    unsigned int empty; // 读到空 FIFO 的次数
+    uint64_t bytes;     // 累计读出的字节数
+};
+
+/* kfifo_stats 返回的快照，记录 FIFO 的长度单位为字节 */
+struct kfifo_stats
+{
+    const char *name;       // kfifo_stats_register 登记的名称，未登记时为 NULL
+    unsigned int size;      // 容量
+    unsigned int len;       // 当前占用
+    unsigned int peak;      // 峰值占用
+    unsigned int truncated; // 写入不完整（含整条记录放不下）的次数
+    unsigned int dropped;   // 因此没有写入的元素数
+    unsigned int discarded; // 覆盖写入丢弃的元素/记录数（KFIFO_OVERWRITE）
+    unsigned int empty;     // 读到空 FIFO 的次数
+    uint64_t bytes_in;      // 累计写入的字节数
+    uint64_t bytes_out;     // 累计读出的字节数
+};
+#endif /* KFIFO_STATS */
+
+#ifdef KFIFO_SMP
+struct __kfifo
+{
+    /* 写端 cache line */
+    __kfifo_index_t in __kfifo_cacheline_aligned;
+    unsigned int out_cache; // 写端缓存的 out
+#ifdef KFIFO_OVERWRITE
+    unsigned int discarded; // 覆盖写入丢弃的元素/记录数
+#endif /* KFIFO_OVERWRITE */
+#ifdef KFIFO_STATS
+    struct __kfifo_wstats wstats;
+#endif /* KFIFO_STATS */
+    /* 读端 cache line */
+    __kfifo_index_t out __kfifo_cacheline_aligned;
+    unsigned int in_cache; // 读端缓存的 in
+#ifdef KFIFO_STATS
+    struct __kfifo_rstats rstats;
+#endif /* KFIFO_STATS */
+    /* 只读部分 */
+    unsigned int mask __kfifo_cacheline_aligned;
+    unsigned int esize;
+    void *data;
+#if defined(KFIFO_MIRROR) || defined(KFIFO_NPOT)
+    unsigned int flags;
+#endif /* KFIFO_MIRROR || KFIFO_NPOT */
+#ifdef KFIFO_WATERMARK
+    struct kfifo_watermark *wm;
+#endif /* KFIFO_WATERMARK */
+#ifdef KFIFO_STATS
+    const char *name;     // kfifo_stats_register 登记的名称
+    struct __kfifo *next; // 已登记 FIFO 的链表
+#endif /* KFIFO_STATS */
+};
+
+#define __kfifo_reset_cache(fifo) ((fifo)->out_cache = (fifo)->in_cache = 0)
+#define __kfifo_set_in_cache(fifo, val) ((fifo)->in_cache = (val))
+#else /* KFIFO_SMP */
 struct __kfifo
 {
     unsigned int in;
@@ -79,8 +266,292 @@ struct __kfifo
     unsigned int mask;
     unsigned int esize;
     void *data;
+#ifdef KFIFO_OVERWRITE
+    unsigned int discarded; // 覆盖写入丢弃的元素/记录数
+#endif /* KFIFO_OVERWRITE */
+#ifdef KFIFO_STATS
+    struct __kfifo_wstats wstats;
+    struct __kfifo_rstats rstats;
+#endif /* KFIFO_STATS */
+#if defined(KFIFO_MIRROR) || defined(KFIFO_NPOT)
+    unsigned int flags;
+#endif /* KFIFO_MIRROR || KFIFO_NPOT */
+#ifdef KFIFO_WATERMARK
+    struct kfifo_watermark *wm;
+#endif /* KFIFO_WATERMARK */
+#ifdef KFIFO_STATS
+    const char *name;     // kfifo_stats_register 登记的名称
+    struct __kfifo *next; // 已登记 FIFO 的链表
+#endif /* KFIFO_STATS */
 };
 
+#define __kfifo_reset_cache(fifo) ((void)(fifo))
+#define __kfifo_set_in_cache(fifo, val) ((void)(fifo), (void)(val))
+#endif /* KFIFO_SMP */
+
+#if defined(KFIFO_MIRROR) || defined(KFIFO_NPOT)
+#define __kfifo_reset_flags(fifo) ((fifo)->flags = 0)
+#else /* KFIFO_MIRROR || KFIFO_NPOT */
+#define __kfifo_reset_flags(fifo) ((void)(fifo))
+#endif /* KFIFO_MIRROR || KFIFO_NPOT */
+
+#ifdef KFIFO_OVERWRITE
+#define __kfifo_reset_discarded(fifo) ((fifo)->discarded = 0)
+#else /* KFIFO_OVERWRITE */
+#define __kfifo_reset_discarded(fifo) ((void)(fifo))
+#endif /* KFIFO_OVERWRITE */
+
+#ifdef KFIFO_WATERMARK
+extern void __kfifo_wm_in(struct __kfifo *fifo);
+extern void __kfifo_wm_out(struct __kfifo *fifo);
+
+#define __kfifo_reset_wm(fifo) ((fifo)->wm = NULL)
+/* 已用数增加/减少后检查是否跨过水位 */
+#define __kfifo_check_wm_in(fifo) \
+    do                            \
+    {                             \
+        if ((fifo)->wm)           \
+            __kfifo_wm_in(fifo);  \
+    } while (0)
+#define __kfifo_check_wm_out(fifo) \
+    do                             \
+    {                              \
+        if ((fifo)->wm)            \
+            __kfifo_wm_out(fifo);  \
+    } while (0)
+/* FIFO 被清空后重新等待高水位 */
+#define __kfifo_clear_wm(fifo)     \
+    do                             \
+    {                              \
+        if ((fifo)->wm)            \
+            (fifo)->wm->above = 0; \
+    } while (0)
+#else /* KFIFO_WATERMARK */
+#define __kfifo_reset_wm(fifo) ((void)(fifo))
+#define __kfifo_check_wm_in(fifo) ((void)(fifo))
+#define __kfifo_check_wm_out(fifo) ((void)(fifo))
+#define __kfifo_clear_wm(fifo) ((void)(fifo))
+#endif /* KFIFO_WATERMARK */
+
+#ifdef KFIFO_STATS
+#define __kfifo_reset_stats(fifo)                           \
+    do                                                      \
+    {                                                       \
+        memset(&(fifo)->wstats, 0, sizeof((fifo)->wstats)); \
+        memset(&(fifo)->rstats, 0, sizeof((fifo)->rstats)); \
+    } while (0)
+/* 初始化时还要清除登记的名称，链表指针只由登记/注销修改 */
+#define __kfifo_init_stats(fifo)   \
+    do                             \
+    {                              \
+        __kfifo_reset_stats(fifo); \
+        (fifo)->name = NULL;       \
+    } while (0)
+/* 写端：@n 个元素没有写入 */
+#define __kfifo_stats_short(fifo, n)   \
+    do                                 \
+    {                                  \
+        (fifo)->wstats.truncated++;    \
+        (fifo)->wstats.dropped += (n); \
+    } while (0)
+/* 读端：FIFO 为空 */
+#define __kfifo_stats_empty(fifo) ((fifo)->rstats.empty++)
+#else /* KFIFO_STATS */
+#define __kfifo_reset_stats(fifo) ((void)(fifo))
+#define __kfifo_init_stats(fifo) ((void)(fifo))
+#define __kfifo_stats_short(fifo, n) ((void)(fifo))
+#define __kfifo_stats_empty(fifo) ((void)(fifo))
+#endif /* KFIFO_STATS */
+
+#ifdef KFIFO_MIRROR
+#define __kfifo_is_mirror(fifo) ((fifo)->flags & KFIFO_F_MIRROR)
+#else /* KFIFO_MIRROR */
+#define __kfifo_is_mirror(fifo) (0)
+#endif /* KFIFO_MIRROR */
+
+#ifdef KFIFO_NPOT
+#define __kfifo_is_npot(fifo) ((fifo)->flags & KFIFO_F_NPOT)
+#else /* KFIFO_NPOT */
+#define __kfifo_is_npot(fifo) (0)
+#endif /* KFIFO_NPOT */
+
+/*
+ * internal helper to round @n up to the next power of 2, used by all the
+ * alloc functions. Returns 0 if the result does not fit into an unsigned
+ * int (@n > 2^31), which the callers reject like a too small size.
+ */
+static inline unsigned int __kfifo_roundup_pow_of_two(unsigned int n)
+{
+    unsigned int shift = 0;
+
+    if (n > (1U << 31))
+        return 0;
+
+    for (n = (n > 1) ? n - 1 : 0; n; n >>= 1)
+        shift++;
+    return 1U << shift;
+}
+
+/*
+ * internal helper to convert an index into an offset in the buffer.
+ * Indices of non power of 2 fifos run in [0, 2 * size), @idx may exceed
+ * that by less than size (e.g. index + record header).
+ */
+static inline unsigned int __kfifo_off(const struct __kfifo *fifo, unsigned int idx)
+{
+#ifdef KFIFO_NPOT
+    if (__kfifo_is_npot(fifo))
+    {
+        unsigned int size = fifo->mask + 1;
+
+        if (idx >= size)
+            idx -= size;
+        if (idx >= size)
+            idx -= size;
+        return idx;
+    }
+#endif /* KFIFO_NPOT */
+    return idx & fifo->mask;
+}
+
+/*
+ * internal helper to calculate the number of elements from @out to @in
+ */
+static inline unsigned int __kfifo_dist(const struct __kfifo *fifo,
+                                        unsigned int in, unsigned int out)
+{
+#ifdef KFIFO_NPOT
+    if (__kfifo_is_npot(fifo) && in < out)
+        return in - out + 2 * (fifo->mask + 1);
+#else /* KFIFO_NPOT */
+    (void)fifo;
+#endif /* KFIFO_NPOT */
+    return in - out;
+}
+
+/*
+ * internal helper to advance the index @idx by @n elements
+ */
+static inline unsigned int __kfifo_next(const struct __kfifo *fifo,
+                                        unsigned int idx, unsigned int n)
+{
+    idx += n;
+#ifdef KFIFO_NPOT
+    if (__kfifo_is_npot(fifo) && idx >= 2 * (fifo->mask + 1))
+        idx -= 2 * (fifo->mask + 1);
+#else /* KFIFO_NPOT */
+    (void)fifo;
+#endif /* KFIFO_NPOT */
+    return idx;
+}
+
+/*
+ * internal helper to calculate the unused elements in a fifo, only for the
+ * writer side. The cached out index is refreshed only if it does not
+ * satisfy @want elements.
+ */
+static inline unsigned int __kfifo_unused(struct __kfifo *fifo, unsigned int want)
+{
+#ifdef KFIFO_SMP
+    unsigned int size = fifo->mask + 1;
+    unsigned int in = __kfifo_load(&fifo->in);
+    unsigned int l = size - __kfifo_dist(fifo, in, fifo->out_cache);
+
+    if (l < want)
+    {
+        fifo->out_cache = __kfifo_load_acquire(&fifo->out);
+        l = size - __kfifo_dist(fifo, in, fifo->out_cache);
+    }
+    return l;
+#else /* KFIFO_SMP */
+    (void)want;
+    return (fifo->mask + 1) - __kfifo_dist(fifo, fifo->in, fifo->out);
+#endif /* KFIFO_SMP */
+}
+
+/*
+ * internal helper to calculate the used elements in a fifo, only for the
+ * reader side. The cached in index is refreshed only if it does not
+ * satisfy @want elements.
+ */
+static inline unsigned int __kfifo_used(struct __kfifo *fifo, unsigned int want)
+{
+#ifdef KFIFO_SMP
+    unsigned int out = __kfifo_load(&fifo->out);
+    unsigned int l = __kfifo_dist(fifo, fifo->in_cache, out);
+
+    if (l < want)
+    {
+        fifo->in_cache = __kfifo_load_acquire(&fifo->in);
+        l = __kfifo_dist(fifo, fifo->in_cache, out);
+    }
+    return l;
+#else /* KFIFO_SMP */
+    (void)want;
+    return __kfifo_dist(fifo, fifo->in, fifo->out);
+#endif /* KFIFO_SMP */
+}
+
+/*
+ * internal helper to publish @n elements written by the writer
+ */
+static inline void __kfifo_add_in(struct __kfifo *fifo, unsigned int n)
+{
+    unsigned int next = __kfifo_next(fifo, __kfifo_load(&fifo->in), n);
+
+    __kfifo_store_release(&fifo->in, next);
+#ifdef KFIFO_STATS
+    {
+        /* the current out, a cached one would overstate the peak */
+        unsigned int used = __kfifo_dist(fifo, next, __kfifo_load(&fifo->out));
+
+        if (used > fifo->wstats.peak)
+            fifo->wstats.peak = used;
+        fifo->wstats.bytes += (uint64_t)n * fifo->esize;
+    }
+#endif /* KFIFO_STATS */
+    __kfifo_check_wm_in(fifo);
+}
+
+/*
+ * internal helper to release @n elements consumed by the reader
+ */
+static inline void __kfifo_add_out(struct __kfifo *fifo, unsigned int n)
+{
+    unsigned int out = __kfifo_load(&fifo->out);
+    unsigned int next = __kfifo_next(fifo, out, n);
+
+#ifdef KFIFO_SMP
+    /*
+     * kfifo_skip_count() may release more elements than the cached in
+     * index knows of, keep the cache from falling behind out
+     */
+    if (n > __kfifo_dist(fifo, fifo->in_cache, out))
+        fifo->in_cache = next;
+#endif /* KFIFO_SMP */
+    __kfifo_store_release(&fifo->out, next);
+#ifdef KFIFO_STATS
+    fifo->rstats.bytes += (uint64_t)n * fifo->esize;
+#endif /* KFIFO_STATS */
+    __kfifo_check_wm_out(fifo);
+}
+
+#ifdef KFIFO_OVERWRITE
+/*
+ * internal helper for the overwrite mode: the writer drops the @n oldest
+ * elements. Only valid while no reader is accessing the fifo.
+ */
+static inline void __kfifo_drop_out(struct __kfifo *fifo, unsigned int n)
+{
+    /* the fifo is refilled right away, this is no low watermark crossing */
+    __kfifo_store_release(&fifo->out, __kfifo_next(fifo, __kfifo_load(&fifo->out), n));
+#ifdef KFIFO_SMP
+    fifo->out_cache = __kfifo_load(&fifo->out);
+    fifo->in_cache = __kfifo_load(&fifo->in);
+#endif /* KFIFO_SMP */
+}
+#endif /* KFIFO_OVERWRITE */
+
 #define __STRUCT_KFIFO_COMMON(datatype, recsize, ptrtype) \
     union                                                 \
     {                                                     \
@@ -111,9 +582,12 @@ struct __kfifo
     struct __STRUCT_KFIFO_PTR(type, 0, type)
 
 /*
- * define compatibility "struct kfifo" for dynamic allocated fifos
+ * define compatibility "struct kfifo" for dynamic allocated fifos.
+ * C++ does not allow a member named like its class, use kfifo.hpp there.
  */
+#ifndef __cplusplus
 struct kfifo __STRUCT_KFIFO_PTR(unsigned char, 0, void);
+#endif /* __cplusplus */
 
 #define STRUCT_KFIFO_REC_1(size) \
     struct __STRUCT_KFIFO(unsigned char, size, 1, void)
@@ -121,11 +595,20 @@ struct kfifo __STRUCT_KFIFO_PTR(unsigned char, 0, void);
 #define STRUCT_KFIFO_REC_2(size) \
     struct __STRUCT_KFIFO(unsigned char, size, 2, void)
 
+/*
+ * records with a 4 byte length header are word aligned and never split at
+ * the end of the buffer, the buffer follows the pointers of struct __kfifo
+ * and is therefore word aligned as well
+ */
+#define STRUCT_KFIFO_REC_4(size) \
+    struct __STRUCT_KFIFO(unsigned char, ((size) < 4) ? -1 : (size), 4, void)
+
 /*
  * define kfifo_rec types
  */
 struct kfifo_rec_ptr_1 __STRUCT_KFIFO_PTR(unsigned char, 1, void);
 struct kfifo_rec_ptr_2 __STRUCT_KFIFO_PTR(unsigned char, 2, void);
+struct kfifo_rec_ptr_4 __STRUCT_KFIFO_PTR(unsigned char, 4, void);
 
 /*
  * helper macro to distinguish between real in place fifo where the fifo
@@ -163,6 +646,11 @@ struct kfifo_rec_ptr_2 __STRUCT_KFIFO_PTR(unsigned char, 2, void);
         __kfifo->mask = __is_kfifo_ptr(__tmp) ? 0 : ARRAY_SIZE(__tmp->buf) - 1; \
         __kfifo->esize = sizeof(*__tmp->buf);                                   \
         __kfifo->data = __is_kfifo_ptr(__tmp) ? NULL : __tmp->buf;              \
+        __kfifo_reset_discarded(__kfifo);                                       \
+        __kfifo_reset_flags(__kfifo);                                           \
+        __kfifo_reset_cache(__kfifo);                                           \
+        __kfifo_reset_wm(__kfifo);                                              \
+        __kfifo_init_stats(__kfifo);                                            \
     })
 
 /**
@@ -239,6 +727,10 @@ __kfifo_int_must_check_helper(int val)
     (void)({                                    \
         typeof((fifo) + 1) __tmp = (fifo);      \
         __tmp->kfifo.in = __tmp->kfifo.out = 0; \
+        __kfifo_reset_discarded(&__tmp->kfifo); \
+        __kfifo_reset_cache(&__tmp->kfifo);     \
+        __kfifo_clear_wm(&__tmp->kfifo);        \
+        __kfifo_reset_stats(&__tmp->kfifo);     \
     })
 
 /**
@@ -249,20 +741,103 @@ __kfifo_int_must_check_helper(int val)
  * from the reader thread and there is only one concurrent reader. Otherwise
  * it is dangerous and must be handled in the same way as kfifo_reset().
  */
-#define kfifo_reset_out(fifo)               \
+#define kfifo_reset_out(fifo)                                       \
+    (void)({                                                        \
+        typeof((fifo) + 1) __tmp = (fifo);                          \
+        unsigned int __in = __kfifo_load_acquire(&__tmp->kfifo.in); \
+        __kfifo_set_in_cache(&__tmp->kfifo, __in);                  \
+        __kfifo_store_release(&__tmp->kfifo.out, __in);             \
+        __kfifo_check_wm_out(&__tmp->kfifo);                        \
+    })
+
+#ifdef KFIFO_WATERMARK
+/**
+ * kfifo_set_watermark - set the watermark hooks of a fifo
+ * @fifo: address of the fifo to be used
+ * @wm: address of a struct kfifo_watermark, NULL removes the hooks
+ *
+ * on_high is called once when the number of used elements (bytes for record
+ * fifos) rises to wm->high, on_low is called once when it afterwards falls
+ * to wm->low. The hooks run in the context of the writer resp. the reader
+ * that crossed the watermark, e.g. an interrupt handler, and should only
+ * post an event. If the fifo is already filled up to wm->high, on_high is
+ * called right away.
+ *
+ * Returns -EINVAL if wm->low is not below wm->high, otherwise 0.
+ *
+ * Note: call it only while no other thread is accessing the fifo, e.g.
+ * after the initialization.
+ */
+#define kfifo_set_watermark(fifo, wm)               \
+    ({                                              \
+        typeof((fifo) + 1) __tmp = (fifo);          \
+        __kfifo_set_watermark(&__tmp->kfifo, (wm)); \
+    })
+#endif /* KFIFO_WATERMARK */
+
+#ifdef KFIFO_STATS
+/**
+ * kfifo_stats - get a snapshot of the statistics of a fifo
+ * @fifo: address of the fifo to be used
+ * @st: address of a struct kfifo_stats to fill
+ *
+ * The writer and the reader update their counters without locking, so the
+ * snapshot may be slightly inconsistent while the fifo is in use (and the
+ * 64 bit byte counters may tear on 32 bit CPUs). That is fine for sizing.
+ */
+#define kfifo_stats(fifo, st)               \
+    (void)({                                \
+        typeof((fifo) + 1) __tmp = (fifo);  \
+        __kfifo_stats(&__tmp->kfifo, (st)); \
+    })
+
+/**
+ * kfifo_stats_reset - clear the statistics of a fifo
+ * @fifo: address of the fifo to be used
+ *
+ * The peak is set to the current occupancy. Call it only while neither the
+ * reader nor the writer is accessing the fifo.
+ */
+#define kfifo_stats_reset(fifo)             \
     (void)({                                \
         typeof((fifo) + 1) __tmp = (fifo);  \
-        __tmp->kfifo.out = __tmp->kfifo.in; \
+        __kfifo_stats_reset(&__tmp->kfifo); \
     })
 
+/**
+ * kfifo_stats_register - add a fifo to the list for kfifo_stats_foreach()
+ * @fifo: address of the fifo to be used
+ * @name: name of the fifo in the dump, must stay valid
+ *
+ * Register the fifo after its initialization. Registering twice only
+ * updates the name. kfifo_free() removes a fifo from the list. The list is
+ * not locked, register fifos during the startup.
+ */
+#define kfifo_stats_register(fifo, name)               \
+    (void)({                                           \
+        typeof((fifo) + 1) __tmp = (fifo);             \
+        __kfifo_stats_register(&__tmp->kfifo, (name)); \
+    })
+
+/**
+ * kfifo_stats_unregister - remove a fifo from the list of kfifo_stats_foreach()
+ * @fifo: address of the fifo to be used
+ */
+#define kfifo_stats_unregister(fifo)             \
+    (void)({                                     \
+        typeof((fifo) + 1) __tmp = (fifo);       \
+        __kfifo_stats_unregister(&__tmp->kfifo); \
+    })
+#endif /* KFIFO_STATS */
+
 /**
  * kfifo_len - returns the number of used elements in the fifo
  * @fifo: address of the fifo to be used
  */
-#define kfifo_len(fifo)                       \
-    ({                                        \
-        typeof((fifo) + 1) __tmpl = (fifo);   \
-        __tmpl->kfifo.in - __tmpl->kfifo.out; \
+#define kfifo_len(fifo)                                                    \
+    ({                                                                     \
+        typeof((fifo) + 1) __tmpl = (fifo);                                \
+        __kfifo_dist(&__tmpl->kfifo, __tmpl->kfifo.in, __tmpl->kfifo.out); \
     })
 
 /**
@@ -298,6 +873,17 @@ __kfifo_int_must_check_helper(int val)
             (__recsize) ? ((__avail <= __recsize) ? 0 : __kfifo_max_r(__avail - __recsize, __recsize)) : __avail; \
         }))
 
+#ifdef KFIFO_OVERWRITE
+/**
+ * kfifo_discarded - returns the number of discarded elements or records
+ * @fifo: address of the fifo to be used
+ *
+ * Counts the oldest elements (or whole records for record fifos) dropped by
+ * kfifo_in_overwrite() and kfifo_put_overwrite(). Cleared by kfifo_reset().
+ */
+#define kfifo_discarded(fifo) ((fifo)->kfifo.discarded)
+#endif /* KFIFO_OVERWRITE */
+
 /**
  * kfifo_skip_count - skip output data
  * @fifo: address of the fifo to be used
@@ -312,7 +898,7 @@ __kfifo_int_must_check_helper(int val)
         if (__recsize)                                    \
             __kfifo_skip_r(__kfifo, __recsize);           \
         else                                              \
-            __kfifo->out += (count);                      \
+            __kfifo_add_out(__kfifo, (count));            \
     } while (0)
 
 /**
@@ -336,6 +922,40 @@ __kfifo_int_must_check_helper(int val)
             (!__recsize) ? kfifo_len(__tmp) * sizeof(*__tmp->type) : __kfifo_len_r(__kfifo, __recsize); \
         }))
 
+/**
+ * kfifo_peek_record_ptr - gets a pointer to the payload of the next record
+ * @fifo: address of the fifo to be used
+ * @ptr: pointer to data to store the pointer to the payload
+ *
+ * Only for record fifos with a 4 byte length header (STRUCT_KFIFO_REC_4,
+ * struct kfifo_rec_ptr_4): the payload is 4 byte aligned and never split at
+ * the end of the buffer, so a struct can be accessed in place without
+ * copying. Release the record with kfifo_skip().
+ *
+ * This macro returns the length of the next record or 0 if the fifo is empty.
+ */
+#define kfifo_peek_record_ptr(fifo, ptr)                                      \
+    __kfifo_uint_must_check_helper(                                           \
+        ({                                                                    \
+            typeof((fifo) + 1) ___tmp = (fifo);                               \
+            unsigned int ___tail = 0;                                         \
+            unsigned int ___n;                                                \
+            (void)sizeof(char[kfifo_recsize(___tmp) == 4 ? 1 : -1]);          \
+            ___n = __kfifo_out_linear_r(&___tmp->kfifo, &___tail, ~0U, 4);    \
+            *(ptr) = (void *)((unsigned char *)___tmp->kfifo.data + ___tail); \
+            ___n;                                                             \
+        }))
+
+/*
+ * internal helper for the init and alloc macros: the 4 byte record headers
+ * are accessed as uint32_t, so the buffer of such a record fifo must be 4
+ * byte aligned and a multiple of 4 bytes. Otherwise the fifo is released
+ * (@owned) or left empty, and -EINVAL is returned. @ret is the result of the
+ * init or alloc function and evaluated twice.
+ */
+#define __kfifo_check_rec_4(fifo, ret, owned) \
+    ((!(ret) && kfifo_recsize(fifo) == 4) ? __kfifo_rec_4_check(&(fifo)->kfifo, (owned)) : (ret))
+
 /**
  * kfifo_alloc - dynamically allocates a new fifo buffer
  * @fifo: pointer to the fifo
@@ -347,12 +967,13 @@ __kfifo_int_must_check_helper(int val)
  * The fifo will be release with kfifo_free().
  * Return 0 if no error, otherwise an error code.
  */
-#define kfifo_alloc(fifo, size)                                                                   \
-    __kfifo_int_must_check_helper(                                                                \
-        ({                                                                                        \
-            typeof((fifo) + 1) __tmp = (fifo);                                                    \
-            struct __kfifo *__kfifo = &__tmp->kfifo;                                              \
-            __is_kfifo_ptr(__tmp) ? __kfifo_alloc(__kfifo, size, sizeof(*__tmp->type)) : -EINVAL; \
+#define kfifo_alloc(fifo, size)                                                                               \
+    __kfifo_int_must_check_helper(                                                                            \
+        ({                                                                                                    \
+            typeof((fifo) + 1) __tmp = (fifo);                                                                \
+            struct __kfifo *__kfifo = &__tmp->kfifo;                                                          \
+            int __ret = __is_kfifo_ptr(__tmp) ? __kfifo_alloc(__kfifo, size, sizeof(*__tmp->type)) : -EINVAL; \
+            __kfifo_check_rec_4(__tmp, __ret, 1);                                                             \
         }))
 
 /**
@@ -378,13 +999,52 @@ __kfifo_int_must_check_helper(int val)
  * The number of elements will be rounded-up to a power of 2.
  * Return 0 if no error, otherwise an error code.
  */
-#define kfifo_init(fifo, buffer, size)                                                               \
-    ({                                                                                               \
-        typeof((fifo) + 1) __tmp = (fifo);                                                           \
-        struct __kfifo *__kfifo = &__tmp->kfifo;                                                     \
-        __is_kfifo_ptr(__tmp) ? __kfifo_init(__kfifo, buffer, size, sizeof(*__tmp->type)) : -EINVAL; \
+#define kfifo_init(fifo, buffer, size)                                                                           \
+    ({                                                                                                           \
+        typeof((fifo) + 1) __tmp = (fifo);                                                                       \
+        struct __kfifo *__kfifo = &__tmp->kfifo;                                                                 \
+        int __ret = __is_kfifo_ptr(__tmp) ? __kfifo_init(__kfifo, buffer, size, sizeof(*__tmp->type)) : -EINVAL; \
+        __kfifo_check_rec_4(__tmp, __ret, 0);                                                                    \
     })
 
+#ifdef KFIFO_NPOT
+/**
+ * kfifo_alloc_npot - dynamically allocates a new fifo buffer of any size
+ * @fifo: pointer to the fifo
+ * @size: the number of elements in the fifo
+ *
+ * Like kfifo_alloc(), but the number of elements is not rounded-up to a
+ * power of 2. The fifo will be release with kfifo_free().
+ * Return 0 if no error, otherwise an error code.
+ */
+#define kfifo_alloc_npot(fifo, size)                                                                               \
+    __kfifo_int_must_check_helper(                                                                                 \
+        ({                                                                                                         \
+            typeof((fifo) + 1) __tmp = (fifo);                                                                     \
+            struct __kfifo *__kfifo = &__tmp->kfifo;                                                               \
+            int __ret = __is_kfifo_ptr(__tmp) ? __kfifo_alloc_npot(__kfifo, size, sizeof(*__tmp->type)) : -EINVAL; \
+            __kfifo_check_rec_4(__tmp, __ret, 1);                                                                  \
+        }))
+
+/**
+ * kfifo_init_npot - initialize a fifo of any size using a preallocated buffer
+ * @fifo: the fifo to assign the buffer
+ * @buffer: the preallocated buffer to be used
+ * @size: the size of the internal buffer in bytes
+ *
+ * Like kfifo_init(), but the whole buffer is used instead of rounding the
+ * number of elements down to a power of 2.
+ * Return 0 if no error, otherwise an error code.
+ */
+#define kfifo_init_npot(fifo, buffer, size)                                                                           \
+    ({                                                                                                                \
+        typeof((fifo) + 1) __tmp = (fifo);                                                                            \
+        struct __kfifo *__kfifo = &__tmp->kfifo;                                                                      \
+        int __ret = __is_kfifo_ptr(__tmp) ? __kfifo_init_npot(__kfifo, buffer, size, sizeof(*__tmp->type)) : -EINVAL; \
+        __kfifo_check_rec_4(__tmp, __ret, 0);                                                                         \
+    })
+#endif /* KFIFO_NPOT */
+
 /**
  * kfifo_put - put data into the fifo
  * @fifo: address of the fifo to be used
@@ -397,30 +1057,73 @@ __kfifo_int_must_check_helper(int val)
  * Note that with only one concurrent reader and one concurrent
  * writer, you don't need extra locking to use these macro.
  */
-#define kfifo_put(fifo, val)                                                                                                     \
-    ({                                                                                                                           \
-        typeof((fifo) + 1) __tmp = (fifo);                                                                                       \
-        typeof(*__tmp->const_type) __val = (val);                                                                                \
-        unsigned int __ret;                                                                                                      \
-        size_t __recsize = sizeof(*__tmp->rectype);                                                                              \
-        struct __kfifo *__kfifo = &__tmp->kfifo;                                                                                 \
-        if (__recsize)                                                                                                           \
-            __ret = __kfifo_in_r(__kfifo, &__val, sizeof(__val),                                                                 \
-                                 __recsize);                                                                                     \
-        else                                                                                                                     \
-        {                                                                                                                        \
-            __ret = !kfifo_is_full(__tmp);                                                                                       \
-            if (__ret)                                                                                                           \
-            {                                                                                                                    \
-                (__is_kfifo_ptr(__tmp) ? ((typeof(__tmp->type))__kfifo->data) : (__tmp->buf))[__kfifo->in & __tmp->kfifo.mask] = \
-                    *(typeof(__tmp->type))&__val;                                                                                \
-                smp_wmb();                                                                                                       \
-                __kfifo->in++;                                                                                                   \
-            }                                                                                                                    \
-        }                                                                                                                        \
-        __ret;                                                                                                                   \
+#define kfifo_put(fifo, val)                                                                                                                      \
+    ({                                                                                                                                            \
+        typeof((fifo) + 1) __tmp = (fifo);                                                                                                        \
+        typeof(*__tmp->const_type) __val = (val);                                                                                                 \
+        unsigned int __ret;                                                                                                                       \
+        size_t __recsize = sizeof(*__tmp->rectype);                                                                                               \
+        struct __kfifo *__kfifo = &__tmp->kfifo;                                                                                                  \
+        if (__recsize)                                                                                                                            \
+            __ret = __kfifo_in_r(__kfifo, &__val, sizeof(__val),                                                                                  \
+                                 __recsize);                                                                                                      \
+        else                                                                                                                                      \
+        {                                                                                                                                         \
+            __ret = __kfifo_unused(__kfifo, 1) != 0;                                                                                              \
+            if (__ret)                                                                                                                            \
+            {                                                                                                                                     \
+                (__is_kfifo_ptr(__tmp) ? ((typeof(__tmp->type))__kfifo->data) : (__tmp->buf))[__kfifo_off(__kfifo, __kfifo_load(&__kfifo->in))] = \
+                    *(typeof(__tmp->type))&__val;                                                                                                 \
+                __kfifo_add_in(__kfifo, 1);                                                                                                       \
+            }                                                                                                                                     \
+            else                                                                                                                                  \
+                __kfifo_stats_short(__kfifo, 1);                                                                                                  \
+        }                                                                                                                                         \
+        __ret;                                                                                                                                    \
     })
 
+#ifdef KFIFO_OVERWRITE
+/**
+ * kfifo_put_overwrite - put data into the fifo, overwriting the oldest data
+ * @fifo: address of the fifo to be used
+ * @val: the data to be added
+ *
+ * This macro copies the given value into the fifo. If the fifo is full the
+ * oldest element (or the oldest whole records for record fifos) is dropped
+ * and counted in kfifo_discarded().
+ * It returns the number processed elements, 0 only if the record does not
+ * fit into an empty fifo.
+ *
+ * Note that the writer moves the out index, so unlike kfifo_put() this is
+ * not safe against a concurrent reader. The reader must be excluded (lock,
+ * disabled interrupt) while this macro runs.
+ */
+#define kfifo_put_overwrite(fifo, val)                                                                                                        \
+    ({                                                                                                                                        \
+        typeof((fifo) + 1) __tmp = (fifo);                                                                                                    \
+        typeof(*__tmp->const_type) __val = (val);                                                                                             \
+        unsigned int __ret;                                                                                                                   \
+        size_t __recsize = sizeof(*__tmp->rectype);                                                                                           \
+        struct __kfifo *__kfifo = &__tmp->kfifo;                                                                                              \
+        if (__recsize)                                                                                                                        \
+            __ret = __kfifo_in_overwrite_r(__kfifo, &__val, sizeof(__val),                                                                    \
+                                           __recsize);                                                                                        \
+        else                                                                                                                                  \
+        {                                                                                                                                     \
+            if (!__kfifo_unused(__kfifo, 1))                                                                                                  \
+            {                                                                                                                                 \
+                __kfifo_drop_out(__kfifo, 1);                                                                                                 \
+                __kfifo->discarded++;                                                                                                         \
+            }                                                                                                                                 \
+            (__is_kfifo_ptr(__tmp) ? ((typeof(__tmp->type))__kfifo->data) : (__tmp->buf))[__kfifo_off(__kfifo, __kfifo_load(&__kfifo->in))] = \
+                *(typeof(__tmp->type))&__val;                                                                                                 \
+            __kfifo_add_in(__kfifo, 1);                                                                                                       \
+            __ret = 1;                                                                                                                        \
+        }                                                                                                                                     \
+        __ret;                                                                                                                                \
+    })
+#endif /* KFIFO_OVERWRITE */
+
 /**
  * kfifo_get - get data from the fifo
  * @fifo: address of the fifo to be used
@@ -433,29 +1136,30 @@ __kfifo_int_must_check_helper(int val)
  * Note that with only one concurrent reader and one concurrent
  * writer, you don't need extra locking to use these macro.
  */
-#define kfifo_get(fifo, val)                                                                                                             \
-    __kfifo_uint_must_check_helper(                                                                                                      \
-        ({                                                                                                                               \
-            typeof((fifo) + 1) __tmp = (fifo);                                                                                           \
-            typeof(__tmp->ptr) __val = (val);                                                                                            \
-            unsigned int __ret;                                                                                                          \
-            const size_t __recsize = sizeof(*__tmp->rectype);                                                                            \
-            struct __kfifo *__kfifo = &__tmp->kfifo;                                                                                     \
-            if (__recsize)                                                                                                               \
-                __ret = __kfifo_out_r(__kfifo, __val, sizeof(*__val),                                                                    \
-                                      __recsize);                                                                                        \
-            else                                                                                                                         \
-            {                                                                                                                            \
-                __ret = !kfifo_is_empty(__tmp);                                                                                          \
-                if (__ret)                                                                                                               \
-                {                                                                                                                        \
-                    *(typeof(__tmp->type))__val =                                                                                        \
-                        (__is_kfifo_ptr(__tmp) ? ((typeof(__tmp->type))__kfifo->data) : (__tmp->buf))[__kfifo->out & __tmp->kfifo.mask]; \
-                    smp_wmb();                                                                                                           \
-                    __kfifo->out++;                                                                                                      \
-                }                                                                                                                        \
-            }                                                                                                                            \
-            __ret;                                                                                                                       \
+#define kfifo_get(fifo, val)                                                                                                                              \
+    __kfifo_uint_must_check_helper(                                                                                                                       \
+        ({                                                                                                                                                \
+            typeof((fifo) + 1) __tmp = (fifo);                                                                                                            \
+            typeof(__tmp->ptr) __val = (val);                                                                                                             \
+            unsigned int __ret;                                                                                                                           \
+            const size_t __recsize = sizeof(*__tmp->rectype);                                                                                             \
+            struct __kfifo *__kfifo = &__tmp->kfifo;                                                                                                      \
+            if (__recsize)                                                                                                                                \
+                __ret = __kfifo_out_r(__kfifo, __val, sizeof(*__val),                                                                                     \
+                                      __recsize);                                                                                                         \
+            else                                                                                                                                          \
+            {                                                                                                                                             \
+                __ret = __kfifo_used(__kfifo, 1) != 0;                                                                                                    \
+                if (__ret)                                                                                                                                \
+                {                                                                                                                                         \
+                    *(typeof(__tmp->type))__val =                                                                                                         \
+                        (__is_kfifo_ptr(__tmp) ? ((typeof(__tmp->type))__kfifo->data) : (__tmp->buf))[__kfifo_off(__kfifo, __kfifo_load(&__kfifo->out))]; \
+                    __kfifo_add_out(__kfifo, 1);                                                                                                          \
+                }                                                                                                                                         \
+                else                                                                                                                                      \
+                    __kfifo_stats_empty(__kfifo);                                                                                                         \
+            }                                                                                                                                             \
+            __ret;                                                                                                                                        \
         }))
 
 /**
@@ -470,28 +1174,27 @@ __kfifo_int_must_check_helper(int val)
  * Note that with only one concurrent reader and one concurrent
  * writer, you don't need extra locking to use these macro.
  */
-#define kfifo_peek(fifo, val)                                                                                                            \
-    __kfifo_uint_must_check_helper(                                                                                                      \
-        ({                                                                                                                               \
-            typeof((fifo) + 1) __tmp = (fifo);                                                                                           \
-            typeof(__tmp->ptr) __val = (val);                                                                                            \
-            unsigned int __ret;                                                                                                          \
-            const size_t __recsize = sizeof(*__tmp->rectype);                                                                            \
-            struct __kfifo *__kfifo = &__tmp->kfifo;                                                                                     \
-            if (__recsize)                                                                                                               \
-                __ret = __kfifo_out_peek_r(__kfifo, __val, sizeof(*__val),                                                               \
-                                           __recsize);                                                                                   \
-            else                                                                                                                         \
-            {                                                                                                                            \
-                __ret = !kfifo_is_empty(__tmp);                                                                                          \
-                if (__ret)                                                                                                               \
-                {                                                                                                                        \
-                    *(typeof(__tmp->type))__val =                                                                                        \
-                        (__is_kfifo_ptr(__tmp) ? ((typeof(__tmp->type))__kfifo->data) : (__tmp->buf))[__kfifo->out & __tmp->kfifo.mask]; \
-                    smp_wmb();                                                                                                           \
-                }                                                                                                                        \
-            }                                                                                                                            \
-            __ret;                                                                                                                       \
+#define kfifo_peek(fifo, val)                                                                                                                             \
+    __kfifo_uint_must_check_helper(                                                                                                                       \
+        ({                                                                                                                                                \
+            typeof((fifo) + 1) __tmp = (fifo);                                                                                                            \
+            typeof(__tmp->ptr) __val = (val);                                                                                                             \
+            unsigned int __ret;                                                                                                                           \
+            const size_t __recsize = sizeof(*__tmp->rectype);                                                                                             \
+            struct __kfifo *__kfifo = &__tmp->kfifo;                                                                                                      \
+            if (__recsize)                                                                                                                                \
+                __ret = __kfifo_out_peek_r(__kfifo, __val, sizeof(*__val),                                                                                \
+                                           __recsize);                                                                                                    \
+            else                                                                                                                                          \
+            {                                                                                                                                             \
+                __ret = __kfifo_used(__kfifo, 1) != 0;                                                                                                    \
+                if (__ret)                                                                                                                                \
+                {                                                                                                                                         \
+                    *(typeof(__tmp->type))__val =                                                                                                         \
+                        (__is_kfifo_ptr(__tmp) ? ((typeof(__tmp->type))__kfifo->data) : (__tmp->buf))[__kfifo_off(__kfifo, __kfifo_load(&__kfifo->out))]; \
+                }                                                                                                                                         \
+            }                                                                                                                                             \
+            __ret;                                                                                                                                        \
         }))
 
 /**
@@ -506,16 +1209,47 @@ __kfifo_int_must_check_helper(int val)
  * Note that with only one concurrent reader and one concurrent
  * writer, you don't need extra locking to use these macro.
  */
-#define kfifo_in(fifo, buf, n)                                                                        \
-    ({                                                                                                \
-        typeof((fifo) + 1) __tmp = (fifo);                                                            \
-        typeof(__tmp->ptr_const) __buf = (buf);                                                       \
-        unsigned long __n = (n);                                                                      \
-        const size_t __recsize = sizeof(*__tmp->rectype);                                             \
-        struct __kfifo *__kfifo = &__tmp->kfifo;                                                      \
-        (__recsize) ? __kfifo_in_r(__kfifo, __buf, __n, __recsize) : __kfifo_in(__kfifo, __buf, __n); \
+#define kfifo_in(fifo, buf, n)                                                                                                    \
+    ({                                                                                                                            \
+        typeof((fifo) + 1) __tmp = (fifo);                                                                                        \
+        typeof(__tmp->ptr_const) __buf = (buf);                                                                                   \
+        unsigned long __n = (n);                                                                                                  \
+        const size_t __recsize = sizeof(*__tmp->rectype);                                                                         \
+        struct __kfifo *__kfifo = &__tmp->kfifo;                                                                                  \
+        (__recsize) ? __kfifo_in_r(__kfifo, __buf, __n, __recsize) : __kfifo_in_esize(__kfifo, __buf, __n, sizeof(*__tmp->type)); \
     })
 
+#ifdef KFIFO_OVERWRITE
+/**
+ * kfifo_in_overwrite - put data into the fifo, overwriting the oldest data
+ * @fifo: address of the fifo to be used
+ * @buf: the data to be added
+ * @n: number of elements to be added
+ *
+ * This macro copies the given buffer into the fifo. If there is not enough
+ * space the oldest elements are dropped, so the fifo always keeps the newest
+ * kfifo_size() elements. For record fifos whole records are dropped from the
+ * tail until the new record fits. Dropped elements/records are counted in
+ * kfifo_discarded().
+ *
+ * It returns the number of copied elements (record fifos: the record length,
+ * or 0 if the record can never fit into the fifo).
+ *
+ * Note that the writer moves the out index, so unlike kfifo_in() this is
+ * not safe against a concurrent reader. The reader must be excluded (lock,
+ * disabled interrupt) while this macro runs.
+ */
+#define kfifo_in_overwrite(fifo, buf, n)                                                                                  \
+    ({                                                                                                                    \
+        typeof((fifo) + 1) __tmp = (fifo);                                                                                \
+        typeof(__tmp->ptr_const) __buf = (buf);                                                                           \
+        unsigned long __n = (n);                                                                                          \
+        const size_t __recsize = sizeof(*__tmp->rectype);                                                                 \
+        struct __kfifo *__kfifo = &__tmp->kfifo;                                                                          \
+        (__recsize) ? __kfifo_in_overwrite_r(__kfifo, __buf, __n, __recsize) : __kfifo_in_overwrite(__kfifo, __buf, __n); \
+    })
+#endif /* KFIFO_OVERWRITE */
+
 /**
  * kfifo_out - get data from the fifo
  * @fifo: address of the fifo to be used
@@ -528,15 +1262,42 @@ __kfifo_int_must_check_helper(int val)
  * Note that with only one concurrent reader and one concurrent
  * writer, you don't need extra locking to use these macro.
  */
-#define kfifo_out(fifo, buf, n)                                                                             \
-    __kfifo_uint_must_check_helper(                                                                         \
-        ({                                                                                                  \
-            typeof((fifo) + 1) __tmp = (fifo);                                                              \
-            typeof(__tmp->ptr) __buf = (buf);                                                               \
-            unsigned long __n = (n);                                                                        \
-            const size_t __recsize = sizeof(*__tmp->rectype);                                               \
-            struct __kfifo *__kfifo = &__tmp->kfifo;                                                        \
-            (__recsize) ? __kfifo_out_r(__kfifo, __buf, __n, __recsize) : __kfifo_out(__kfifo, __buf, __n); \
+#define kfifo_out(fifo, buf, n)                                                                                                         \
+    __kfifo_uint_must_check_helper(                                                                                                     \
+        ({                                                                                                                              \
+            typeof((fifo) + 1) __tmp = (fifo);                                                                                          \
+            typeof(__tmp->ptr) __buf = (buf);                                                                                           \
+            unsigned long __n = (n);                                                                                                    \
+            const size_t __recsize = sizeof(*__tmp->rectype);                                                                           \
+            struct __kfifo *__kfifo = &__tmp->kfifo;                                                                                    \
+            (__recsize) ? __kfifo_out_r(__kfifo, __buf, __n, __recsize) : __kfifo_out_esize(__kfifo, __buf, __n, sizeof(*__tmp->type)); \
+        }))
+
+/**
+ * kfifo_out_records - get many records from the fifo
+ * @fifo: address of the fifo to be used
+ * @buf: pointer to the storage buffer
+ * @buflen: size of the storage buffer in bytes
+ * @lens: array to store the length of each record
+ * @max: max. number of records to get
+ *
+ * This macro copies as many whole records as fit into @buf back to back,
+ * stores their lengths in @lens and removes them from the fifo with a
+ * single update of the out index. Like kfifo_out(), a first record larger
+ * than @buflen is truncated. Only for record fifos, it returns 0 otherwise.
+ *
+ * This macro returns the number of records copied.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo_out_records(fifo, buf, buflen, lens, max)                                                  \
+    __kfifo_uint_must_check_helper(                                                                      \
+        ({                                                                                               \
+            typeof((fifo) + 1) __tmp = (fifo);                                                           \
+            const size_t __recsize = sizeof(*__tmp->rectype);                                            \
+            struct __kfifo *__kfifo = &__tmp->kfifo;                                                     \
+            (__recsize) ? __kfifo_out_records_r(__kfifo, (buf), (buflen), (lens), (max), __recsize) : 0; \
         }))
 
 /**
@@ -562,6 +1323,60 @@ __kfifo_int_must_check_helper(int val)
             (__recsize) ? __kfifo_out_peek_r(__kfifo, __buf, __n, __recsize) : __kfifo_out_peek(__kfifo, __buf, __n); \
         }))
 
+/**
+ * kfifo_peek_at - gets some data at an offset from the fifo
+ * @fifo: address of the fifo to be used
+ * @offset: number of elements to pass over from the head of the fifo
+ * @buf: pointer to the storage buffer
+ * @n: max. number of elements to get
+ *
+ * This macro gets the data starting @offset elements after the head of the
+ * fifo and returns the numbers of elements copied, 0 if the fifo does not
+ * hold more than @offset elements. The data is not removed from the fifo.
+ *
+ * This macro is not available for record fifos, it returns 0 for them.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo_peek_at(fifo, offset, buf, n)                                       \
+    __kfifo_uint_must_check_helper(                                               \
+        ({                                                                        \
+            typeof((fifo) + 1) __tmp = (fifo);                                    \
+            typeof(__tmp->ptr) __buf = (buf);                                     \
+            unsigned long __n = (n);                                              \
+            const size_t __recsize = sizeof(*__tmp->rectype);                     \
+            struct __kfifo *__kfifo = &__tmp->kfifo;                              \
+            (__recsize) ? 0 : __kfifo_out_peek_at(__kfifo, __buf, __n, (offset)); \
+        }))
+
+/**
+ * kfifo_find_byte - searches a byte in the fifo
+ * @fifo: address of the fifo to be used
+ * @value: the byte to search for
+ * @start: number of elements to pass over from the head of the fifo
+ *
+ * This macro scans the data in place (memchr() over the one or two
+ * contiguous parts of the buffer) and returns the offset of the first byte
+ * equal to @value from the head of the fifo, or -1 if it is not found. A
+ * parser can look for a frame terminator without copying, and call it again
+ * with @start set to the length already scanned when more data arrived.
+ *
+ * Only for fifos with 1 byte elements. Not available for record fifos, it
+ * returns -1 for them.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo_find_byte(fifo, value, start)                                             \
+    ({                                                                                  \
+        typeof((fifo) + 1) __tmp = (fifo);                                              \
+        const size_t __recsize = sizeof(*__tmp->rectype);                               \
+        struct __kfifo *__kfifo = &__tmp->kfifo;                                        \
+        (void)sizeof(char[sizeof(*__tmp->type) == 1 ? 1 : -1]);                         \
+        (__recsize) ? -1 : __kfifo_find_byte(__kfifo, (unsigned char)(value), (start)); \
+    })
+
 /**
  * kfifo_out_linear - gets a tail of/offset to available data
  * @fifo: address of the fifo to be used
@@ -615,32 +1430,262 @@ __kfifo_int_must_check_helper(int val)
             ___n;                                                                                                 \
         }))
 
+/**
+ * kfifo_in_linear - gets a head of/offset to free space
+ * @fifo: address of the fifo to be used
+ * @head: pointer to an unsigned int to store the value of head
+ * @n: max. number of elements to reserve
+ *
+ * This macro obtains the offset (head) to the free space in the fifo
+ * buffer and returns the numbers of elements which can be written there.
+ * It returns the free count till the end of free space or till the end of
+ * the buffer. So that the producer can fill (@fifo->data + @head) directly
+ * (e.g. from a DMA or a driver receive routine) and then publish the data
+ * with kfifo_in_commit().
+ *
+ * This macro is not available for record fifos, it returns 0 for them.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo_in_linear(fifo, head, n)                                 \
+    __kfifo_uint_must_check_helper(                                    \
+        ({                                                             \
+            typeof((fifo) + 1) __tmp = (fifo);                         \
+            unsigned int *__head = (head);                             \
+            unsigned long __n = (n);                                   \
+            const size_t __recsize = sizeof(*__tmp->rectype);          \
+            struct __kfifo *__kfifo = &__tmp->kfifo;                   \
+            (__recsize) ? 0 : __kfifo_in_linear(__kfifo, __head, __n); \
+        }))
+
+/**
+ * kfifo_in_linear_ptr - gets a pointer to the free space
+ * @fifo: address of the fifo to be used
+ * @ptr: pointer to data to store the pointer to head
+ * @n: max. number of elements to reserve
+ *
+ * Similarly to kfifo_in_linear(), this macro obtains the pointer to the
+ * free space in the fifo buffer and returns the numbers of elements which
+ * can be written there without wrapping. The written elements are not
+ * visible to the reader until kfifo_in_commit() is called.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo_in_linear_ptr(fifo, ptr, n)                                                                         \
+    __kfifo_uint_must_check_helper(                                                                               \
+        ({                                                                                                        \
+            typeof((fifo) + 1) ___tmp = (fifo);                                                                   \
+            unsigned int ___head;                                                                                 \
+            unsigned int ___n = kfifo_in_linear(___tmp, &___head, (n));                                           \
+            *(ptr) = (typeof(___tmp->type))((unsigned char *)___tmp->kfifo.data + ___head * kfifo_esize(___tmp)); \
+            ___n;                                                                                                 \
+        }))
+
+/**
+ * kfifo_in_commit - publish data written into the reserved free space
+ * @fifo: address of the fifo to be used
+ * @n: number of elements to publish
+ *
+ * This macro makes @n elements written through kfifo_in_linear() or
+ * kfifo_in_linear_ptr() visible to the reader. @n must not be greater than
+ * the count returned by the reservation.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo_in_commit(fifo, n)            \
+    (void)({                                \
+        typeof((fifo) + 1) __tmp = (fifo);  \
+        __kfifo_add_in(&__tmp->kfifo, (n)); \
+    })
+
+/**
+ * struct kfifo_dma_seg - one contiguous region of the fifo buffer
+ * @addr: start address of the region
+ * @len: length of the region in bytes
+ *
+ * The layout matches struct iovec, a filled array can be handed to a DMA
+ * controller (as a chained/linked-list transfer) or to readv()/writev().
+ */
+struct kfifo_dma_seg
+{
+    void *addr;
+    size_t len;
+};
+
+/**
+ * kfifo_dma_in_prepare - setup the segments for DMA input
+ * @fifo: address of the fifo to be used
+ * @seg: pointer to the kfifo_dma_seg array
+ * @nents: number of entries in the seg array, at most 2 are used
+ * @len: number of elements to transfer
+ *
+ * This macro fills @seg with the (up to two, when the free space wraps)
+ * regions of the free space and returns the number of entries filled.
+ * A zero means there is no space available and the segments are not filled.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo_dma_in_prepare(fifo, seg, nents, len)                                                                                                 \
+    ({                                                                                                                                              \
+        typeof((fifo) + 1) __tmp = (fifo);                                                                                                          \
+        struct kfifo_dma_seg *__seg = (seg);                                                                                                        \
+        int __nents = (nents);                                                                                                                      \
+        unsigned int __len = (len);                                                                                                                 \
+        const size_t __recsize = sizeof(*__tmp->rectype);                                                                                           \
+        struct __kfifo *__kfifo = &__tmp->kfifo;                                                                                                    \
+        (__recsize) ? __kfifo_dma_in_prepare_r(__kfifo, __seg, __nents, __len, __recsize) : __kfifo_dma_in_prepare(__kfifo, __seg, __nents, __len); \
+    })
+
+/**
+ * kfifo_dma_in_finish - finish a DMA IN operation
+ * @fifo: address of the fifo to be used
+ * @len: number of elements received
+ *
+ * This macro finishes a DMA IN operation. The in counter will be updated by
+ * the len parameter. For record fifos @len is the length of the received
+ * record and its header is written here. No error checking will be done.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo_dma_in_finish(fifo, len)                          \
+    (void)({                                                    \
+        typeof((fifo) + 1) __tmp = (fifo);                      \
+        unsigned int __len = (len);                             \
+        const size_t __recsize = sizeof(*__tmp->rectype);       \
+        struct __kfifo *__kfifo = &__tmp->kfifo;                \
+        if (__recsize)                                          \
+            __kfifo_dma_in_finish_r(__kfifo, __len, __recsize); \
+        else                                                    \
+            __kfifo_add_in(__kfifo, __len);                     \
+    })
+
+/**
+ * kfifo_dma_out_prepare - setup the segments for DMA output
+ * @fifo: address of the fifo to be used
+ * @seg: pointer to the kfifo_dma_seg array
+ * @nents: number of entries in the seg array, at most 2 are used
+ * @len: number of elements to transfer
+ *
+ * This macro fills @seg with the (up to two, when the used space wraps)
+ * regions of the available data and returns the number of entries filled.
+ * A zero means there is no data available and the segments are not filled.
+ * For record fifos only the next record is described.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo_dma_out_prepare(fifo, seg, nents, len)                                                                                                  \
+    ({                                                                                                                                                \
+        typeof((fifo) + 1) __tmp = (fifo);                                                                                                            \
+        struct kfifo_dma_seg *__seg = (seg);                                                                                                          \
+        int __nents = (nents);                                                                                                                        \
+        unsigned int __len = (len);                                                                                                                   \
+        const size_t __recsize = sizeof(*__tmp->rectype);                                                                                             \
+        struct __kfifo *__kfifo = &__tmp->kfifo;                                                                                                      \
+        (__recsize) ? __kfifo_dma_out_prepare_r(__kfifo, __seg, __nents, __len, __recsize) : __kfifo_dma_out_prepare(__kfifo, __seg, __nents, __len); \
+    })
+
+/**
+ * kfifo_dma_out_finish - finish a DMA OUT operation
+ * @fifo: address of the fifo to be used
+ * @len: number of elements transferred
+ *
+ * This macro finishes a DMA OUT operation. The out counter will be updated
+ * by the len parameter. For record fifos the whole record is removed and
+ * @len is ignored. No error checking will be done.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo_dma_out_finish(fifo, len) kfifo_skip_count(fifo, len)
+
 extern int __kfifo_alloc(struct __kfifo *fifo, unsigned int size,
                          size_t esize);
 
 extern void __kfifo_free(struct __kfifo *fifo);
 
+#ifdef KFIFO_MIRROR
+extern void __kfifo_free_mirror(struct __kfifo *fifo);
+#endif /* KFIFO_MIRROR */
+
 extern int __kfifo_init(struct __kfifo *fifo, void *buffer,
                         unsigned int size, size_t esize);
 
+extern int __kfifo_rec_4_check(struct __kfifo *fifo, int owned);
+
+#ifdef KFIFO_NPOT
+extern int __kfifo_alloc_npot(struct __kfifo *fifo, unsigned int size,
+                              size_t esize);
+
+extern int __kfifo_init_npot(struct __kfifo *fifo, void *buffer,
+                             unsigned int size, size_t esize);
+#endif /* KFIFO_NPOT */
+
+#ifdef KFIFO_WATERMARK
+extern int __kfifo_set_watermark(struct __kfifo *fifo, struct kfifo_watermark *wm);
+#endif /* KFIFO_WATERMARK */
+
+#ifdef KFIFO_STATS
+extern void __kfifo_stats(struct __kfifo *fifo, struct kfifo_stats *st);
+
+extern void __kfifo_stats_reset(struct __kfifo *fifo);
+
+extern void __kfifo_stats_register(struct __kfifo *fifo, const char *name);
+
+extern void __kfifo_stats_unregister(struct __kfifo *fifo);
+
+/**
+ * kfifo_stats_foreach - call @fn with a snapshot of every registered fifo
+ * @fn: callback, e.g. printing one line per fifo
+ * @arg: passed to @fn
+ */
+extern void kfifo_stats_foreach(void (*fn)(const struct kfifo_stats *st, void *arg), void *arg);
+#endif /* KFIFO_STATS */
+
 extern unsigned int __kfifo_in(struct __kfifo *fifo,
                                const void *buf, unsigned int len);
 
+#ifdef KFIFO_OVERWRITE
+extern unsigned int __kfifo_in_overwrite(struct __kfifo *fifo,
+                                        const void *buf, unsigned int len);
+#endif /* KFIFO_OVERWRITE */
+
 extern unsigned int __kfifo_out(struct __kfifo *fifo,
                                 void *buf, unsigned int len);
 
 extern unsigned int __kfifo_out_peek(struct __kfifo *fifo,
                                      void *buf, unsigned int len);
 
+extern unsigned int __kfifo_out_peek_at(struct __kfifo *fifo,
+                                        void *buf, unsigned int len, unsigned int offset);
+
+extern int __kfifo_find_byte(struct __kfifo *fifo, unsigned char c, unsigned int start);
+
 extern unsigned int __kfifo_out_linear(struct __kfifo *fifo,
                                        unsigned int *tail, unsigned int n);
 
+extern unsigned int __kfifo_in_linear(struct __kfifo *fifo,
+                                      unsigned int *head, unsigned int n);
+
 extern unsigned int __kfifo_in_r(struct __kfifo *fifo,
                                  const void *buf, unsigned int len, size_t recsize);
 
+#ifdef KFIFO_OVERWRITE
+extern unsigned int __kfifo_in_overwrite_r(struct __kfifo *fifo,
+                                          const void *buf, unsigned int len, size_t recsize);
+#endif /* KFIFO_OVERWRITE */
+
 extern unsigned int __kfifo_out_r(struct __kfifo *fifo,
                                   void *buf, unsigned int len, size_t recsize);
 
+extern unsigned int __kfifo_out_records_r(struct __kfifo *fifo, void *buf, unsigned int buflen,
+                                          unsigned int *lens, unsigned int max, size_t recsize);
+
 extern unsigned int __kfifo_len_r(struct __kfifo *fifo, size_t recsize);
 
 extern void __kfifo_skip_r(struct __kfifo *fifo, size_t recsize);
@@ -651,6 +1696,97 @@ extern unsigned int __kfifo_out_peek_r(struct __kfifo *fifo,
 extern unsigned int __kfifo_out_linear_r(struct __kfifo *fifo,
                                          unsigned int *tail, unsigned int n, size_t recsize);
 
+extern unsigned int __kfifo_dma_in_prepare(struct __kfifo *fifo,
+                                           struct kfifo_dma_seg *seg, int nents, unsigned int len);
+
+extern unsigned int __kfifo_dma_out_prepare(struct __kfifo *fifo,
+                                            struct kfifo_dma_seg *seg, int nents, unsigned int len);
+
+extern unsigned int __kfifo_dma_in_prepare_r(struct __kfifo *fifo,
+                                             struct kfifo_dma_seg *seg, int nents, unsigned int len, size_t recsize);
+
+extern void __kfifo_dma_in_finish_r(struct __kfifo *fifo,
+                                    unsigned int len, size_t recsize);
+
+extern unsigned int __kfifo_dma_out_prepare_r(struct __kfifo *fifo,
+                                              struct kfifo_dma_seg *seg, int nents, unsigned int len, size_t recsize);
+
 extern unsigned int __kfifo_max_r(unsigned int len, size_t recsize);
 
+extern void __kfifo_copy_in(struct __kfifo *fifo, const void *src,
+                            unsigned int len, unsigned int off);
+
+extern void __kfifo_copy_out(struct __kfifo *fifo, void *dst,
+                             unsigned int len, unsigned int off);
+
+/*
+ * Element size specialized copy paths used by kfifo_in() and kfifo_out().
+ *
+ * The typed macros know sizeof(*fifo->type) at compile time, so these
+ * helpers are always inlined with a constant @esize: offsets become shifts
+ * and each element is moved by a fixed size load/store instead of a
+ * generic memcpy(). Transfers which wrap at the buffer end or which are
+ * longer than KFIFO_INLINE_COPY_MAX bytes are copied by the out of line
+ * __kfifo_copy_in()/__kfifo_copy_out() with the already clamped length,
+ * where the call is negligible against the copy.
+ */
+#ifndef KFIFO_INLINE_COPY_MAX
+#define KFIFO_INLINE_COPY_MAX 32 // 小于等于该字节数且不回绕时内联拷贝
+#endif /* KFIFO_INLINE_COPY_MAX */
+
+static inline __attribute__((always_inline)) unsigned int
+__kfifo_in_esize(struct __kfifo *fifo, const void *buf, unsigned int len, const size_t esize)
+{
+    unsigned char *data = (unsigned char *)fifo->data;
+    const unsigned char *s = (const unsigned char *)buf;
+    unsigned int l = __kfifo_unused(fifo, len);
+    unsigned int off, i;
+
+    if (len > l)
+    {
+        __kfifo_stats_short(fifo, len - l);
+        len = l;
+    }
+
+    off = __kfifo_off(fifo, __kfifo_load(&fifo->in));
+    if (len * esize > KFIFO_INLINE_COPY_MAX || off + len > fifo->mask + 1)
+        __kfifo_copy_in(fifo, buf, len, off);
+    else
+        for (i = 0; i < len; i++)
+            memcpy(data + (off + i) * esize, s + i * esize, esize);
+
+    __kfifo_add_in(fifo, len);
+    return len;
+}
+
+static inline __attribute__((always_inline)) unsigned int
+__kfifo_out_esize(struct __kfifo *fifo, void *buf, unsigned int len, const size_t esize)
+{
+    const unsigned char *data = (const unsigned char *)fifo->data;
+    unsigned char *d = (unsigned char *)buf;
+    unsigned int l = __kfifo_used(fifo, len);
+    unsigned int off, i;
+
+    if (len > l)
+    {
+        if (!l)
+            __kfifo_stats_empty(fifo);
+        len = l;
+    }
+
+    off = __kfifo_off(fifo, __kfifo_load(&fifo->out));
+    if (len * esize > KFIFO_INLINE_COPY_MAX || off + len > fifo->mask + 1)
+        __kfifo_copy_out(fifo, buf, len, off);
+    else
+        for (i = 0; i < len; i++)
+            memcpy(d + i * esize, data + (off + i) * esize, esize);
+
+    __kfifo_add_out(fifo, len);
+    return len;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
 #endif /* __KFIFO_H__ */
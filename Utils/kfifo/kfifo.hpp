@@ -0,0 +1,309 @@
+/**
+ * @file kfifo.hpp
+ * @brief KFIFO 的 C++17 模板封装，仅头文件
+ *
+ * `kfifo.h` 的类型化宏依赖 GCC 的 `typeof` 和语句表达式，在 C++ 中无法做类型检查，
+ * `__is_kfifo_ptr` 的 sizeof 技巧对部分元素类型也不成立。本文件在 `struct __kfifo` 之上提供：
+ * - `mcu::kfifo<T, N>`：内嵌缓冲区的 FIFO，容量和掩码是编译期常量，`static_assert` 检查 N 为 2 的幂。
+ * - `mcu::kfifo_ref<T>`：引用 C 代码中已有的 FIFO（`DECLARE_KFIFO`、`kfifo_alloc` 等），容量在运行时读取。
+ * - `push` / `pop` / `push_bulk` / `pop_bulk`：单个/批量写入和读取。
+ * - `write_view` / `commit` 和 `read_view` / `consume`：返回连续空闲/已用区域的 span，零拷贝读写。
+ *
+ * 与 C 代码共用：
+ * - 索引仍然通过 `kfifo.h` 的内联函数更新，`KFIFO_SMP`、`KFIFO_WATERMARK`、`KFIFO_STATS` 的行为与 C 宏一致。
+ * - `c_fifo()` 返回 `struct __kfifo *`，C 代码可以转换为 `STRUCT_KFIFO_PTR(T) *` 后使用所有宏，
+ *   例如中断里用 C 宏写入、C++ 任务里用 `pop_bulk` 读取。
+ *
+ * 注意事项：
+ * - 元素类型必须可以按字节拷贝（trivially copyable）。
+ * - 一读一写无需加锁，与 C 宏相同。
+ * - `span` 在 C++20 中为 `std::span`，C++17 中为本文件提供的简化版本（data/size/begin/end/operator[]）。
+ * - `kfifo<T, N>` 的缓冲区地址保存在 FIFO 中，对象不能拷贝或移动。
+ *
+ * @version 1.0.0
+ * @date 2026-10-16
+ * @author Jia Zhenyu
+ */
+
+#ifndef __KFIFO_HPP__
+#define __KFIFO_HPP__
+
+#include <cstddef>
+#include <type_traits>
+#include "kfifo.h"
+
+#if __cplusplus > 201703L && __has_include(<span>)
+#include <span>
+#endif
+
+namespace mcu
+{
+
+#if __cplusplus > 201703L && __has_include(<span>)
+    template <typename T>
+    using span = std::span<T>;
+#else
+    /* C++17 下的简化 span：一段连续元素 */
+    template <typename T>
+    class span
+    {
+    public:
+        constexpr span() noexcept : data_(nullptr), size_(0) {}
+        constexpr span(T *data, std::size_t size) noexcept : data_(data), size_(size) {}
+
+        constexpr T *data() const noexcept { return data_; }
+        constexpr std::size_t size() const noexcept { return size_; }
+        constexpr bool empty() const noexcept { return size_ == 0; }
+        constexpr T *begin() const noexcept { return data_; }
+        constexpr T *end() const noexcept { return data_ + size_; }
+        constexpr T &operator[](std::size_t i) const noexcept { return data_[i]; }
+
+    private:
+        T *data_;
+        std::size_t size_;
+    };
+#endif
+
+    namespace detail
+    {
+        /*
+         * 所有操作的实现，Derived 提供 raw()（struct __kfifo *）、buf()（元素数组）、
+         * capacity() 和 offset()（索引转换为数组下标）。kfifo<T, N> 中后两者是常量，
+         * 内联后与手写的 & mask 相同
+         */
+        template <typename T, typename Derived>
+        class kfifo_ops
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "kfifo elements are copied bytewise");
+
+        public:
+            using value_type = T;
+
+            /** Returns the number of used elements. */
+            unsigned int len() const noexcept
+            {
+                const struct __kfifo *f = self().raw();
+                return __kfifo_dist(f, __kfifo_load_acquire(&f->in), __kfifo_load_acquire(&f->out));
+            }
+
+            /** Returns the number of unused elements. */
+            unsigned int avail() const noexcept { return self().capacity() - len(); }
+
+            bool empty() const noexcept { return len() == 0; }
+
+            bool full() const noexcept { return len() == self().capacity(); }
+
+            /**
+             * Puts one element into the fifo (writer side).
+             * Returns false if the fifo is full.
+             */
+            bool push(const T &val) noexcept
+            {
+                struct __kfifo *f = self().raw();
+
+                if (!__kfifo_unused(f, 1))
+                {
+                    __kfifo_stats_short(f, 1);
+                    return false;
+                }
+                self().buf()[self().offset(__kfifo_load(&f->in))] = val;
+                __kfifo_add_in(f, 1);
+                return true;
+            }
+
+            /**
+             * Gets one element from the fifo (reader side).
+             * Returns false if the fifo is empty.
+             */
+            bool pop(T &val) noexcept
+            {
+                struct __kfifo *f = self().raw();
+
+                if (!__kfifo_used(f, 1))
+                {
+                    __kfifo_stats_empty(f);
+                    return false;
+                }
+                val = self().buf()[self().offset(__kfifo_load(&f->out))];
+                __kfifo_add_out(f, 1);
+                return true;
+            }
+
+            /**
+             * Puts up to @n elements into the fifo (writer side).
+             * Returns the number of elements copied.
+             */
+            unsigned int push_bulk(const T *src, unsigned int n) noexcept
+            {
+                struct __kfifo *f = self().raw();
+                unsigned int l = __kfifo_unused(f, n);
+                unsigned int off;
+
+                if (n > l)
+                {
+                    __kfifo_stats_short(f, n - l);
+                    n = l;
+                }
+                off = self().offset(__kfifo_load(&f->in));
+                if (!inline_copy(off, n))
+                    return __kfifo_in(f, src, n);
+
+                T *dst = self().buf() + off;
+                for (unsigned int i = 0; i < n; i++)
+                    dst[i] = src[i];
+                __kfifo_add_in(f, n);
+                return n;
+            }
+
+            /**
+             * Gets up to @n elements from the fifo (reader side).
+             * Returns the number of elements copied.
+             */
+            unsigned int pop_bulk(T *dst, unsigned int n) noexcept
+            {
+                struct __kfifo *f = self().raw();
+                unsigned int l = __kfifo_used(f, n);
+                unsigned int off;
+
+                if (n > l)
+                {
+                    if (!l)
+                        __kfifo_stats_empty(f);
+                    n = l;
+                }
+                off = self().offset(__kfifo_load(&f->out));
+                if (!inline_copy(off, n))
+                    return __kfifo_out(f, dst, n);
+
+                const T *src = self().buf() + off;
+                for (unsigned int i = 0; i < n; i++)
+                    dst[i] = src[i];
+                __kfifo_add_out(f, n);
+                return n;
+            }
+
+            /**
+             * Returns the contiguous free space at the write position (writer
+             * side), up to the end of the buffer. Fill it and call commit().
+             */
+            span<T> write_view() noexcept
+            {
+                struct __kfifo *f = self().raw();
+                unsigned int off = self().offset(__kfifo_load(&f->in));
+                unsigned int l = __kfifo_unused(f, self().capacity() - off);
+
+                return span<T>(self().buf() + off, l < self().capacity() - off ? l : self().capacity() - off);
+            }
+
+            /** Publishes @n elements written through write_view(). */
+            void commit(unsigned int n) noexcept { __kfifo_add_in(self().raw(), n); }
+
+            /**
+             * Returns the contiguous used data at the read position (reader
+             * side), up to the end of the buffer. Release it with consume().
+             */
+            span<const T> read_view() noexcept
+            {
+                struct __kfifo *f = self().raw();
+                unsigned int off = self().offset(__kfifo_load(&f->out));
+                unsigned int l = __kfifo_used(f, self().capacity() - off);
+
+                return span<const T>(self().buf() + off, l < self().capacity() - off ? l : self().capacity() - off);
+            }
+
+            /** Releases @n elements read through read_view(). */
+            void consume(unsigned int n) noexcept { __kfifo_add_out(self().raw(), n); }
+
+            /** Returns the underlying C fifo, see kfifo.h. */
+            struct __kfifo *c_fifo() noexcept { return self().raw(); }
+
+        private:
+            /*
+             * 与 __kfifo_in_esize 相同：不回绕且不超过 KFIFO_INLINE_COPY_MAX 字节时逐个元素内联拷贝，
+             * 否则调用 __kfifo_in/__kfifo_out（拷贝本身远大于一次函数调用）
+             */
+            bool inline_copy(unsigned int off, unsigned int n) const noexcept
+            {
+                return n * sizeof(T) <= KFIFO_INLINE_COPY_MAX && off + n <= self().capacity();
+            }
+
+            Derived &self() noexcept { return *static_cast<Derived *>(this); }
+            const Derived &self() const noexcept { return *static_cast<const Derived *>(this); }
+        };
+    } // namespace detail
+
+    /**
+     * kfifo - fifo with an embedded buffer of @N elements of @T
+     *
+     * N must be a power of 2, size and mask are compile time constants.
+     */
+    template <typename T, unsigned int N>
+    class kfifo : public detail::kfifo_ops<T, kfifo<T, N>>
+    {
+        static_assert(N >= 2 && (N & (N - 1)) == 0, "kfifo size must be a power of 2");
+
+        friend class detail::kfifo_ops<T, kfifo<T, N>>;
+
+    public:
+        static constexpr unsigned int size = N;
+        static constexpr unsigned int mask = N - 1;
+
+        kfifo() noexcept : fifo_()
+        {
+            fifo_.mask = mask;
+            fifo_.esize = sizeof(T);
+            fifo_.data = buf_;
+        }
+
+        kfifo(const kfifo &) = delete;
+        kfifo &operator=(const kfifo &) = delete;
+
+        static constexpr unsigned int capacity() noexcept { return N; }
+
+        /** Removes the entire content, only without concurrent access. */
+        void reset() noexcept
+        {
+            fifo_.in = 0;
+            fifo_.out = 0;
+            __kfifo_reset_cache(&fifo_);
+        }
+
+    private:
+        struct __kfifo *raw() noexcept { return &fifo_; }
+        const struct __kfifo *raw() const noexcept { return &fifo_; }
+        T *buf() noexcept { return buf_; }
+        static constexpr unsigned int offset(unsigned int idx) noexcept { return idx & mask; }
+
+        struct __kfifo fifo_;
+        T buf_[N];
+    };
+
+    /**
+     * kfifo_ref - typed access to a fifo owned by C code
+     *
+     * The element size of the C fifo must be sizeof(T), e.g. a fifo from
+     * DECLARE_KFIFO(fifo, T, size) or kfifo_alloc(). Record fifos are not
+     * supported.
+     */
+    template <typename T>
+    class kfifo_ref : public detail::kfifo_ops<T, kfifo_ref<T>>
+    {
+        friend class detail::kfifo_ops<T, kfifo_ref<T>>;
+
+    public:
+        explicit kfifo_ref(struct __kfifo *fifo) noexcept : fifo_(fifo) {}
+
+        unsigned int capacity() const noexcept { return fifo_->mask + 1; }
+
+    private:
+        struct __kfifo *raw() noexcept { return fifo_; }
+        const struct __kfifo *raw() const noexcept { return fifo_; }
+        T *buf() noexcept { return static_cast<T *>(fifo_->data); }
+        unsigned int offset(unsigned int idx) const noexcept { return __kfifo_off(fifo_, idx); }
+
+        struct __kfifo *fifo_;
+    };
+
+} // namespace mcu
+
+#endif /* __KFIFO_HPP__ */
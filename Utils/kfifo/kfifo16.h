@@ -0,0 +1,433 @@
+/**
+ * @file kfifo16.h
+ * @brief 紧凑型（16 位索引）环形 FIFO，仅头文件
+ *
+ * 面向大量小 FIFO（每个外设一个收发 FIFO）的单片机场景。`struct __kfifo` 需要 4 个
+ * `unsigned int` 加一个指针（Cortex-M 上 20 字节），而带类型的静态 FIFO 在编译期
+ * 已经知道元素大小、容量和缓冲区地址，本文件利用这一点：
+ * - FIFO 头只有 `uint16_t` 的 `in`/`out`，共 4 字节。
+ * - 元素大小、容量（掩码）由 `data[]` 的类型和长度在编译期得到，不占 RAM。
+ * - 数据指针就是结构体内嵌的 `data[]`。
+ * - 所有操作都是内联的，拷贝长度、掩码都是常量，代码量和速度都优于通用实现。
+ *
+ * 接口与 `kfifo.h` 一致，只是名称带 `16` 后缀，例如 `kfifo16_put` / `kfifo16_get`。
+ *
+ * 注意事项：
+ * - 只支持静态定义的 FIFO，不支持动态分配和记录（record）模式。
+ * - FIFO 的大小必须为 2 的幂，且不超过 32768 个元素。
+ * - 一读一写无需加锁，面向单核 MCU（中断与主循环之间），多核请使用 `kfifo.h` 的 `KFIFO_SMP`。
+ *
+ * @version 1.0.0
+ * @date 2026-10-16
+ * @author Jia Zhenyu
+ */
+
+#ifndef __KFIFO16_H__
+#define __KFIFO16_H__
+
+#include "kfifo.h"
+
+struct __kfifo16
+{
+    uint16_t in;
+    uint16_t out;
+};
+
+/* 读取对端修改的索引，保证每次都从内存读取 */
+#define __kfifo16_load(p) (*(volatile uint16_t *)(p))
+
+/* 编译器屏障：数据读写完成后才能发布索引 */
+#define __kfifo16_barrier() __asm__ __volatile__("" ::: "memory")
+
+#define STRUCT_KFIFO16(type, size)                                                          \
+    struct                                                                                  \
+    {                                                                                       \
+        struct __kfifo16 kfifo;                                                             \
+        type data[((size) < 2 || ((size) & ((size) - 1)) || (size) > 32768) ? -1 : (size)]; \
+    }
+
+/**
+ * DECLARE_KFIFO16 - macro to declare a compact fifo object
+ * @fifo: name of the declared fifo
+ * @type: type of the fifo elements
+ * @size: the number of elements in the fifo, this must be a power of 2
+ *        and not greater than 32768
+ */
+#define DECLARE_KFIFO16(fifo, type, size) STRUCT_KFIFO16(type, size) fifo
+
+/**
+ * INIT_KFIFO16 - Initialize a fifo declared by DECLARE_KFIFO16
+ * @fifo: name of the declared fifo datatype
+ */
+#define INIT_KFIFO16(fifo)               \
+    (void)({                             \
+        typeof(&(fifo)) __tmp = &(fifo); \
+        __tmp->kfifo.in = 0;             \
+        __tmp->kfifo.out = 0;            \
+    })
+
+/**
+ * DEFINE_KFIFO16 - macro to define and initialize a compact fifo
+ * @fifo: name of the declared fifo datatype
+ * @type: type of the fifo elements
+ * @size: the number of elements in the fifo, this must be a power of 2
+ *
+ * Note: the macro can be used for global and local fifo data type variables.
+ */
+#define DEFINE_KFIFO16(fifo, type, size) \
+    DECLARE_KFIFO16(fifo, type, size) = {.kfifo = {.in = 0, .out = 0}}
+
+/*
+ * internal helpers, @size and @esize are compile time constants at every
+ * call site, so the mask and the copy lengths are constants as well.
+ */
+static inline __attribute__((always_inline)) unsigned int
+__kfifo16_len(struct __kfifo16 *fifo)
+{
+    return (uint16_t)(__kfifo16_load(&fifo->in) - __kfifo16_load(&fifo->out));
+}
+
+static inline __attribute__((always_inline)) unsigned int
+__kfifo16_in(struct __kfifo16 *fifo, void *data, const unsigned int size, const size_t esize,
+             const void *buf, unsigned int len)
+{
+    unsigned char *d = (unsigned char *)data;
+    const unsigned char *s = (const unsigned char *)buf;
+    uint16_t in = fifo->in;
+    unsigned int off = in & (size - 1);
+    unsigned int l = size - (uint16_t)(in - __kfifo16_load(&fifo->out));
+
+    if (len > l)
+        len = l;
+
+    l = size - off;
+    if (l > len)
+        l = len;
+
+    __kfifo16_barrier();
+    memcpy(d + off * esize, s, l * esize);
+    memcpy(d, s + l * esize, (len - l) * esize);
+    /*
+     * make sure that the data in the fifo is up to date before
+     * incrementing the fifo->in index counter
+     */
+    __kfifo16_barrier();
+    __kfifo16_load(&fifo->in) = (uint16_t)(in + len);
+    return len;
+}
+
+static inline __attribute__((always_inline)) unsigned int
+__kfifo16_out_peek(struct __kfifo16 *fifo, const void *data, const unsigned int size, const size_t esize,
+                   void *buf, unsigned int len)
+{
+    const unsigned char *s = (const unsigned char *)data;
+    unsigned char *d = (unsigned char *)buf;
+    uint16_t out = fifo->out;
+    unsigned int off = out & (size - 1);
+    unsigned int l = (uint16_t)(__kfifo16_load(&fifo->in) - out);
+
+    if (len > l)
+        len = l;
+
+    l = size - off;
+    if (l > len)
+        l = len;
+
+    __kfifo16_barrier();
+    memcpy(d, s + off * esize, l * esize);
+    memcpy(d + l * esize, s, (len - l) * esize);
+    return len;
+}
+
+static inline __attribute__((always_inline)) unsigned int
+__kfifo16_out(struct __kfifo16 *fifo, const void *data, const unsigned int size, const size_t esize,
+              void *buf, unsigned int len)
+{
+    len = __kfifo16_out_peek(fifo, data, size, esize, buf, len);
+    /*
+     * make sure that the data is copied before
+     * incrementing the fifo->out index counter
+     */
+    __kfifo16_barrier();
+    __kfifo16_load(&fifo->out) = (uint16_t)(fifo->out + len);
+    return len;
+}
+
+/**
+ * kfifo16_size - returns the size of the fifo in elements
+ * @fifo: address of the fifo to be used
+ */
+#define kfifo16_size(fifo) ARRAY_SIZE((fifo)->data)
+
+/**
+ * kfifo16_esize - returns the size of the element managed by the fifo
+ * @fifo: address of the fifo to be used
+ */
+#define kfifo16_esize(fifo) sizeof(*(fifo)->data)
+
+/**
+ * kfifo16_reset - removes the entire fifo content
+ * @fifo: address of the fifo to be used
+ *
+ * Note: usage of kfifo16_reset() is dangerous. It should be only called when
+ * the fifo is exclusived locked or when it is secured that no other thread
+ * is accessing the fifo.
+ */
+#define kfifo16_reset(fifo) INIT_KFIFO16(*(fifo))
+
+/**
+ * kfifo16_reset_out - skip fifo content
+ * @fifo: address of the fifo to be used
+ *
+ * Note: The usage of kfifo16_reset_out() is safe until it will be only called
+ * from the reader thread and there is only one concurrent reader.
+ */
+#define kfifo16_reset_out(fifo)                                               \
+    (void)({                                                                  \
+        typeof((fifo) + 1) __tmp = (fifo);                                    \
+        __kfifo16_load(&__tmp->kfifo.out) = __kfifo16_load(&__tmp->kfifo.in); \
+    })
+
+/**
+ * kfifo16_len - returns the number of used elements in the fifo
+ * @fifo: address of the fifo to be used
+ */
+#define kfifo16_len(fifo) __kfifo16_len(&(fifo)->kfifo)
+
+/**
+ * kfifo16_is_empty - returns true if the fifo is empty
+ * @fifo: address of the fifo to be used
+ */
+#define kfifo16_is_empty(fifo) (kfifo16_len(fifo) == 0)
+
+/**
+ * kfifo16_is_full - returns true if the fifo is full
+ * @fifo: address of the fifo to be used
+ */
+#define kfifo16_is_full(fifo)                        \
+    ({                                               \
+        typeof((fifo) + 1) __tmpq = (fifo);          \
+        kfifo16_len(__tmpq) >= kfifo16_size(__tmpq); \
+    })
+
+/**
+ * kfifo16_avail - returns the number of unused elements in the fifo
+ * @fifo: address of the fifo to be used
+ */
+#define kfifo16_avail(fifo)                                             \
+    __kfifo_uint_must_check_helper(                                     \
+        ({                                                              \
+            typeof((fifo) + 1) __tmpq = (fifo);                         \
+            (unsigned int)(kfifo16_size(__tmpq) - kfifo16_len(__tmpq)); \
+        }))
+
+/**
+ * kfifo16_skip_count - skip output data
+ * @fifo: address of the fifo to be used
+ * @count: count of data to skip
+ */
+#define kfifo16_skip_count(fifo, count)                                             \
+    do                                                                              \
+    {                                                                               \
+        typeof((fifo) + 1) __tmp = (fifo);                                          \
+        __kfifo16_barrier();                                                        \
+        __kfifo16_load(&__tmp->kfifo.out) = (uint16_t)(__tmp->kfifo.out + (count)); \
+    } while (0)
+
+/**
+ * kfifo16_skip - skip output data
+ * @fifo: address of the fifo to be used
+ */
+#define kfifo16_skip(fifo) kfifo16_skip_count(fifo, 1)
+
+/**
+ * kfifo16_put - put data into the fifo
+ * @fifo: address of the fifo to be used
+ * @val: the data to be added
+ *
+ * This macro copies the given value into the fifo.
+ * It returns 0 if the fifo was full. Otherwise it returns the number
+ * processed elements.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo16_put(fifo, val)                                                                              \
+    ({                                                                                                      \
+        typeof((fifo) + 1) __tmp = (fifo);                                                                  \
+        typeof(*__tmp->data) __val = (val);                                                                 \
+        __kfifo16_in(&__tmp->kfifo, __tmp->data, ARRAY_SIZE(__tmp->data), sizeof(*__tmp->data), &__val, 1); \
+    })
+
+/**
+ * kfifo16_get - get data from the fifo
+ * @fifo: address of the fifo to be used
+ * @val: address where to store the data
+ *
+ * This macro reads the data from the fifo.
+ * It returns 0 if the fifo was empty. Otherwise it returns the number
+ * processed elements.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo16_get(fifo, val)                                                                                  \
+    __kfifo_uint_must_check_helper(                                                                             \
+        ({                                                                                                      \
+            typeof((fifo) + 1) __tmp = (fifo);                                                                  \
+            typeof(&*__tmp->data) __val = (val);                                                                \
+            __kfifo16_out(&__tmp->kfifo, __tmp->data, ARRAY_SIZE(__tmp->data), sizeof(*__tmp->data), __val, 1); \
+        }))
+
+/**
+ * kfifo16_peek - get data from the fifo without removing
+ * @fifo: address of the fifo to be used
+ * @val: address where to store the data
+ *
+ * This reads the data from the fifo without removing it from the fifo.
+ * It returns 0 if the fifo was empty. Otherwise it returns the number
+ * processed elements.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo16_peek(fifo, val)                                                                                      \
+    __kfifo_uint_must_check_helper(                                                                                  \
+        ({                                                                                                           \
+            typeof((fifo) + 1) __tmp = (fifo);                                                                       \
+            typeof(&*__tmp->data) __val = (val);                                                                     \
+            __kfifo16_out_peek(&__tmp->kfifo, __tmp->data, ARRAY_SIZE(__tmp->data), sizeof(*__tmp->data), __val, 1); \
+        }))
+
+/**
+ * kfifo16_in - put data into the fifo
+ * @fifo: address of the fifo to be used
+ * @buf: the data to be added
+ * @n: number of elements to be added
+ *
+ * This macro copies the given buffer into the fifo and returns the
+ * number of copied elements.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo16_in(fifo, buf, n)                                                                             \
+    ({                                                                                                       \
+        typeof((fifo) + 1) __tmp = (fifo);                                                                   \
+        const typeof(*__tmp->data) *__buf = (buf);                                                           \
+        __kfifo16_in(&__tmp->kfifo, __tmp->data, ARRAY_SIZE(__tmp->data), sizeof(*__tmp->data), __buf, (n)); \
+    })
+
+/**
+ * kfifo16_out - get data from the fifo
+ * @fifo: address of the fifo to be used
+ * @buf: pointer to the storage buffer
+ * @n: max. number of elements to get
+ *
+ * This macro gets some data from the fifo and returns the numbers of elements
+ * copied.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo16_out(fifo, buf, n)                                                                                 \
+    __kfifo_uint_must_check_helper(                                                                               \
+        ({                                                                                                        \
+            typeof((fifo) + 1) __tmp = (fifo);                                                                    \
+            typeof(&*__tmp->data) __buf = (buf);                                                                  \
+            __kfifo16_out(&__tmp->kfifo, __tmp->data, ARRAY_SIZE(__tmp->data), sizeof(*__tmp->data), __buf, (n)); \
+        }))
+
+/**
+ * kfifo16_out_peek - gets some data from the fifo
+ * @fifo: address of the fifo to be used
+ * @buf: pointer to the storage buffer
+ * @n: max. number of elements to get
+ *
+ * This macro gets the data from the fifo and returns the numbers of elements
+ * copied. The data is not removed from the fifo.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo16_out_peek(fifo, buf, n)                                                                                 \
+    __kfifo_uint_must_check_helper(                                                                                    \
+        ({                                                                                                             \
+            typeof((fifo) + 1) __tmp = (fifo);                                                                         \
+            typeof(&*__tmp->data) __buf = (buf);                                                                       \
+            __kfifo16_out_peek(&__tmp->kfifo, __tmp->data, ARRAY_SIZE(__tmp->data), sizeof(*__tmp->data), __buf, (n)); \
+        }))
+
+/**
+ * kfifo16_out_linear_ptr - gets a pointer to the available data
+ * @fifo: address of the fifo to be used
+ * @ptr: pointer to data to store the pointer to tail
+ * @n: max. number of elements to point at
+ *
+ * This macro obtains the pointer to the available data in the fifo buffer
+ * and returns the numbers of elements available till the end of available
+ * data or till the end of the buffer. Release the data with
+ * kfifo16_skip_count().
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo16_out_linear_ptr(fifo, ptr, n)                                   \
+    __kfifo_uint_must_check_helper(                                            \
+        ({                                                                     \
+            typeof((fifo) + 1) __tmp = (fifo);                                 \
+            unsigned int __off = __tmp->kfifo.out & (kfifo16_size(__tmp) - 1); \
+            unsigned int __l = kfifo16_len(__tmp);                             \
+            unsigned long __n = (n);                                           \
+            if (__l > kfifo16_size(__tmp) - __off)                             \
+                __l = kfifo16_size(__tmp) - __off;                             \
+            *(ptr) = &__tmp->data[__off];                                      \
+            __kfifo16_barrier();                                               \
+            __n < __l ? (unsigned int)__n : __l;                               \
+        }))
+
+/**
+ * kfifo16_in_linear_ptr - gets a pointer to the free space
+ * @fifo: address of the fifo to be used
+ * @ptr: pointer to data to store the pointer to head
+ * @n: max. number of elements to reserve
+ *
+ * This macro obtains the pointer to the free space in the fifo buffer and
+ * returns the numbers of elements which can be written there without
+ * wrapping. The written elements are not visible to the reader until
+ * kfifo16_in_commit() is called.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo16_in_linear_ptr(fifo, ptr, n)                                   \
+    __kfifo_uint_must_check_helper(                                           \
+        ({                                                                    \
+            typeof((fifo) + 1) __tmp = (fifo);                                \
+            unsigned int __off = __tmp->kfifo.in & (kfifo16_size(__tmp) - 1); \
+            unsigned int __l = kfifo16_size(__tmp) - kfifo16_len(__tmp);      \
+            unsigned long __n = (n);                                          \
+            if (__l > kfifo16_size(__tmp) - __off)                            \
+                __l = kfifo16_size(__tmp) - __off;                            \
+            *(ptr) = &__tmp->data[__off];                                     \
+            __n < __l ? (unsigned int)__n : __l;                              \
+        }))
+
+/**
+ * kfifo16_in_commit - publish data written into the reserved free space
+ * @fifo: address of the fifo to be used
+ * @n: number of elements to publish
+ *
+ * This macro makes @n elements written through kfifo16_in_linear_ptr()
+ * visible to the reader. @n must not be greater than the count returned by
+ * the reservation.
+ */
+#define kfifo16_in_commit(fifo, n)                                            \
+    do                                                                        \
+    {                                                                         \
+        typeof((fifo) + 1) __tmp = (fifo);                                    \
+        __kfifo16_barrier();                                                  \
+        __kfifo16_load(&__tmp->kfifo.in) = (uint16_t)(__tmp->kfifo.in + (n)); \
+    } while (0)
+
+#endif /* __KFIFO16_H__ */
@@ -0,0 +1,345 @@
+/**
+ * @file kfifo_bcast.c
+ * @brief 单写者/多读者广播环形 FIFO 的实现文件
+ *
+ * 写端只有一个 `in`，每个读者有自己的 `out`：
+ * - BLOCK 策略：写端的空闲空间 = size - 最慢读者的已用数，读者不会丢数据。
+ * - DROP 策略：写端不看读者，写入前先发布 `head = in + len`，再写数据，最后发布 `in`。
+ *   [head - size, in) 之外的数据可能已被覆盖，读者落后时跳到 head - size 并累计 overrun；
+ *   读者拷贝完成后重新读取 `head` 校验数据在拷贝期间没有被覆盖（与 seqlock 类似）。
+ *
+ * @version 1.0.0
+ * @date 2026-10-16
+ * @author Jia Zhenyu
+ */
+
+#include "kfifo_bcast.h"
+
+#define min(x, y) ((x) < (y) ? (x) : (y))
+#define is_power_of_2(x) ((x) != 0 && (((x) & ((x) - 1)) == 0))
+
+static void kfifo_bcast_reset(struct __kfifo_bcast *fifo)
+{
+    unsigned int i;
+
+    for (i = 0; i < fifo->nreaders; i++)
+    {
+        atomic_init(&fifo->readers[i].out, 0);
+        fifo->readers[i].overrun = 0;
+    }
+
+    atomic_init(&fifo->in, 0);
+    atomic_init(&fifo->head, 0);
+}
+
+int __kfifo_bcast_init(struct __kfifo_bcast *fifo, void *buffer,
+                       unsigned int size, size_t esize,
+                       struct __kfifo_bcast_reader *readers,
+                       unsigned int nreaders, KFIFO_BCAST_POLICY policy)
+{
+    fifo->esize = esize;
+    fifo->data = buffer;
+    fifo->readers = readers;
+    fifo->nreaders = nreaders;
+    fifo->policy = policy;
+
+    if (size < 2 || !is_power_of_2(size) || nreaders == 0)
+    {
+        fifo->mask = 0;
+        fifo->nreaders = 0;
+        return -EINVAL;
+    }
+    fifo->mask = size - 1;
+
+    kfifo_bcast_reset(fifo);
+    return 0;
+}
+
+int __kfifo_bcast_alloc(struct __kfifo_bcast *fifo, unsigned int size,
+                        size_t esize, unsigned int nreaders,
+                        KFIFO_BCAST_POLICY policy)
+{
+    size = __kfifo_roundup_pow_of_two(size);
+
+    fifo->esize = esize;
+    fifo->data = NULL;
+    fifo->readers = NULL;
+    fifo->nreaders = 0;
+    fifo->policy = policy;
+    fifo->mask = 0;
+
+    if (size < 2 || nreaders == 0)
+        return -EINVAL;
+
+    fifo->data = malloc(esize * size);
+    fifo->readers = malloc(sizeof(*fifo->readers) * nreaders);
+
+    if (!fifo->data || !fifo->readers)
+    {
+        free(fifo->data);
+        free(fifo->readers);
+        fifo->data = NULL;
+        fifo->readers = NULL;
+        return -ENOMEM;
+    }
+    fifo->mask = size - 1;
+    fifo->nreaders = nreaders;
+
+    kfifo_bcast_reset(fifo);
+    return 0;
+}
+
+void __kfifo_bcast_free(struct __kfifo_bcast *fifo)
+{
+    free(fifo->data);
+    free(fifo->readers);
+    fifo->data = NULL;
+    fifo->readers = NULL;
+    fifo->nreaders = 0;
+    fifo->esize = 0;
+    fifo->mask = 0;
+    atomic_init(&fifo->in, 0);
+    atomic_init(&fifo->head, 0);
+}
+
+static void kfifo_bcast_copy_in(struct __kfifo_bcast *fifo, const void *src,
+                                unsigned int len, unsigned int off)
+{
+    unsigned int size = fifo->mask + 1;
+    unsigned int esize = fifo->esize;
+    unsigned int l;
+    unsigned char *data = (unsigned char *)fifo->data;
+    const unsigned char *s = (const unsigned char *)src;
+
+    off &= fifo->mask;
+    if (esize != 1)
+    {
+        off *= esize;
+        size *= esize;
+        len *= esize;
+    }
+    l = min(len, size - off);
+
+    memcpy(data + off, s, l);
+    memcpy(data, s + l, len - l);
+}
+
+static void kfifo_bcast_copy_out(struct __kfifo_bcast *fifo, void *dst,
+                                 unsigned int len, unsigned int off)
+{
+    unsigned int size = fifo->mask + 1;
+    unsigned int esize = fifo->esize;
+    unsigned int l;
+    const unsigned char *data = (const unsigned char *)fifo->data;
+    unsigned char *d = (unsigned char *)dst;
+
+    off &= fifo->mask;
+    if (esize != 1)
+    {
+        off *= esize;
+        size *= esize;
+        len *= esize;
+    }
+    l = min(len, size - off);
+
+    memcpy(d, data + off, l);
+    memcpy(d + l, data, len - l);
+}
+
+/*
+ * DROP 策略：[head - size, ...) 之前的数据已经（或正在）被覆盖，
+ * 落后的读者跳到 head - size 并累计 overrun，返回新的 out。
+ * 调用者必须在此之后再读取 in：先读 in 时写端可能在两次读取之间超过读者一圈以上，
+ * 新的 out 会越过旧的 in
+ */
+static unsigned int kfifo_bcast_catch_up(struct __kfifo_bcast *fifo,
+                                         struct __kfifo_bcast_reader *rd, unsigned int out)
+{
+    unsigned int size = fifo->mask + 1;
+    /* acquire: the caller's later load of in must not move before this */
+    unsigned int head = atomic_load_explicit(&fifo->head, memory_order_acquire);
+
+    if (head - out > size)
+    {
+        rd->overrun += head - size - out;
+        out = head - size;
+        atomic_store_explicit(&rd->out, out, memory_order_relaxed);
+    }
+    return out;
+}
+
+/*
+ * DROP 策略：读完 [out, ...) 的数据后检查写端是否在此期间覆盖了这些数据
+ */
+static int kfifo_bcast_intact(struct __kfifo_bcast *fifo, unsigned int out)
+{
+    /* make sure that the data is read before head is checked */
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&fifo->head, memory_order_relaxed) - out <= fifo->mask + 1;
+}
+
+unsigned int __kfifo_bcast_avail(struct __kfifo_bcast *fifo)
+{
+    unsigned int size = fifo->mask + 1;
+    unsigned int in = atomic_load_explicit(&fifo->in, memory_order_relaxed);
+    unsigned int used = 0;
+    unsigned int i;
+
+    if (fifo->policy == KFIFO_BCAST_DROP)
+        return size;
+
+    /* the slowest reader bounds the free space */
+    for (i = 0; i < fifo->nreaders; i++)
+    {
+        unsigned int l = in - atomic_load_explicit(&fifo->readers[i].out, memory_order_acquire);
+
+        if (l > used)
+            used = l;
+    }
+    return size - used;
+}
+
+unsigned int __kfifo_bcast_in(struct __kfifo_bcast *fifo,
+                              const void *buf, unsigned int len)
+{
+    unsigned int size = fifo->mask + 1;
+    unsigned int in = atomic_load_explicit(&fifo->in, memory_order_relaxed);
+
+    if (fifo->policy == KFIFO_BCAST_DROP)
+    {
+        /*
+         * only the newest size elements of buf can be kept, the skipped
+         * ones still advance in so that every reader counts them as overrun
+         */
+        if (len > size)
+        {
+            buf = (const unsigned char *)buf + (len - size) * fifo->esize;
+            in += len - size;
+            len = size;
+        }
+
+        /*
+         * announce the overwritten area before the data is touched, so
+         * that readers can detect that their data was overwritten
+         */
+        atomic_store_explicit(&fifo->head, in + len, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+    }
+    else
+    {
+        unsigned int l = __kfifo_bcast_avail(fifo);
+
+        len = min(len, l);
+    }
+
+    kfifo_bcast_copy_in(fifo, buf, len, in);
+    /*
+     * make sure that the data in the fifo is up to date before
+     * incrementing the fifo->in index counter
+     */
+    atomic_store_explicit(&fifo->in, in + len, memory_order_release);
+    return len;
+}
+
+/*
+ * DROP 策略：写端一次写入超过 size 个元素时，head - size 会暂时越过还没有发布的 in，
+ * 此时 in - out 回绕，按没有数据处理
+ */
+static inline unsigned int kfifo_bcast_used(struct __kfifo_bcast *fifo, unsigned int in, unsigned int out)
+{
+    unsigned int l = in - out;
+
+    return l > fifo->mask + 1 ? 0 : l;
+}
+
+unsigned int __kfifo_bcast_len(struct __kfifo_bcast *fifo, unsigned int r)
+{
+    unsigned int size = fifo->mask + 1;
+    unsigned int out = atomic_load_explicit(&fifo->readers[r].out, memory_order_relaxed);
+    unsigned int in;
+
+    if (fifo->policy == KFIFO_BCAST_DROP)
+    {
+        unsigned int head = atomic_load_explicit(&fifo->head, memory_order_acquire);
+
+        if (head - out > size)
+            out = head - size;
+    }
+    in = atomic_load_explicit(&fifo->in, memory_order_acquire);
+    return kfifo_bcast_used(fifo, in, out);
+}
+
+unsigned int __kfifo_bcast_out(struct __kfifo_bcast *fifo, unsigned int r,
+                               void *buf, unsigned int len)
+{
+    struct __kfifo_bcast_reader *rd = &fifo->readers[r];
+    unsigned int in, out, l;
+
+    for (;;)
+    {
+        out = atomic_load_explicit(&rd->out, memory_order_relaxed);
+
+        if (fifo->policy == KFIFO_BCAST_DROP)
+            out = kfifo_bcast_catch_up(fifo, rd, out);
+
+        /* in is loaded after head, see kfifo_bcast_catch_up */
+        in = atomic_load_explicit(&fifo->in, memory_order_acquire);
+        l = min(len, kfifo_bcast_used(fifo, in, out));
+        kfifo_bcast_copy_out(fifo, buf, l, out);
+
+        /* overwritten while copying: drop it and read the newer data */
+        if (fifo->policy != KFIFO_BCAST_DROP || kfifo_bcast_intact(fifo, out))
+            break;
+    }
+
+    /*
+     * make sure that the data is copied before
+     * incrementing the reader's out index counter
+     */
+    atomic_store_explicit(&rd->out, out + l, memory_order_release);
+    return l;
+}
+
+unsigned int __kfifo_bcast_out_linear(struct __kfifo_bcast *fifo, unsigned int r,
+                                      unsigned int *tail, unsigned int n)
+{
+    struct __kfifo_bcast_reader *rd = &fifo->readers[r];
+    unsigned int size = fifo->mask + 1;
+    unsigned int out = atomic_load_explicit(&rd->out, memory_order_relaxed);
+    unsigned int in, off;
+
+    if (fifo->policy == KFIFO_BCAST_DROP)
+        out = kfifo_bcast_catch_up(fifo, rd, out);
+
+    /* in is loaded after head, see kfifo_bcast_catch_up */
+    in = atomic_load_explicit(&fifo->in, memory_order_acquire);
+    off = out & fifo->mask;
+    if (tail)
+        *tail = off;
+
+    n = min(n, kfifo_bcast_used(fifo, in, out));
+    return min(n, size - off);
+}
+
+unsigned int __kfifo_bcast_skip(struct __kfifo_bcast *fifo, unsigned int r,
+                                unsigned int count)
+{
+    struct __kfifo_bcast_reader *rd = &fifo->readers[r];
+    unsigned int out = atomic_load_explicit(&rd->out, memory_order_relaxed);
+
+    if (fifo->policy == KFIFO_BCAST_DROP && !kfifo_bcast_intact(fifo, out))
+    {
+        kfifo_bcast_catch_up(fifo, rd, out);
+        return 0;
+    }
+
+    atomic_store_explicit(&rd->out, out + count, memory_order_release);
+    return count;
+}
+
+void __kfifo_bcast_reader_reset(struct __kfifo_bcast *fifo, unsigned int r)
+{
+    atomic_store_explicit(&fifo->readers[r].out,
+                          atomic_load_explicit(&fifo->in, memory_order_acquire),
+                          memory_order_release);
+}
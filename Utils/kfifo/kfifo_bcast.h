@@ -0,0 +1,330 @@
+/**
+ * @file kfifo_bcast.h
+ * @brief 单写者/多读者广播环形 FIFO 的头文件
+ *
+ * 一路数据（例如传感器数据流）需要同时分发给多个消费者（日志、滤波任务、串口桥接）时，
+ * 不必再拷贝到多个 kfifo：广播 FIFO 只有一块共享缓冲区和一个 `in`，每个读者有独立的
+ * `out` 游标，读者之间互不影响。
+ *
+ * 写端策略（初始化时选择）：
+ * - `KFIFO_BCAST_BLOCK`：写端的空闲空间由最慢的读者决定，不丢数据。
+ * - `KFIFO_BCAST_DROP`：写端从不等待，落后超过缓冲区大小的读者跳到最旧的有效数据，
+ *   丢弃的元素数累计到该读者的 overrun 计数。
+ *
+ * 读端可以拷贝读取（`kfifo_bcast_out`），也可以按 `kfifo_out_linear_ptr` 的方式零拷贝读取
+ * （`kfifo_bcast_out_linear_ptr` + `kfifo_bcast_skip_count`）。
+ *
+ * 注意事项：
+ * - 一个写者，每个读者编号只能由一个线程/中断使用，此时无需加锁。
+ * - 依赖 C11 `stdatomic.h`，需要使用 `gnu11` 编译；只用到原子读写和内存屏障，
+ *   Cortex-M0/M0+ 同样适用。
+ * - `KFIFO_BCAST_DROP` 下零拷贝读取的数据可能在处理期间被写端覆盖，
+ *   需要检查 `kfifo_bcast_skip_count` 的返回值。
+ *
+ * @version 1.0.0
+ * @date 2026-10-16
+ * @author Jia Zhenyu
+ */
+
+#ifndef __KFIFO_BCAST_H__
+#define __KFIFO_BCAST_H__
+
+#include <stdatomic.h>
+#include "kfifo.h"
+
+/* 多核时每个读者的游标独占一个 cache line，单核 MCU 上不浪费内存 */
+#ifdef KFIFO_SMP
+#define __kfifo_bcast_aligned __kfifo_cacheline_aligned
+#else /* KFIFO_SMP */
+#define __kfifo_bcast_aligned
+#endif /* KFIFO_SMP */
+
+typedef enum
+{
+    KFIFO_BCAST_BLOCK = 0, // 默认：写端受最慢的读者限制
+    KFIFO_BCAST_DROP       // 写端不等待，落后的读者丢弃最旧的数据
+} KFIFO_BCAST_POLICY;
+
+struct __kfifo_bcast_reader
+{
+    _Atomic unsigned int out __kfifo_bcast_aligned;
+    unsigned int overrun; // 丢弃的元素数，只由该读者修改
+};
+
+struct __kfifo_bcast
+{
+    /* 写端 */
+    _Atomic unsigned int in __kfifo_bcast_aligned;
+    _Atomic unsigned int head; // 正在写入的数据末尾，DROP 策略下读端用于校验
+    /* 只读部分 */
+    unsigned int mask __kfifo_bcast_aligned;
+    unsigned int esize;
+    unsigned int nreaders;
+    KFIFO_BCAST_POLICY policy;
+    void *data;
+    struct __kfifo_bcast_reader *readers;
+};
+
+#define __STRUCT_KFIFO_BCAST_COMMON(datatype) \
+    union                                     \
+    {                                         \
+        struct __kfifo_bcast kfifo;           \
+        datatype *type;                       \
+        const datatype *const_type;           \
+    }
+
+#define __STRUCT_KFIFO_BCAST(type, size, nreaders)                 \
+    {                                                              \
+        __STRUCT_KFIFO_BCAST_COMMON(type);                         \
+        type buf[((size < 2) || (size & (size - 1))) ? -1 : size]; \
+        struct __kfifo_bcast_reader readers[nreaders];             \
+    }
+
+#define STRUCT_KFIFO_BCAST(type, size, nreaders) \
+    struct __STRUCT_KFIFO_BCAST(type, size, nreaders)
+
+#define STRUCT_KFIFO_BCAST_PTR(type)       \
+    struct                                 \
+    {                                      \
+        __STRUCT_KFIFO_BCAST_COMMON(type); \
+    }
+
+/**
+ * DECLARE_KFIFO_BCAST - macro to declare a broadcast fifo object
+ * @fifo: name of the declared fifo
+ * @type: type of the fifo elements
+ * @size: the number of elements in the fifo, this must be a power of 2
+ * @nreaders: the number of readers
+ */
+#define DECLARE_KFIFO_BCAST(fifo, type, size, nreaders) STRUCT_KFIFO_BCAST(type, size, nreaders) fifo
+
+/**
+ * DECLARE_KFIFO_BCAST_PTR - macro to declare a broadcast fifo pointer object
+ * @fifo: name of the declared fifo
+ * @type: type of the fifo elements
+ */
+#define DECLARE_KFIFO_BCAST_PTR(fifo, type) STRUCT_KFIFO_BCAST_PTR(type) fifo
+
+/**
+ * INIT_KFIFO_BCAST - Initialize a fifo declared by DECLARE_KFIFO_BCAST
+ * @fifo: name of the declared fifo datatype
+ * @policy: KFIFO_BCAST_BLOCK or KFIFO_BCAST_DROP
+ *
+ * Must be called before the writer or any reader uses the fifo.
+ */
+#define INIT_KFIFO_BCAST(fifo, policy)                                        \
+    (void)({                                                                  \
+        typeof(&(fifo)) __tmp = &(fifo);                                      \
+        __kfifo_bcast_init(&__tmp->kfifo, __tmp->buf, ARRAY_SIZE(__tmp->buf), \
+                           sizeof(*__tmp->buf), __tmp->readers,               \
+                           ARRAY_SIZE(__tmp->readers), (policy));             \
+    })
+
+/**
+ * kfifo_bcast_alloc - dynamically allocates a new broadcast fifo buffer
+ * @fifo: pointer to the fifo
+ * @size: the number of elements in the fifo, this must be a power of 2
+ * @nreaders: the number of readers
+ * @policy: KFIFO_BCAST_BLOCK or KFIFO_BCAST_DROP
+ *
+ * The number of elements will be rounded-up to a power of 2.
+ * The fifo will be release with kfifo_bcast_free().
+ * Return 0 if no error, otherwise an error code.
+ */
+#define kfifo_bcast_alloc(fifo, size, nreaders, policy)                      \
+    __kfifo_int_must_check_helper(                                           \
+        ({                                                                   \
+            typeof((fifo) + 1) __tmp = (fifo);                               \
+            __kfifo_bcast_alloc(&__tmp->kfifo, (size), sizeof(*__tmp->type), \
+                                (nreaders), (policy));                       \
+        }))
+
+/**
+ * kfifo_bcast_free - frees the broadcast fifo
+ * @fifo: the fifo to be freed
+ */
+#define kfifo_bcast_free(fifo) __kfifo_bcast_free(&(fifo)->kfifo)
+
+/**
+ * kfifo_bcast_size - returns the size of the fifo in elements
+ * @fifo: address of the fifo to be used
+ */
+#define kfifo_bcast_size(fifo) ((fifo)->kfifo.mask + 1)
+
+/**
+ * kfifo_bcast_avail - returns the number of elements the writer can put
+ * @fifo: address of the fifo to be used
+ *
+ * For KFIFO_BCAST_DROP fifos this is always the size of the fifo.
+ */
+#define kfifo_bcast_avail(fifo) __kfifo_bcast_avail(&(fifo)->kfifo)
+
+/**
+ * kfifo_bcast_put - put data into the fifo
+ * @fifo: address of the fifo to be used
+ * @val: the data to be added
+ *
+ * This macro copies the given value into the fifo for all readers.
+ * It returns 0 if the fifo was full for the slowest reader (only for
+ * KFIFO_BCAST_BLOCK). Otherwise it returns the number processed elements.
+ */
+#define kfifo_bcast_put(fifo, val)                  \
+    ({                                              \
+        typeof((fifo) + 1) __tmp = (fifo);          \
+        typeof(*__tmp->const_type) __val = (val);   \
+        __kfifo_bcast_in(&__tmp->kfifo, &__val, 1); \
+    })
+
+/**
+ * kfifo_bcast_in - put data into the fifo
+ * @fifo: address of the fifo to be used
+ * @buf: the data to be added
+ * @n: number of elements to be added
+ *
+ * This macro copies the given buffer into the fifo for all readers and
+ * returns the number of copied elements.
+ */
+#define kfifo_bcast_in(fifo, buf, n)                 \
+    ({                                               \
+        typeof((fifo) + 1) __tmp = (fifo);           \
+        const typeof(*__tmp->type) *__buf = (buf);   \
+        __kfifo_bcast_in(&__tmp->kfifo, __buf, (n)); \
+    })
+
+/**
+ * kfifo_bcast_len - returns the number of elements available to a reader
+ * @fifo: address of the fifo to be used
+ * @r: index of the reader
+ *
+ * For KFIFO_BCAST_DROP fifos this is never more than the size of the fifo,
+ * older elements are already overwritten.
+ */
+#define kfifo_bcast_len(fifo, r) __kfifo_bcast_len(&(fifo)->kfifo, (r))
+
+/**
+ * kfifo_bcast_is_empty - returns true if a reader has no data
+ * @fifo: address of the fifo to be used
+ * @r: index of the reader
+ */
+#define kfifo_bcast_is_empty(fifo, r) (kfifo_bcast_len(fifo, r) == 0)
+
+/**
+ * kfifo_bcast_overrun - returns the number of elements a reader lost
+ * @fifo: address of the fifo to be used
+ * @r: index of the reader
+ *
+ * Only KFIFO_BCAST_DROP fifos lose data.
+ */
+#define kfifo_bcast_overrun(fifo, r) ((fifo)->kfifo.readers[r].overrun)
+
+/**
+ * kfifo_bcast_get - get data from the fifo
+ * @fifo: address of the fifo to be used
+ * @r: index of the reader
+ * @val: address where to store the data
+ *
+ * This macro reads the next element for reader @r.
+ * It returns 0 if there was no data. Otherwise it returns the number
+ * processed elements.
+ */
+#define kfifo_bcast_get(fifo, r, val)                        \
+    __kfifo_uint_must_check_helper(                          \
+        ({                                                   \
+            typeof((fifo) + 1) __tmp = (fifo);               \
+            typeof(__tmp->type) __val = (val);               \
+            __kfifo_bcast_out(&__tmp->kfifo, (r), __val, 1); \
+        }))
+
+/**
+ * kfifo_bcast_out - get data from the fifo
+ * @fifo: address of the fifo to be used
+ * @r: index of the reader
+ * @buf: pointer to the storage buffer
+ * @n: max. number of elements to get
+ *
+ * This macro copies data for reader @r and returns the numbers of elements
+ * copied. Data overwritten while it was copied is dropped and counted in
+ * kfifo_bcast_overrun().
+ */
+#define kfifo_bcast_out(fifo, r, buf, n)                       \
+    __kfifo_uint_must_check_helper(                            \
+        ({                                                     \
+            typeof((fifo) + 1) __tmp = (fifo);                 \
+            typeof(__tmp->type) __buf = (buf);                 \
+            __kfifo_bcast_out(&__tmp->kfifo, (r), __buf, (n)); \
+        }))
+
+/**
+ * kfifo_bcast_out_linear_ptr - gets a pointer to the available data
+ * @fifo: address of the fifo to be used
+ * @r: index of the reader
+ * @ptr: pointer to data to store the pointer to tail
+ * @n: max. number of elements to point at
+ *
+ * Similarly to kfifo_out_linear_ptr(), this macro obtains the pointer to the
+ * data of reader @r in the fifo buffer and returns the numbers of elements
+ * available till the end of data or till the end of the buffer. Release the
+ * data with kfifo_bcast_skip_count().
+ */
+#define kfifo_bcast_out_linear_ptr(fifo, r, ptr, n)                                                               \
+    __kfifo_uint_must_check_helper(                                                                               \
+        ({                                                                                                        \
+            typeof((fifo) + 1) ___tmp = (fifo);                                                                   \
+            unsigned int ___tail;                                                                                 \
+            unsigned int ___n = __kfifo_bcast_out_linear(&___tmp->kfifo, (r), &___tail, (n));                     \
+            *(ptr) = (typeof(___tmp->type))((unsigned char *)___tmp->kfifo.data + ___tail * ___tmp->kfifo.esize); \
+            ___n;                                                                                                 \
+        }))
+
+/**
+ * kfifo_bcast_skip_count - release data of a reader
+ * @fifo: address of the fifo to be used
+ * @r: index of the reader
+ * @count: count of data to skip
+ *
+ * Returns @count if the released data was still intact. For
+ * KFIFO_BCAST_DROP fifos it returns 0 if the writer has overwritten the
+ * data in the meantime, so the result of a zero-copy read must be dropped.
+ */
+#define kfifo_bcast_skip_count(fifo, r, count) __kfifo_bcast_skip(&(fifo)->kfifo, (r), (count))
+
+/**
+ * kfifo_bcast_reader_reset - let a reader skip all pending data
+ * @fifo: address of the fifo to be used
+ * @r: index of the reader
+ *
+ * Must be called from the reader @r. Useful to attach a reader that was not
+ * running, it then only sees data written after the call.
+ */
+#define kfifo_bcast_reader_reset(fifo, r) __kfifo_bcast_reader_reset(&(fifo)->kfifo, (r))
+
+extern int __kfifo_bcast_init(struct __kfifo_bcast *fifo, void *buffer,
+                              unsigned int size, size_t esize,
+                              struct __kfifo_bcast_reader *readers,
+                              unsigned int nreaders, KFIFO_BCAST_POLICY policy);
+
+extern int __kfifo_bcast_alloc(struct __kfifo_bcast *fifo, unsigned int size,
+                               size_t esize, unsigned int nreaders,
+                               KFIFO_BCAST_POLICY policy);
+
+extern void __kfifo_bcast_free(struct __kfifo_bcast *fifo);
+
+extern unsigned int __kfifo_bcast_avail(struct __kfifo_bcast *fifo);
+
+extern unsigned int __kfifo_bcast_in(struct __kfifo_bcast *fifo,
+                                     const void *buf, unsigned int len);
+
+extern unsigned int __kfifo_bcast_len(struct __kfifo_bcast *fifo, unsigned int r);
+
+extern unsigned int __kfifo_bcast_out(struct __kfifo_bcast *fifo, unsigned int r,
+                                      void *buf, unsigned int len);
+
+extern unsigned int __kfifo_bcast_out_linear(struct __kfifo_bcast *fifo, unsigned int r,
+                                             unsigned int *tail, unsigned int n);
+
+extern unsigned int __kfifo_bcast_skip(struct __kfifo_bcast *fifo, unsigned int r,
+                                       unsigned int count);
+
+extern void __kfifo_bcast_reader_reset(struct __kfifo_bcast *fifo, unsigned int r);
+
+#endif /* __KFIFO_BCAST_H__ */
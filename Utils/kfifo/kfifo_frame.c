@@ -0,0 +1,372 @@
+/**
+ * @file kfifo_frame.c
+ * @brief COBS/SLIP 帧编解码的实现文件
+ *
+ * 编码：先取得 FIFO 的全部空闲空间（`kfifo_in_linear` 的一段，加上回绕后从缓冲区开头开始的一段），
+ * 按数据块写入：COBS 每次用 `memchr` 找到下一个 0x00（最多 254 字节）后写入长度字节和整块数据；
+ * SLIP 找到下一个需要转义的字节后整段拷贝，再写入转义序列。空间不足时放弃，不发布 `in`。
+ *
+ * 解码：每次处理 `kfifo_out_linear` 返回的一段连续数据，处理完一段后发布 `out`。
+ * 丢弃模式（帧超长或格式错误）下直接 `memchr` 跳到下一个分隔符。
+ *
+ * @version 1.0.0
+ * @date 2026-10-16
+ * @author Jia Zhenyu
+ */
+
+#include "kfifo_frame.h"
+
+#define min(x, y) ((x) < (y) ? (x) : (y))
+
+#define COBS_BLOCK 254 // COBS 一个数据块的最大长度
+
+/* 编码时的输出位置：当前连续区域和回绕后的第二段区域 */
+struct frame_out
+{
+    unsigned char *p;
+    unsigned int room;
+    unsigned char *next;
+    unsigned int next_room;
+};
+
+static inline int frame_putc(struct frame_out *o, unsigned char c)
+{
+    if (!o->room)
+    {
+        if (!o->next_room)
+            return -1;
+        o->p = o->next;
+        o->room = o->next_room;
+        o->next_room = 0;
+    }
+    *o->p++ = c;
+    o->room--;
+    return 0;
+}
+
+static inline int frame_put(struct frame_out *o, const unsigned char *s, unsigned int n)
+{
+    unsigned int l;
+
+    if (n > o->room + o->next_room)
+        return -1;
+
+    l = min(n, o->room);
+    memcpy(o->p, s, l);
+    o->p += l;
+    o->room -= l;
+
+    if (l < n)
+    {
+        memcpy(o->next, s + l, n - l);
+        o->p = o->next + (n - l);
+        o->room = o->next_room - (n - l);
+        o->next_room = 0;
+    }
+    return 0;
+}
+
+static int frame_encode_cobs(struct frame_out *o, const unsigned char *s, unsigned int len)
+{
+    for (;;)
+    {
+        unsigned int k = min(len, COBS_BLOCK);
+        const unsigned char *z = memchr(s, 0, k);
+
+        if (z)
+            k = z - s;
+        if (frame_putc(o, k + 1) || frame_put(o, s, k))
+            return -1;
+        s += k;
+        len -= k;
+
+        if (z)
+        {
+            /* the zero is implied by the block length */
+            s++;
+            len--;
+        }
+        else if (!len)
+        {
+            break;
+        }
+    }
+    return frame_putc(o, 0);
+}
+
+/*
+ * 拷贝不需要转义的字节，遇到 END/ESC、数据结束或目标空间用完时停止，返回拷贝的字节数。
+ * 按字（size_t）处理：x 与重复的 END/ESC 异或后出现 0 字节即说明含有特殊字节
+ */
+#define SLIP_ONES ((size_t)-1 / 0xff)
+#define SLIP_HAS_ZERO(x) (((x) - SLIP_ONES) & ~(x) & (SLIP_ONES << 7))
+#define SLIP_HAS_SPECIAL(x) \
+    (SLIP_HAS_ZERO((x) ^ (SLIP_ONES * KFIFO_SLIP_END)) | SLIP_HAS_ZERO((x) ^ (SLIP_ONES * KFIFO_SLIP_ESC)))
+
+static inline unsigned int slip_copy(unsigned char *d, unsigned int room,
+                                     const unsigned char *s, unsigned int n)
+{
+    unsigned int i = 0, max = min(room, n);
+
+    while (max - i >= sizeof(size_t))
+    {
+        size_t x;
+
+        memcpy(&x, s + i, sizeof(x));
+        if (SLIP_HAS_SPECIAL(x))
+            break;
+        memcpy(d + i, &x, sizeof(x));
+        i += sizeof(x);
+    }
+    while (i < max && s[i] != KFIFO_SLIP_END && s[i] != KFIFO_SLIP_ESC)
+    {
+        d[i] = s[i];
+        i++;
+    }
+    return i;
+}
+
+static int frame_encode_slip(struct frame_out *o, const unsigned char *s, unsigned int len)
+{
+    const unsigned char *end = s + len;
+
+    if (frame_putc(o, KFIFO_SLIP_END))
+        return -1;
+
+    while (s < end)
+    {
+        unsigned int l = slip_copy(o->p, o->room, s, end - s);
+
+        o->p += l;
+        o->room -= l;
+        s += l;
+        if (s == end)
+            break;
+
+        if (*s == KFIFO_SLIP_END || *s == KFIFO_SLIP_ESC)
+        {
+            if (frame_putc(o, KFIFO_SLIP_ESC) ||
+                frame_putc(o, *s == KFIFO_SLIP_END ? KFIFO_SLIP_ESC_END : KFIFO_SLIP_ESC_ESC))
+                return -1;
+        }
+        else if (frame_putc(o, *s)) // 当前区域已满，换到第二段
+        {
+            return -1;
+        }
+        s++;
+    }
+    return frame_putc(o, KFIFO_SLIP_END);
+}
+
+unsigned int __kfifo_frame_encode(struct __kfifo *fifo, KFIFO_FRAME_TYPE type,
+                                  const void *buf, unsigned int len)
+{
+    unsigned int unused = __kfifo_unused(fifo, ~0U);
+    unsigned int head, ret;
+    struct frame_out o;
+
+    o.room = __kfifo_in_linear(fifo, &head, unused);
+    o.p = (unsigned char *)fifo->data + head;
+    o.next = (unsigned char *)fifo->data;
+    o.next_room = unused - o.room;
+
+    if ((type == KFIFO_FRAME_COBS ? frame_encode_cobs(&o, buf, len)
+                                  : frame_encode_slip(&o, buf, len)) < 0)
+    {
+        __kfifo_stats_short(fifo, len);
+        return 0;
+    }
+
+    ret = unused - o.room - o.next_room;
+    __kfifo_add_in(fifo, ret);
+    return ret;
+}
+
+void kfifo_frame_decoder_init(struct kfifo_frame_decoder *dec, KFIFO_FRAME_TYPE type,
+                              void *buf, unsigned int size)
+{
+    memset(dec, 0, sizeof(*dec));
+    dec->type = type;
+    dec->buf = buf;
+    dec->size = size;
+}
+
+/* 当前帧结束（收到分隔符），返回帧长度，丢弃的帧和空帧返回 0 */
+static unsigned int frame_end(struct kfifo_frame_decoder *dec, int bad)
+{
+    unsigned int len = dec->len;
+
+    if (bad && !dec->skip)
+        dec->errors++;
+    if (bad || dec->skip)
+        len = 0;
+
+    dec->len = 0;
+    dec->rem = 0;
+    dec->zero = 0;
+    dec->esc = 0;
+    dec->skip = 0;
+    return len;
+}
+
+/* 追加到当前帧，超长时进入丢弃模式 */
+static inline void frame_append(struct kfifo_frame_decoder *dec, const unsigned char *s, unsigned int n)
+{
+    if (dec->skip)
+        return;
+    if (n > dec->size - dec->len)
+    {
+        dec->skip = 1;
+        dec->errors++;
+        return;
+    }
+    memcpy(dec->buf + dec->len, s, n);
+    dec->len += n;
+}
+
+static inline void frame_append_byte(struct kfifo_frame_decoder *dec, unsigned char c)
+{
+    frame_append(dec, &c, 1);
+}
+
+/*
+ * 解码一段连续数据，返回处理的字节数，收到完整的帧时 *frame 为帧长度。
+ * COBS 的数据块内不应出现 0x00，出现时说明帧被截断
+ */
+static unsigned int frame_decode_cobs(struct kfifo_frame_decoder *dec, const unsigned char *s,
+                                      unsigned int n, unsigned int *frame)
+{
+    const unsigned char *p = s, *end = s + n;
+
+    while (p < end)
+    {
+        if (dec->skip)
+        {
+            const unsigned char *z = memchr(p, 0, end - p);
+
+            if (!z)
+                return n;
+            p = z + 1;
+            frame_end(dec, 0);
+            continue;
+        }
+
+        if (!dec->rem)
+        {
+            unsigned char code = *p++;
+
+            if (!code)
+            {
+                *frame = frame_end(dec, 0);
+                if (*frame)
+                    break;
+                continue;
+            }
+            if (dec->zero)
+                frame_append_byte(dec, 0);
+            dec->rem = code - 1;
+            dec->zero = code != 0xff;
+            continue;
+        }
+
+        {
+            unsigned int l = min(dec->rem, (unsigned int)(end - p));
+            const unsigned char *z = memchr(p, 0, l);
+
+            if (z)
+            {
+                p = z + 1;
+                frame_end(dec, 1);
+                continue;
+            }
+            frame_append(dec, p, l);
+            dec->rem -= l;
+            p += l;
+        }
+    }
+    return p - s;
+}
+
+static unsigned int frame_decode_slip(struct kfifo_frame_decoder *dec, const unsigned char *s,
+                                      unsigned int n, unsigned int *frame)
+{
+    const unsigned char *p = s, *end = s + n;
+
+    while (p < end)
+    {
+        const unsigned char *q;
+        unsigned int l;
+        unsigned char c;
+
+        if (dec->skip)
+        {
+            q = memchr(p, KFIFO_SLIP_END, end - p);
+            if (!q)
+                return n;
+            p = q + 1;
+            frame_end(dec, 0);
+            continue;
+        }
+
+        if (dec->esc)
+        {
+            c = *p++;
+            dec->esc = 0;
+            if (c == KFIFO_SLIP_ESC_END)
+                frame_append_byte(dec, KFIFO_SLIP_END);
+            else if (c == KFIFO_SLIP_ESC_ESC)
+                frame_append_byte(dec, KFIFO_SLIP_ESC);
+            else if (c == KFIFO_SLIP_END)
+                frame_end(dec, 1);
+            else
+            {
+                dec->skip = 1;
+                dec->errors++;
+            }
+            continue;
+        }
+
+        l = slip_copy(dec->buf + dec->len, dec->size - dec->len, p, end - p);
+        dec->len += l;
+        p += l;
+        if (p == end)
+            break;
+
+        c = *p++;
+        if (c == KFIFO_SLIP_ESC)
+        {
+            dec->esc = 1;
+            continue;
+        }
+        if (c != KFIFO_SLIP_END)
+        {
+            /* the frame buffer is full */
+            frame_append_byte(dec, c);
+            continue;
+        }
+        *frame = frame_end(dec, 0);
+        if (*frame)
+            break;
+    }
+    return p - s;
+}
+
+unsigned int __kfifo_frame_decode(struct __kfifo *fifo, struct kfifo_frame_decoder *dec)
+{
+    unsigned int frame = 0;
+
+    while (!frame)
+    {
+        unsigned int tail, l;
+
+        l = __kfifo_out_linear(fifo, &tail, ~0U);
+        if (!l)
+            break;
+
+        l = dec->type == KFIFO_FRAME_COBS
+                ? frame_decode_cobs(dec, (const unsigned char *)fifo->data + tail, l, &frame)
+                : frame_decode_slip(dec, (const unsigned char *)fifo->data + tail, l, &frame);
+        __kfifo_add_out(fifo, l);
+    }
+    return frame;
+}
@@ -0,0 +1,137 @@
+/**
+ * @file kfifo_frame.h
+ * @brief 直接在 KFIFO 上进行 COBS/SLIP 帧编解码
+ *
+ * 串口协议通常需要把数据包分帧，常见做法是逐字节 `kfifo_get` 再交给状态机。本模块直接操作
+ * FIFO 缓冲区：
+ * - 编码：`kfifo_frame_encode` 把一个数据包编码后直接写入 FIFO 的空闲空间（一段或两段连续区域），
+ *   整帧写完后一次发布 `in`，读端不会看到半帧；空间不足时不写入任何数据。
+ * - 解码：`kfifo_frame_decode` 按 `kfifo_out_linear_ptr` 的方式逐段处理已用区域，解码状态保存在
+ *   `struct kfifo_frame_decoder` 中，数据不完整时下次调用继续，收到完整的帧时返回帧长度。
+ *
+ * 编解码按连续的数据块处理（`memchr` 查找分隔符/需要转义的字节，`memcpy` 拷贝数据），
+ * 不对每个字节调用函数，耗时与字节数成正比。
+ *
+ * 帧格式：
+ * - `KFIFO_FRAME_COBS`：Consistent Overhead Byte Stuffing，帧以 0x00 结束，每 254 字节最多增加 1 字节开销。
+ * - `KFIFO_FRAME_SLIP`：RFC 1055，帧的开头和结尾都是 END（0xC0），END/ESC 转义为两个字节。
+ *
+ * 注意事项：
+ * - 仅适用于元素大小为 1 字节的非记录 FIFO。
+ * - 长度为 0 的帧（连续的分隔符）被忽略；超过解码缓冲区的帧和格式错误的帧被丢弃，计入 `errors`。
+ * - 编码端是 FIFO 的写者，解码端是 FIFO 的读者，一读一写无需加锁。
+ *
+ * @version 1.0.0
+ * @date 2026-10-16
+ * @author Jia Zhenyu
+ */
+
+#ifndef __KFIFO_FRAME_H__
+#define __KFIFO_FRAME_H__
+
+#include "kfifo.h"
+
+typedef enum
+{
+    KFIFO_FRAME_COBS = 0, // 以 0x00 结束的 COBS 帧
+    KFIFO_FRAME_SLIP      // RFC 1055 SLIP 帧
+} KFIFO_FRAME_TYPE;
+
+/* SLIP 的特殊字节 */
+#define KFIFO_SLIP_END 0xc0
+#define KFIFO_SLIP_ESC 0xdb
+#define KFIFO_SLIP_ESC_END 0xdc
+#define KFIFO_SLIP_ESC_ESC 0xdd
+
+/**
+ * KFIFO_FRAME_MAX_ENCODED - worst case size of an encoded frame
+ * @type: KFIFO_FRAME_COBS or KFIFO_FRAME_SLIP
+ * @len: length of the payload in bytes
+ *
+ * Includes the delimiter(s). A fifo with at least this much free space
+ * always accepts the frame.
+ */
+#define KFIFO_FRAME_MAX_ENCODED(type, len) \
+    ((type) == KFIFO_FRAME_COBS ? (len) + (len) / 254 + 2 : 2 * (len) + 2)
+
+/* 解码器状态，由 kfifo_frame_decoder_init 初始化 */
+struct kfifo_frame_decoder
+{
+    KFIFO_FRAME_TYPE type;
+    unsigned char *buf;  // 保存解码后的帧
+    unsigned int size;   // buf 的大小
+    unsigned int len;    // 当前帧已解码的字节数
+    unsigned int rem;    // COBS：当前数据块剩余的字节数
+    unsigned char zero;  // COBS：下一个数据块前补 0x00
+    unsigned char esc;   // SLIP：上一个字节是 ESC
+    unsigned char skip;  // 丢弃到下一个分隔符
+    unsigned int errors; // 丢弃的帧数（超长或格式错误）
+};
+
+/**
+ * kfifo_frame_decoder_init - initialize a frame decoder
+ * @dec: the decoder
+ * @type: KFIFO_FRAME_COBS or KFIFO_FRAME_SLIP
+ * @buf: buffer for the decoded frame
+ * @size: size of @buf, longer frames are dropped
+ */
+extern void kfifo_frame_decoder_init(struct kfifo_frame_decoder *dec, KFIFO_FRAME_TYPE type,
+                                     void *buf, unsigned int size);
+
+/**
+ * kfifo_frame_encode - encode a frame into the fifo
+ * @fifo: address of the fifo to be used
+ * @format: KFIFO_FRAME_COBS or KFIFO_FRAME_SLIP
+ * @buf: the payload
+ * @len: length of the payload in bytes
+ *
+ * The frame is encoded straight into the free space of the fifo and
+ * published as a whole. Returns the number of bytes put into the fifo, or 0
+ * if the encoded frame does not fit (the fifo is left unchanged then).
+ *
+ * Only for fifos with 1 byte elements. Not available for record fifos, it
+ * returns 0 for them.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo_frame_encode(fifo, format, buf, len)                               \
+    ({                                                                           \
+        typeof((fifo) + 1) __tmp = (fifo);                                       \
+        const size_t __recsize = sizeof(*__tmp->rectype);                        \
+        struct __kfifo *__kfifo = &__tmp->kfifo;                                 \
+        (void)sizeof(char[sizeof(*__tmp->type) == 1 ? 1 : -1]);                  \
+        (__recsize) ? 0 : __kfifo_frame_encode(__kfifo, (format), (buf), (len)); \
+    })
+
+/**
+ * kfifo_frame_decode - decode the next frame from the fifo
+ * @fifo: address of the fifo to be used
+ * @dec: the decoder, see kfifo_frame_decoder_init()
+ *
+ * Consumes the data of the fifo up to the end of the next complete frame.
+ * Returns the length of the frame, which is in the buffer of @dec until the
+ * next call. Returns 0 if the fifo holds no complete frame, all of its data
+ * is consumed then and the decoding resumes with the next call.
+ *
+ * Only for fifos with 1 byte elements. Not available for record fifos, it
+ * returns 0 for them.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo_frame_decode(fifo, dec)                           \
+    ({                                                          \
+        typeof((fifo) + 1) __tmp = (fifo);                      \
+        const size_t __recsize = sizeof(*__tmp->rectype);       \
+        struct __kfifo *__kfifo = &__tmp->kfifo;                \
+        (void)sizeof(char[sizeof(*__tmp->type) == 1 ? 1 : -1]); \
+        (__recsize) ? 0 : __kfifo_frame_decode(__kfifo, (dec)); \
+    })
+
+extern unsigned int __kfifo_frame_encode(struct __kfifo *fifo, KFIFO_FRAME_TYPE type,
+                                         const void *buf, unsigned int len);
+
+extern unsigned int __kfifo_frame_decode(struct __kfifo *fifo, struct kfifo_frame_decoder *dec);
+
+#endif /* __KFIFO_FRAME_H__ */
@@ -0,0 +1,123 @@
+/**
+ * @file kfifo_linux.h
+ * @brief KFIFO 在 Linux 主机上的扩展接口
+ *
+ * 本文件提供只在 Linux 主机（如上位机数据采集程序）上可用的 KFIFO 扩展：
+ * - `kfifo_alloc_mirror`：使用 memfd 将同一块内存连续映射两次，分配镜像缓冲区。
+ *   `data + off` 起始的 size 个元素总是连续的，拷贝不再拆成两段，
+ *   `kfifo_out_linear_ptr` / `kfifo_in_linear_ptr` 返回全部已用/空闲空间，
+ *   解析器或 `write(2)` 可以直接零拷贝处理整帧数据。
+ * - `kfifo_out_fd` / `kfifo_in_fd`：对 FIFO 中的一段或两段连续区域直接调用一次
+ *   `writev(2)` / `readv(2)`，数据在 FIFO 与文件、管道、socket 之间传输时不再经过中间缓冲区。
+ * - `kfifo_persist_map_file`：将文件共享映射为持久化 FIFO（`kfifo_persist.h`）的内存区，
+ *   进程崩溃或重启后用 `kfifo_persist_attach` 恢复。
+ *
+ * 注意事项：
+ * - 需要链接 `kfifo_linux.c`。
+ * - 镜像缓冲区需要定义 `KFIFO_MIRROR` 编译（所有包含 `kfifo.h` 的文件需一致）。
+ * - 缓冲区字节数会向上取整到页大小的整数倍（元素个数仍为 2 的幂）。
+ * - 镜像缓冲区同样使用 `kfifo_free` 释放。
+ *
+ * @version 1.0.0
+ * @date 2026-10-16
+ * @author Jia Zhenyu
+ */
+
+#ifndef __KFIFO_LINUX_H__
+#define __KFIFO_LINUX_H__
+
+#include <sys/types.h>
+#include "kfifo.h"
+
+#ifdef KFIFO_MIRROR
+
+/**
+ * kfifo_alloc_mirror - dynamically allocates a new mirrored fifo buffer
+ * @fifo: pointer to the fifo
+ * @size: the number of elements in the fifo, this must be a power of 2
+ *
+ * This macro maps the same memfd pages twice back-to-back, so the data at
+ * (@fifo->data + @off) is contiguous for up to kfifo_size() elements and
+ * no access is split at the end of the buffer.
+ *
+ * The number of elements will be rounded-up to a power of 2, and further
+ * until the buffer is a multiple of the page size.
+ * The fifo will be release with kfifo_free().
+ * Return 0 if no error, otherwise an error code.
+ */
+#define kfifo_alloc_mirror(fifo, size)                                                                               \
+    __kfifo_int_must_check_helper(                                                                                   \
+        ({                                                                                                           \
+            typeof((fifo) + 1) __tmp = (fifo);                                                                       \
+            struct __kfifo *__kfifo = &__tmp->kfifo;                                                                 \
+            int __ret = __is_kfifo_ptr(__tmp) ? __kfifo_alloc_mirror(__kfifo, size, sizeof(*__tmp->type)) : -EINVAL; \
+            __kfifo_check_rec_4(__tmp, __ret, 1);                                                                    \
+        }))
+
+extern int __kfifo_alloc_mirror(struct __kfifo *fifo, unsigned int size,
+                                size_t esize);
+#endif /* KFIFO_MIRROR */
+
+/**
+ * kfifo_out_fd - write data from the fifo to a file descriptor
+ * @fifo: address of the fifo to be used
+ * @fd: file descriptor to write to
+ * @max: max. number of bytes to write
+ *
+ * This macro hands the (up to two) contiguous parts of the data in the fifo
+ * to a single writev() and removes the bytes actually written, so partial
+ * writes to pipes and sockets keep the rest in the fifo.
+ *
+ * Returns the number of bytes written, 0 if the fifo is empty, or -1 with
+ * errno set. For a nonblocking @fd, -1 with errno EAGAIN means nothing was
+ * written and the fifo is unchanged. Interrupted calls are restarted.
+ *
+ * Only for fifos with 1 byte elements, not for record fifos.
+ */
+#define kfifo_out_fd(fifo, fd, max)                                                        \
+    ({                                                                                     \
+        typeof((fifo) + 1) __tmp = (fifo);                                                 \
+        (void)sizeof(char[(sizeof(*__tmp->type) == 1 && !kfifo_recsize(__tmp)) ? 1 : -1]); \
+        __kfifo_out_fd(&__tmp->kfifo, (fd), (max));                                        \
+    })
+
+/**
+ * kfifo_in_fd - read data from a file descriptor into the fifo
+ * @fifo: address of the fifo to be used
+ * @fd: file descriptor to read from
+ * @max: max. number of bytes to read
+ *
+ * This macro hands the (up to two) contiguous parts of the free space in the
+ * fifo to a single readv() and publishes the bytes actually read.
+ *
+ * Returns the number of bytes read, 0 at end of file or if the fifo is full,
+ * or -1 with errno set. For a nonblocking @fd, -1 with errno EAGAIN means no
+ * data was available. Interrupted calls are restarted.
+ *
+ * Only for fifos with 1 byte elements, not for record fifos.
+ */
+#define kfifo_in_fd(fifo, fd, max)                                                         \
+    ({                                                                                     \
+        typeof((fifo) + 1) __tmp = (fifo);                                                 \
+        (void)sizeof(char[(sizeof(*__tmp->type) == 1 && !kfifo_recsize(__tmp)) ? 1 : -1]); \
+        __kfifo_in_fd(&__tmp->kfifo, (fd), (max));                                         \
+    })
+
+extern ssize_t __kfifo_out_fd(struct __kfifo *fifo, int fd, unsigned int max);
+
+extern ssize_t __kfifo_in_fd(struct __kfifo *fifo, int fd, unsigned int max);
+
+/**
+ * kfifo_persist_map_file - map a file as the region of a persistent fifo
+ * @path: file to be used, created if it does not exist
+ * @len: size of the region in bytes, see KFIFO_PERSIST_BYTES()
+ *
+ * The file is grown to @len bytes if needed and mapped shared, so every
+ * store to the fifo goes to the page cache without a system call and
+ * survives a crash of the process. Use munmap() to release the region.
+ *
+ * Returns the page aligned region or NULL with errno set.
+ */
+extern void *kfifo_persist_map_file(const char *path, size_t len);
+
+#endif /* __KFIFO_LINUX_H__ */
@@ -0,0 +1,209 @@
+/**
+ * @file kfifo_mpmc.c
+ * @brief 多生产者/多消费者（MPMC）无锁环形 FIFO 的实现文件
+ *
+ * 每个槽位 i 带一个序号 seq[i]，初始值为 i：
+ * - 生产者在位置 pos 上写入前要求 seq == pos，写完后将 seq 置为 pos + 1；
+ * - 消费者在位置 pos 上读取前要求 seq == pos + 1，读完后将 seq 置为 pos + size。
+ * `in`/`out` 只用于分配位置（CAS），数据是否就绪由槽位序号决定，
+ * 因此多个生产者、多个消费者之间不需要任何锁。
+ *
+ * @version 1.0.0
+ * @date 2026-10-16
+ * @author Jia Zhenyu
+ */
+
+#include "kfifo_mpmc.h"
+
+#define is_power_of_2(x) ((x) != 0 && (((x) & ((x) - 1)) == 0))
+
+static void kfifo_mpmc_reset(struct __kfifo_mpmc *fifo)
+{
+    unsigned int i;
+
+    for (i = 0; i <= fifo->mask; i++)
+        atomic_init(&fifo->seq[i], i);
+
+    atomic_init(&fifo->in, 0);
+    atomic_init(&fifo->out, 0);
+}
+
+int __kfifo_mpmc_init(struct __kfifo_mpmc *fifo, void *buffer,
+                      _Atomic unsigned int *seq, unsigned int size, size_t esize)
+{
+    fifo->esize = esize;
+    fifo->data = buffer;
+    fifo->seq = seq;
+
+    if (size < 2 || !is_power_of_2(size))
+    {
+        fifo->mask = 0;
+        return -EINVAL;
+    }
+    fifo->mask = size - 1;
+
+    kfifo_mpmc_reset(fifo);
+    return 0;
+}
+
+int __kfifo_mpmc_alloc(struct __kfifo_mpmc *fifo, unsigned int size,
+                       size_t esize)
+{
+    size = __kfifo_roundup_pow_of_two(size);
+
+    fifo->esize = esize;
+    fifo->data = NULL;
+    fifo->seq = NULL;
+    fifo->mask = 0;
+
+    if (size < 2)
+        return -EINVAL;
+
+    fifo->data = malloc(esize * size);
+    fifo->seq = malloc(sizeof(*fifo->seq) * size);
+
+    if (!fifo->data || !fifo->seq)
+    {
+        free(fifo->data);
+        free(fifo->seq);
+        fifo->data = NULL;
+        fifo->seq = NULL;
+        return -ENOMEM;
+    }
+    fifo->mask = size - 1;
+
+    kfifo_mpmc_reset(fifo);
+    return 0;
+}
+
+void __kfifo_mpmc_free(struct __kfifo_mpmc *fifo)
+{
+    free(fifo->data);
+    free(fifo->seq);
+    fifo->data = NULL;
+    fifo->seq = NULL;
+    fifo->esize = 0;
+    fifo->mask = 0;
+    atomic_init(&fifo->in, 0);
+    atomic_init(&fifo->out, 0);
+}
+
+unsigned int __kfifo_mpmc_put(struct __kfifo_mpmc *fifo, const void *val)
+{
+    unsigned int mask = fifo->mask;
+    unsigned int pos = atomic_load_explicit(&fifo->in, memory_order_relaxed);
+    _Atomic unsigned int *seq;
+
+    for (;;)
+    {
+        seq = &fifo->seq[pos & mask];
+
+        int diff = (int)(atomic_load_explicit(seq, memory_order_acquire) - pos);
+
+        if (diff == 0)
+        {
+            /* the slot is free, try to claim the position */
+            if (atomic_compare_exchange_weak_explicit(&fifo->in, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            /* the slot still holds data of the previous lap: fifo is full */
+            return 0;
+        }
+        else
+        {
+            /* another writer took this position, try again */
+            pos = atomic_load_explicit(&fifo->in, memory_order_relaxed);
+        }
+    }
+
+    memcpy((unsigned char *)fifo->data + (pos & mask) * fifo->esize, val, fifo->esize);
+    /*
+     * make sure that the data in the slot is up to date before
+     * publishing the slot to the readers
+     */
+    atomic_store_explicit(seq, pos + 1, memory_order_release);
+    return 1;
+}
+
+unsigned int __kfifo_mpmc_get(struct __kfifo_mpmc *fifo, void *val)
+{
+    unsigned int mask = fifo->mask;
+    unsigned int pos = atomic_load_explicit(&fifo->out, memory_order_relaxed);
+    _Atomic unsigned int *seq;
+
+    for (;;)
+    {
+        seq = &fifo->seq[pos & mask];
+
+        int diff = (int)(atomic_load_explicit(seq, memory_order_acquire) - (pos + 1));
+
+        if (diff == 0)
+        {
+            /* the slot is filled, try to claim the position */
+            if (atomic_compare_exchange_weak_explicit(&fifo->out, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            /* the slot is not written yet: fifo is empty */
+            return 0;
+        }
+        else
+        {
+            /* another reader took this position, try again */
+            pos = atomic_load_explicit(&fifo->out, memory_order_relaxed);
+        }
+    }
+
+    memcpy(val, (unsigned char *)fifo->data + (pos & mask) * fifo->esize, fifo->esize);
+    /*
+     * make sure that the data is copied before
+     * handing the slot back to the writers of the next lap
+     */
+    atomic_store_explicit(seq, pos + mask + 1, memory_order_release);
+    return 1;
+}
+
+unsigned int __kfifo_mpmc_in(struct __kfifo_mpmc *fifo,
+                             const void *buf, unsigned int len)
+{
+    const unsigned char *s = (const unsigned char *)buf;
+    unsigned int i;
+
+    for (i = 0; i < len; i++)
+    {
+        if (!__kfifo_mpmc_put(fifo, s + i * fifo->esize))
+            break;
+    }
+    return i;
+}
+
+unsigned int __kfifo_mpmc_out(struct __kfifo_mpmc *fifo,
+                              void *buf, unsigned int len)
+{
+    unsigned char *d = (unsigned char *)buf;
+    unsigned int i;
+
+    for (i = 0; i < len; i++)
+    {
+        if (!__kfifo_mpmc_get(fifo, d + i * fifo->esize))
+            break;
+    }
+    return i;
+}
+
+unsigned int __kfifo_mpmc_len(struct __kfifo_mpmc *fifo)
+{
+    unsigned int out = atomic_load_explicit(&fifo->out, memory_order_acquire);
+    unsigned int in = atomic_load_explicit(&fifo->in, memory_order_acquire);
+    unsigned int len = in - out;
+
+    /* in is read after out, writers may have advanced in the meantime */
+    return len > fifo->mask + 1 ? fifo->mask + 1 : len;
+}
@@ -0,0 +1,231 @@
+/**
+ * @file kfifo_mpmc.h
+ * @brief 多生产者/多消费者（MPMC）无锁环形 FIFO 的头文件
+ *
+ * 本文件定义了一个有界的多生产者/多消费者无锁 FIFO，基于 Vyukov 的每槽序号算法：
+ * 每个槽位带一个序号，生产者/消费者通过 CAS 抢占 `in`/`out` 位置，再通过槽位序号
+ * 发布数据，不需要任何全局临界区。多个中断或多个线程可以同时向同一个 FIFO 投递数据。
+ *
+ * 设计特点：
+ * - 保留 `struct __kfifo` 的 2 的幂 + `mask` 设计。
+ * - 接口风格与 `kfifo_put` / `kfifo_get` 保持一致。
+ * - `in` 和 `out` 分别位于独立的 cache line，避免伪共享。
+ *
+ * 注意事项：
+ * - 依赖 C11 `stdatomic.h` 的 CAS 操作，需要使用 `gnu11` 编译；Cortex-M0/M0+ 没有
+ *   LDREX/STREX 指令，不适用。
+ * - 每个元素需要额外的一个 `unsigned int` 序号。
+ * - `kfifo_mpmc_len` 在并发访问时只是一个近似值。
+ *
+ * @version 1.0.0
+ * @date 2026-10-16
+ * @author Jia Zhenyu
+ */
+
+#ifndef __KFIFO_MPMC_H__
+#define __KFIFO_MPMC_H__
+
+#include <stdatomic.h>
+#include "kfifo.h"
+
+struct __kfifo_mpmc
+{
+    /* 生产者 cache line */
+    _Atomic unsigned int in __kfifo_cacheline_aligned;
+    /* 消费者 cache line */
+    _Atomic unsigned int out __kfifo_cacheline_aligned;
+    /* 只读部分 */
+    unsigned int mask __kfifo_cacheline_aligned;
+    unsigned int esize;
+    void *data;
+    _Atomic unsigned int *seq;
+};
+
+#define __STRUCT_KFIFO_MPMC_COMMON(datatype) \
+    union                                    \
+    {                                        \
+        struct __kfifo_mpmc kfifo;           \
+        datatype *type;                      \
+        const datatype *const_type;          \
+    }
+
+#define __STRUCT_KFIFO_MPMC(type, size)                            \
+    {                                                              \
+        __STRUCT_KFIFO_MPMC_COMMON(type);                          \
+        type buf[((size < 2) || (size & (size - 1))) ? -1 : size]; \
+        _Atomic unsigned int seq[size];                            \
+    }
+
+#define STRUCT_KFIFO_MPMC(type, size) \
+    struct __STRUCT_KFIFO_MPMC(type, size)
+
+#define STRUCT_KFIFO_MPMC_PTR(type)       \
+    struct                                \
+    {                                     \
+        __STRUCT_KFIFO_MPMC_COMMON(type); \
+    }
+
+/**
+ * DECLARE_KFIFO_MPMC - macro to declare a mpmc fifo object
+ * @fifo: name of the declared fifo
+ * @type: type of the fifo elements
+ * @size: the number of elements in the fifo, this must be a power of 2
+ */
+#define DECLARE_KFIFO_MPMC(fifo, type, size) STRUCT_KFIFO_MPMC(type, size) fifo
+
+/**
+ * DECLARE_KFIFO_MPMC_PTR - macro to declare a mpmc fifo pointer object
+ * @fifo: name of the declared fifo
+ * @type: type of the fifo elements
+ */
+#define DECLARE_KFIFO_MPMC_PTR(fifo, type) STRUCT_KFIFO_MPMC_PTR(type) fifo
+
+/**
+ * INIT_KFIFO_MPMC - Initialize a fifo declared by DECLARE_KFIFO_MPMC
+ * @fifo: name of the declared fifo datatype
+ *
+ * Must be called before any producer or consumer uses the fifo.
+ */
+#define INIT_KFIFO_MPMC(fifo)                                           \
+    (void)({                                                            \
+        typeof(&(fifo)) __tmp = &(fifo);                                \
+        __kfifo_mpmc_init(&__tmp->kfifo, __tmp->buf, __tmp->seq,        \
+                          ARRAY_SIZE(__tmp->buf), sizeof(*__tmp->buf)); \
+    })
+
+/**
+ * kfifo_mpmc_alloc - dynamically allocates a new mpmc fifo buffer
+ * @fifo: pointer to the fifo
+ * @size: the number of elements in the fifo, this must be a power of 2
+ *
+ * The number of elements will be rounded-up to a power of 2.
+ * The fifo will be release with kfifo_mpmc_free().
+ * Return 0 if no error, otherwise an error code.
+ */
+#define kfifo_mpmc_alloc(fifo, size)                                         \
+    __kfifo_int_must_check_helper(                                           \
+        ({                                                                   \
+            typeof((fifo) + 1) __tmp = (fifo);                               \
+            __kfifo_mpmc_alloc(&__tmp->kfifo, (size), sizeof(*__tmp->type)); \
+        }))
+
+/**
+ * kfifo_mpmc_free - frees the mpmc fifo
+ * @fifo: the fifo to be freed
+ */
+#define kfifo_mpmc_free(fifo) __kfifo_mpmc_free(&(fifo)->kfifo)
+
+/**
+ * kfifo_mpmc_size - returns the size of the fifo in elements
+ * @fifo: address of the fifo to be used
+ */
+#define kfifo_mpmc_size(fifo) ((fifo)->kfifo.mask + 1)
+
+/**
+ * kfifo_mpmc_len - returns the number of used elements in the fifo
+ * @fifo: address of the fifo to be used
+ *
+ * The result is only a snapshot when producers or consumers are running.
+ */
+#define kfifo_mpmc_len(fifo) __kfifo_mpmc_len(&(fifo)->kfifo)
+
+/**
+ * kfifo_mpmc_is_empty - returns true if the fifo is empty
+ * @fifo: address of the fifo to be used
+ */
+#define kfifo_mpmc_is_empty(fifo) (kfifo_mpmc_len(fifo) == 0)
+
+/**
+ * kfifo_mpmc_put - put data into the fifo
+ * @fifo: address of the fifo to be used
+ * @val: the data to be added
+ *
+ * This macro copies the given value into the fifo.
+ * It returns 0 if the fifo was full. Otherwise it returns the number
+ * processed elements.
+ *
+ * Any number of concurrent writers and readers may use this macro
+ * without extra locking.
+ */
+#define kfifo_mpmc_put(fifo, val)                 \
+    ({                                            \
+        typeof((fifo) + 1) __tmp = (fifo);        \
+        typeof(*__tmp->const_type) __val = (val); \
+        __kfifo_mpmc_put(&__tmp->kfifo, &__val);  \
+    })
+
+/**
+ * kfifo_mpmc_get - get data from the fifo
+ * @fifo: address of the fifo to be used
+ * @val: address where to store the data
+ *
+ * This macro reads the data from the fifo.
+ * It returns 0 if the fifo was empty. Otherwise it returns the number
+ * processed elements.
+ *
+ * Any number of concurrent writers and readers may use this macro
+ * without extra locking.
+ */
+#define kfifo_mpmc_get(fifo, val)                   \
+    __kfifo_uint_must_check_helper(                 \
+        ({                                          \
+            typeof((fifo) + 1) __tmp = (fifo);      \
+            typeof(__tmp->type) __val = (val);      \
+            __kfifo_mpmc_get(&__tmp->kfifo, __val); \
+        }))
+
+/**
+ * kfifo_mpmc_in - put data into the fifo
+ * @fifo: address of the fifo to be used
+ * @buf: the data to be added
+ * @n: number of elements to be added
+ *
+ * This macro copies the given buffer into the fifo element by element and
+ * returns the number of copied elements. Elements of one call may be
+ * interleaved with elements of other writers.
+ */
+#define kfifo_mpmc_in(fifo, buf, n)                 \
+    ({                                              \
+        typeof((fifo) + 1) __tmp = (fifo);          \
+        const typeof(*__tmp->type) *__buf = (buf);  \
+        __kfifo_mpmc_in(&__tmp->kfifo, __buf, (n)); \
+    })
+
+/**
+ * kfifo_mpmc_out - get data from the fifo
+ * @fifo: address of the fifo to be used
+ * @buf: pointer to the storage buffer
+ * @n: max. number of elements to get
+ *
+ * This macro gets some data from the fifo element by element and returns
+ * the numbers of elements copied.
+ */
+#define kfifo_mpmc_out(fifo, buf, n)                     \
+    __kfifo_uint_must_check_helper(                      \
+        ({                                               \
+            typeof((fifo) + 1) __tmp = (fifo);           \
+            typeof(__tmp->type) __buf = (buf);           \
+            __kfifo_mpmc_out(&__tmp->kfifo, __buf, (n)); \
+        }))
+
+extern int __kfifo_mpmc_init(struct __kfifo_mpmc *fifo, void *buffer,
+                             _Atomic unsigned int *seq, unsigned int size, size_t esize);
+
+extern int __kfifo_mpmc_alloc(struct __kfifo_mpmc *fifo, unsigned int size,
+                              size_t esize);
+
+extern void __kfifo_mpmc_free(struct __kfifo_mpmc *fifo);
+
+extern unsigned int __kfifo_mpmc_put(struct __kfifo_mpmc *fifo, const void *val);
+
+extern unsigned int __kfifo_mpmc_get(struct __kfifo_mpmc *fifo, void *val);
+
+extern unsigned int __kfifo_mpmc_in(struct __kfifo_mpmc *fifo,
+                                    const void *buf, unsigned int len);
+
+extern unsigned int __kfifo_mpmc_out(struct __kfifo_mpmc *fifo,
+                                     void *buf, unsigned int len);
+
+extern unsigned int __kfifo_mpmc_len(struct __kfifo_mpmc *fifo);
+
+#endif /* __KFIFO_MPMC_H__ */
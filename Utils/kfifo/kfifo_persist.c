@@ -0,0 +1,104 @@
+/**
+ * @file kfifo_persist.c
+ * @brief 持久化 FIFO 的实现文件
+ *
+ * 恢复时依次检查：魔数、CRC（覆盖不变的头部字段）、记录头大小和元素大小是否与调用者一致、
+ * 容量是否为 2 的幂且不超出内存区、`in - out` 是否不超过容量。全部通过时只修正数据指针
+ * （内存区的地址可能变化，例如文件被映射到不同的地址）和 `KFIFO_SMP` 的索引缓存。
+ *
+ * 格式化时先清除魔数，最后写入魔数，格式化过程中复位不会留下看似有效的头部。
+ *
+ * @version 1.0.0
+ * @date 2026-10-16
+ * @author Jia Zhenyu
+ */
+
+#include "kfifo_persist.h"
+
+#define is_power_of_2(x) ((x) != 0 && (((x) & ((x) - 1)) == 0))
+
+/* CRC-32（多项式 0xEDB88320），只在 attach 时计算，按位计算即可 */
+static uint32_t kfifo_crc32(const void *buf, size_t len)
+{
+    const unsigned char *p = (const unsigned char *)buf;
+    uint32_t crc = 0xffffffffU;
+    int i;
+
+    while (len--)
+    {
+        crc ^= *p++;
+        for (i = 0; i < 8; i++)
+            crc = (crc >> 1) ^ (0xedb88320U & -(crc & 1));
+    }
+    return ~crc;
+}
+
+static uint32_t kfifo_persist_crc(const struct kfifo_persist *region)
+{
+    const uint32_t hdr[5] = {
+        KFIFO_PERSIST_MAGIC,
+        region->recsize,
+        (uint32_t)sizeof(*region),
+        region->kfifo.mask,
+        region->kfifo.esize,
+    };
+
+    return kfifo_crc32(hdr, sizeof(hdr));
+}
+
+/* 内存区中数据区的字节数 */
+static unsigned int kfifo_persist_space(size_t len)
+{
+    len -= sizeof(struct kfifo_persist);
+    return len > 0xffffffffU ? 0xffffffffU : (unsigned int)len;
+}
+
+int __kfifo_persist_format(struct kfifo_persist *region, size_t len,
+                           size_t esize, size_t recsize)
+{
+    if ((uintptr_t)region % KFIFO_PERSIST_ALIGN || len <= sizeof(*region))
+        return -EINVAL;
+
+    region->magic = 0;
+    if (__kfifo_init(&region->kfifo, region + 1, kfifo_persist_space(len), esize))
+        return -EINVAL;
+
+    region->recsize = recsize;
+    region->crc = kfifo_persist_crc(region);
+    region->magic = KFIFO_PERSIST_MAGIC;
+    return 0;
+}
+
+int __kfifo_persist_attach(struct kfifo_persist *region, size_t len,
+                           size_t esize, size_t recsize)
+{
+    struct __kfifo *fifo = &region->kfifo;
+    unsigned int size, in, out;
+
+    if ((uintptr_t)region % KFIFO_PERSIST_ALIGN || len <= sizeof(*region))
+        return -EINVAL;
+
+    if (region->magic != KFIFO_PERSIST_MAGIC || region->recsize != recsize ||
+        region->crc != kfifo_persist_crc(region) || fifo->esize != esize)
+        return __kfifo_persist_format(region, len, esize, recsize);
+
+    size = fifo->mask + 1;
+    if (size < 2 || !is_power_of_2(size) || size > kfifo_persist_space(len) / esize)
+        return __kfifo_persist_format(region, len, esize, recsize);
+
+    in = __kfifo_load(&fifo->in);
+    out = __kfifo_load(&fifo->out);
+    if (in - out > size)
+        return __kfifo_persist_format(region, len, esize, recsize);
+
+    /* the region may be mapped at a different address than before */
+    fifo->data = region + 1;
+    __kfifo_reset_flags(fifo);
+    __kfifo_reset_wm(fifo);
+    __kfifo_init_stats(fifo);
+#ifdef KFIFO_SMP
+    fifo->in_cache = in;
+    fifo->out_cache = out;
+#endif /* KFIFO_SMP */
+    return 1;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file kfifo_persist.h
+ * @brief 可在复位/进程重启后恢复的持久化 FIFO
+ *
+ * FIFO 头和数据都放在调用者提供的一块内存中：
+ * - MCU：链接到 `.noinit` 段的 RAM，热复位（看门狗、软件复位）后内容保留。
+ * - Linux：`kfifo_persist_map_file`（`kfifo_linux.h`）映射的文件，进程崩溃或重启后内容保留。
+ *
+ * 内存布局为 `struct kfifo_persist` 头（魔数、记录头大小、CRC 和 `struct __kfifo`）后面紧跟数据区。
+ * `kfifo_persist_attach` 校验头部，校验通过时直接在原地恢复 FIFO（只修正数据指针，不拷贝数据），
+ * 否则格式化为空 FIFO。之后与普通 FIFO 一样使用 `kfifo.h` 的宏，写入仍然只是普通的内存读写。
+ *
+ * 注意事项：
+ * - CRC 只覆盖不变的部分（魔数、记录头大小、头部大小、`mask`、`esize`），`in`/`out` 每次更新不需要重算 CRC；
+ *   恢复时另外检查 `in - out` 不超过 FIFO 大小。
+ * - 数据先写入再发布 `in`，复位时正在写入的元素不会被读到。
+ * - 头部大小与编译选项（`KFIFO_SMP` 等）有关，选项改变后头部校验失败，FIFO 被重新格式化。
+ * - 内存区需要按 `KFIFO_PERSIST_ALIGN` 对齐，FIFO 大小为 2 的幂（多余的空间不使用）。
+ *
+ * @version 1.0.0
+ * @date 2026-10-16
+ * @author Jia Zhenyu
+ */
+
+#ifndef __KFIFO_PERSIST_H__
+#define __KFIFO_PERSIST_H__
+
+#include "kfifo.h"
+
+#define KFIFO_PERSIST_MAGIC 0x4b465053U // "KFPS"
+
+/* 持久化 FIFO 的头部，数据区紧跟其后 */
+struct kfifo_persist
+{
+    uint32_t magic;
+    uint32_t recsize;
+    uint32_t crc; // 魔数、记录头大小、头部大小、mask、esize 的 CRC32
+    struct __kfifo kfifo;
+} __attribute__((aligned(8)));
+
+/* 内存区的对齐要求 */
+#define KFIFO_PERSIST_ALIGN __alignof__(struct kfifo_persist)
+
+/**
+ * KFIFO_PERSIST_BYTES - bytes needed for a persistent fifo
+ * @type: type of the fifo elements
+ * @size: number of elements in the fifo, this must be a power of 2
+ */
+#define KFIFO_PERSIST_BYTES(type, size) (sizeof(struct kfifo_persist) + sizeof(type) * (size))
+
+/**
+ * DECLARE_KFIFO_PERSIST - macro to declare a persistent fifo handle
+ * @fifo: name of the declared fifo handle
+ * @type: type of the fifo elements
+ *
+ * The handle is a pointer into the region, set up by kfifo_persist_attach().
+ * Pass it to the kfifo macros as it is, e.g. kfifo_in(fifo, buf, n). For
+ * record fifos declare a struct kfifo_rec_ptr_1/2/4 pointer instead.
+ */
+#define DECLARE_KFIFO_PERSIST(fifo, type) STRUCT_KFIFO_PTR(type) *fifo
+
+/**
+ * kfifo_persist_attach - recover or format a persistent fifo in a region
+ * @fifo: fifo handle, declared with DECLARE_KFIFO_PERSIST()
+ * @region: memory region, aligned to KFIFO_PERSIST_ALIGN
+ * @len: size of the region in bytes
+ *
+ * If the region holds a valid fifo with the same element and record size,
+ * the fifo is resumed in place with its data. Otherwise the region is
+ * formatted as an empty fifo using as much of @len as possible.
+ *
+ * Returns 1 if the fifo was recovered, 0 if it was formatted, or -EINVAL if
+ * the region is too small or misaligned (@fifo is set to NULL then).
+ */
+#define kfifo_persist_attach(fifo, region, len)                                                          \
+    ({                                                                                                   \
+        struct kfifo_persist *__region = (struct kfifo_persist *)(region);                               \
+        int __ret = __kfifo_persist_attach(__region, (len), sizeof(*(fifo)->type), kfifo_recsize(fifo)); \
+        (fifo) = __ret < 0 ? NULL : (typeof(fifo))(void *)&__region->kfifo;                              \
+        __ret;                                                                                           \
+    })
+
+/**
+ * kfifo_persist_format - discard the content of a persistent fifo
+ * @fifo: fifo handle, declared with DECLARE_KFIFO_PERSIST()
+ * @region: memory region, aligned to KFIFO_PERSIST_ALIGN
+ * @len: size of the region in bytes
+ *
+ * Same as kfifo_persist_attach() on an invalid region: always starts with an
+ * empty fifo. Returns 0 or -EINVAL.
+ */
+#define kfifo_persist_format(fifo, region, len)                                                          \
+    ({                                                                                                   \
+        struct kfifo_persist *__region = (struct kfifo_persist *)(region);                               \
+        int __ret = __kfifo_persist_format(__region, (len), sizeof(*(fifo)->type), kfifo_recsize(fifo)); \
+        (fifo) = __ret < 0 ? NULL : (typeof(fifo))(void *)&__region->kfifo;                              \
+        __ret;                                                                                           \
+    })
+
+extern int __kfifo_persist_attach(struct kfifo_persist *region, size_t len,
+                                  size_t esize, size_t recsize);
+
+extern int __kfifo_persist_format(struct kfifo_persist *region, size_t len,
+                                  size_t esize, size_t recsize);
+
+#endif /* __KFIFO_PERSIST_H__ */
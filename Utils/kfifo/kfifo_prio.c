@@ -0,0 +1,65 @@
+/**
+ * @file kfifo_prio.c
+ * @brief 多优先级 FIFO 的实现文件
+ *
+ * 位图只是 "可能非空" 的提示：写端写入数据后置位，读端读空通道后清除。两端的竞争：
+ * - 读端清除位的同时写端写入：读端清除后（完整内存屏障）重新检查通道，写端写入后
+ *   （完整内存屏障）检查位，至少有一方看到对方的修改并重新置位。
+ * - 因此位图中可能有多余的位（通道已空），但非空的通道一定有对应的位；读端遇到多余的位时清除并继续查找。
+ *
+ * @version 1.0.0
+ * @date 2026-10-16
+ * @author Jia Zhenyu
+ */
+
+#include "kfifo_prio.h"
+
+int __kfifo_prio_init(struct __kfifo_prio *fifo, struct __kfifo *lanes,
+                      unsigned int nlanes, void *buffer,
+                      unsigned int size, size_t esize)
+{
+    unsigned int i;
+
+    atomic_init(&fifo->ready, 0);
+    fifo->lanes = lanes;
+    fifo->nlanes = 0;
+
+    if (nlanes == 0 || nlanes > KFIFO_PRIO_MAX)
+        return -EINVAL;
+
+    for (i = 0; i < nlanes; i++)
+    {
+        if (__kfifo_init(&lanes[i], (unsigned char *)buffer + i * size, size, esize))
+            return -EINVAL;
+    }
+    fifo->nlanes = nlanes;
+    return 0;
+}
+
+int __kfifo_prio_first(struct __kfifo_prio *fifo)
+{
+    unsigned int ready, prio;
+
+    while ((ready = atomic_load_explicit(&fifo->ready, memory_order_acquire)) != 0)
+    {
+        prio = __builtin_clz(ready);
+        if (__kfifo_used(&fifo->lanes[prio], 1))
+            return prio;
+
+        /* the lane was drained through kfifo.h or the bit is left over */
+        __kfifo_prio_idle(fifo, prio);
+    }
+    return -1;
+}
+
+void __kfifo_prio_idle(struct __kfifo_prio *fifo, unsigned int prio)
+{
+    unsigned int bit = KFIFO_PRIO_BIT(prio);
+
+    atomic_fetch_and_explicit(&fifo->ready, ~bit, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    /* the writer may have put data before it could see the cleared bit */
+    if (__kfifo_used(&fifo->lanes[prio], 1))
+        atomic_fetch_or_explicit(&fifo->ready, bit, memory_order_relaxed);
+}
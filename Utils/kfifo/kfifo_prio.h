@@ -0,0 +1,221 @@
+/**
+ * @file kfifo_prio.h
+ * @brief 多优先级 FIFO：一组 kfifo 通道加非空位图
+ *
+ * 事件队列和命令队列都是严格先进先出的，紧急命令只能排在大批量数据后面。优先级 FIFO 由
+ * `nlanes` 个普通 kfifo 通道组成（优先级 0 最高），另有一个非空位图，优先级 p 对应位 `31 - p`：
+ * - 写入：数据写入对应优先级的通道（就是 `kfifo_put` / `kfifo_in`），再置位图中的位。
+ * - 读取：`__builtin_clz(位图)` 直接得到最高的非空优先级，与通道数无关，O(1)；
+ *   读空一个通道后清除对应的位。
+ *
+ * 每个通道是一读一写的 kfifo，写入无锁；位图由写端置位、读端清除，两端使用原子或/与操作，
+ * 清除后读端重新检查通道，写端置位前检查位图（两端之间有完整的内存屏障），不会漏掉刚写入的数据。
+ *
+ * 每个通道都是 `STRUCT_KFIFO_PTR(type)`，读端也可以直接对 `&fifo.lanes[p]` 使用 `kfifo.h` 的宏
+ * （例如 `kfifo_len`、`kfifo_out_linear_ptr`）；写端必须通过本文件的宏写入，否则位图不会更新。
+ *
+ * 注意事项：
+ * - 最多 32 个优先级，每个通道的大小相同，必须为 2 的幂。
+ * - 一个写者、一个读者时无需加锁；多个写者需要自行互斥（或每个优先级只有一个写者）。
+ * - 依赖 C11 `stdatomic.h` 的原子或/与操作，需要使用 `gnu11` 编译；Cortex-M0/M0+ 没有
+ *   LDREX/STREX 指令，GCC 会调用 libatomic（关中断实现）。
+ *
+ * @version 1.0.0
+ * @date 2026-10-16
+ * @author Jia Zhenyu
+ */
+
+#ifndef __KFIFO_PRIO_H__
+#define __KFIFO_PRIO_H__
+
+#include <stdatomic.h>
+#include "kfifo.h"
+
+#define KFIFO_PRIO_MAX 32 // 最大优先级数，等于位图的位数
+
+/* 优先级 p 在位图中对应的位，clz 的结果就是优先级 */
+#define KFIFO_PRIO_BIT(p) (0x80000000U >> (p))
+
+struct __kfifo_prio
+{
+    _Atomic unsigned int ready; // 非空位图，写端置位，读端清除
+    unsigned int nlanes;
+    struct __kfifo *lanes;
+};
+
+#define __STRUCT_KFIFO_PRIO(type, size, nlanes)                                                    \
+    {                                                                                              \
+        union                                                                                      \
+        {                                                                                          \
+            struct __kfifo_prio kfifo;                                                             \
+            type *type;                                                                            \
+            const type *const_type;                                                                \
+        };                                                                                         \
+        STRUCT_KFIFO_PTR(type) lanes[((nlanes) < 1 || (nlanes) > KFIFO_PRIO_MAX) ? -1 : (nlanes)]; \
+        type buf[nlanes][((size < 2) || (size & (size - 1))) ? -1 : size];                         \
+    }
+
+#define STRUCT_KFIFO_PRIO(type, size, nlanes) \
+    struct __STRUCT_KFIFO_PRIO(type, size, nlanes)
+
+/**
+ * DECLARE_KFIFO_PRIO - macro to declare a priority fifo object
+ * @fifo: name of the declared fifo
+ * @type: type of the fifo elements
+ * @size: the number of elements in each lane, this must be a power of 2
+ * @nlanes: the number of priorities, 0 is the highest (at most 32)
+ */
+#define DECLARE_KFIFO_PRIO(fifo, type, size, nlanes) STRUCT_KFIFO_PRIO(type, size, nlanes) fifo
+
+/**
+ * INIT_KFIFO_PRIO - Initialize a fifo declared by DECLARE_KFIFO_PRIO
+ * @fifo: name of the declared fifo datatype
+ *
+ * Must be called before the writer or the reader uses the fifo.
+ */
+#define INIT_KFIFO_PRIO(fifo)                                                              \
+    (void)({                                                                               \
+        typeof(&(fifo)) __tmp = &(fifo);                                                   \
+        (void)sizeof(char[sizeof(__tmp->lanes[0]) == sizeof(struct __kfifo) ? 1 : -1]);    \
+        __kfifo_prio_init(&__tmp->kfifo, &__tmp->lanes[0].kfifo, ARRAY_SIZE(__tmp->lanes), \
+                          __tmp->buf, sizeof(__tmp->buf[0]), sizeof(__tmp->buf[0][0]));    \
+    })
+
+/**
+ * kfifo_prio_lanes - returns the number of priorities
+ * @fifo: address of the fifo to be used
+ */
+#define kfifo_prio_lanes(fifo) ((fifo)->kfifo.nlanes)
+
+/**
+ * kfifo_prio_is_empty - returns true if no lane holds data
+ * @fifo: address of the fifo to be used
+ *
+ * Only the reader gets an exact result, for the writer it is a snapshot.
+ */
+#define kfifo_prio_is_empty(fifo) (__kfifo_prio_first(&(fifo)->kfifo) < 0)
+
+/**
+ * kfifo_prio_put - put data into a lane of the fifo
+ * @fifo: address of the fifo to be used
+ * @prio: the priority, 0 is the highest
+ * @val: the data to be added
+ *
+ * It returns 0 if the lane was full. Otherwise it returns the number
+ * processed elements.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo_prio_put(fifo, prio, val)                                  \
+    ({                                                                   \
+        typeof((fifo) + 1) ___tmp = (fifo);                              \
+        unsigned int ___prio = (prio);                                   \
+        unsigned int ___ret = kfifo_put(&___tmp->lanes[___prio], (val)); \
+        if (___ret)                                                      \
+            __kfifo_prio_post(&___tmp->kfifo, ___prio);                  \
+        ___ret;                                                          \
+    })
+
+/**
+ * kfifo_prio_in - put data into a lane of the fifo
+ * @fifo: address of the fifo to be used
+ * @prio: the priority, 0 is the highest
+ * @buf: the data to be added
+ * @n: number of elements to be added
+ *
+ * This macro copies the given buffer into lane @prio and returns the
+ * number of copied elements.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo_prio_in(fifo, prio, buf, n)                                    \
+    ({                                                                       \
+        typeof((fifo) + 1) ___tmp = (fifo);                                  \
+        unsigned int ___prio = (prio);                                       \
+        unsigned int ___ret = kfifo_in(&___tmp->lanes[___prio], (buf), (n)); \
+        if (___ret)                                                          \
+            __kfifo_prio_post(&___tmp->kfifo, ___prio);                      \
+        ___ret;                                                              \
+    })
+
+/**
+ * kfifo_prio_get - get the most urgent element from the fifo
+ * @fifo: address of the fifo to be used
+ * @val: address where to store the data
+ * @prio: address where to store the priority of the data, may be NULL
+ *
+ * This macro reads the oldest element of the highest priority lane which
+ * holds data. It returns 0 if the fifo was empty. Otherwise it returns the
+ * number processed elements.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo_prio_get(fifo, val, prio) kfifo_prio_out(fifo, val, 1, prio)
+
+/**
+ * kfifo_prio_out - get data of the most urgent lane from the fifo
+ * @fifo: address of the fifo to be used
+ * @buf: pointer to the storage buffer
+ * @n: max. number of elements to get
+ * @prio: address where to store the priority of the data, may be NULL
+ *
+ * This macro copies up to @n elements from the highest priority lane which
+ * holds data, all of them have the same priority. It returns the number of
+ * copied elements, 0 if the fifo was empty.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo_prio_out(fifo, buf, n, prio)                               \
+    __kfifo_uint_must_check_helper(                                      \
+        ({                                                               \
+            typeof((fifo) + 1) ___tmp = (fifo);                          \
+            int ___prio = __kfifo_prio_first(&___tmp->kfifo);            \
+            unsigned int *___p = (prio);                                 \
+            unsigned int ___ret = 0;                                     \
+            if (___prio >= 0)                                            \
+            {                                                            \
+                ___ret = kfifo_out(&___tmp->lanes[___prio], (buf), (n)); \
+                __kfifo_prio_consumed(&___tmp->kfifo, ___prio);          \
+                if (___p)                                                \
+                    *___p = ___prio;                                     \
+            }                                                            \
+            ___ret;                                                      \
+        }))
+
+extern int __kfifo_prio_init(struct __kfifo_prio *fifo, struct __kfifo *lanes,
+                             unsigned int nlanes, void *buffer,
+                             unsigned int size, size_t esize);
+
+extern int __kfifo_prio_first(struct __kfifo_prio *fifo);
+
+extern void __kfifo_prio_idle(struct __kfifo_prio *fifo, unsigned int prio);
+
+/*
+ * internal helper for the writer, after data was put into lane @prio.
+ * The fence orders the new in index before the load of the bitmap: either
+ * the reader sees the data after it cleared the bit, or the writer sees the
+ * cleared bit and sets it again.
+ */
+static inline void __kfifo_prio_post(struct __kfifo_prio *fifo, unsigned int prio)
+{
+    unsigned int bit = KFIFO_PRIO_BIT(prio);
+
+    atomic_thread_fence(memory_order_seq_cst);
+    if (!(atomic_load_explicit(&fifo->ready, memory_order_relaxed) & bit))
+        atomic_fetch_or_explicit(&fifo->ready, bit, memory_order_release);
+}
+
+/*
+ * internal helper for the reader, after data was taken from lane @prio
+ */
+static inline void __kfifo_prio_consumed(struct __kfifo_prio *fifo, unsigned int prio)
+{
+    if (!__kfifo_used(&fifo->lanes[prio], 1))
+        __kfifo_prio_idle(fifo, prio);
+}
+
+#endif /* __KFIFO_PRIO_H__ */
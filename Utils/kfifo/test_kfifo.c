@@ -1,7 +1,12 @@
 /*
  * test_kfifo.c
  * Comprehensive tests for kfifo (static + dynamic, element sizes, wrap,
- * out_linear_ptr, full/empty behaviour).
+ * out_linear_ptr, in_linear_ptr, full/empty behaviour, records with 1 and
+ * 4 byte headers).
+ *
+ * Build (Linux), also with -DKFIFO_SMP for the atomic backend and
+ * -DKFIFO_OVERWRITE for the overwrite mode:
+ *   gcc -std=gnu11 test_kfifo.c kfifo.c -o test_kfifo
  */
 
 #include <stdio.h>
@@ -9,6 +14,8 @@
 #include <string.h>
 #include <stdint.h>
 #include <assert.h>
+#include <unistd.h>
+#include <sys/uio.h>
 #include "kfifo.h"
 
 static int failures = 0;
@@ -115,6 +122,54 @@ static void test_out_linear_ptr(void)
     ok("test_out_linear_ptr");
 }
 
+static void test_in_linear_ptr(void)
+{
+    DECLARE_KFIFO(fifo, unsigned char, 8);
+    INIT_KFIFO(fifo);
+
+    unsigned char *ptr = NULL;
+    unsigned char out[8];
+    unsigned int n, ret;
+
+    /* move in/out to offset 6 so that the free space wraps */
+    unsigned char pre[6] = {0};
+    ret = kfifo_in(&fifo, pre, sizeof(pre));
+    ret = kfifo_out(&fifo, out, ret);
+    if (ret != sizeof(pre)) { fail("in_linear_ptr: prepare"); return; }
+
+    /* first reservation stops at the buffer end */
+    n = kfifo_in_linear_ptr(&fifo, &ptr, 8);
+    if (n != 2 || ptr != &fifo.buf[6]) { fail("in_linear_ptr: first span"); return; }
+    ptr[0] = 30;
+    ptr[1] = 31;
+
+    /* nothing is visible before commit */
+    if (!kfifo_is_empty(&fifo)) { fail("in_linear_ptr: visible before commit"); return; }
+    kfifo_in_commit(&fifo, n);
+
+    /* second reservation continues at the buffer start */
+    n = kfifo_in_linear_ptr(&fifo, &ptr, 8);
+    if (n != 6 || ptr != &fifo.buf[0]) { fail("in_linear_ptr: second span"); return; }
+    for (unsigned int i = 0; i < 3; i++)
+        ptr[i] = (unsigned char)(32 + i);
+    kfifo_in_commit(&fifo, 3);
+
+    if (kfifo_len(&fifo) != 5) { fail("in_linear_ptr: len"); return; }
+    if (kfifo_avail(&fifo) != 3) { fail("in_linear_ptr: avail"); return; }
+
+    ret = kfifo_out(&fifo, out, sizeof(out));
+    if (ret != 5) { fail("in_linear_ptr: out count"); return; }
+    for (unsigned int i = 0; i < 5; i++)
+        if (out[i] != 30 + i) { fail("in_linear_ptr: data mismatch"); return; }
+
+    /* full fifo reserves nothing */
+    unsigned char fill[8] = {0};
+    ret = kfifo_in(&fifo, fill, sizeof(fill));
+    if (kfifo_in_linear_ptr(&fifo, &ptr, 1) != 0) { fail("in_linear_ptr: full"); return; }
+
+    ok("test_in_linear_ptr");
+}
+
 static void test_full_empty(void)
 {
     DECLARE_KFIFO(fifo, unsigned char, 4);
@@ -137,6 +192,31 @@ static void test_full_empty(void)
     ok("test_full_empty");
 }
 
+/* under KFIFO_SMP the reader's cached in index must follow kfifo_reset_out */
+static void test_reset_out(void)
+{
+    DECLARE_KFIFO(fifo, uint8_t, 8);
+    INIT_KFIFO(fifo);
+
+    uint8_t c, out[8];
+
+    kfifo_put(&fifo, 1);
+    if (!kfifo_get(&fifo, &c)) { fail("reset_out: get"); return; }
+    kfifo_put(&fifo, 2);
+    kfifo_put(&fifo, 3);
+    kfifo_reset_out(&fifo);
+
+    if (kfifo_len(&fifo) != 0) { fail("reset_out: len"); return; }
+    if (kfifo_get(&fifo, &c)) { fail("reset_out: get after reset"); return; }
+    if (kfifo_out(&fifo, out, sizeof(out)) != 0) { fail("reset_out: out after reset"); return; }
+
+    kfifo_put(&fifo, 4);
+    if (!kfifo_get(&fifo, &c) || c != 4) { fail("reset_out: get after put"); return; }
+    if (!kfifo_is_empty(&fifo)) { fail("reset_out: should be empty"); return; }
+
+    ok("test_reset_out");
+}
+
 static void test_struct_frame(void)
 {
     typedef struct {
@@ -296,6 +376,712 @@ static void test_struct_frame_r(void)
     ok("test_struct_frame_r");
 }
 
+/* readv()/writev() on a pipe stand in for the DMA engine */
+static int seg_to_iov(struct iovec *iov, const struct kfifo_dma_seg *seg, unsigned int n)
+{
+    for (unsigned int i = 0; i < n; i++)
+    {
+        iov[i].iov_base = seg[i].addr;
+        iov[i].iov_len = seg[i].len;
+    }
+    return (int)n;
+}
+
+static void test_dma_pipe(void)
+{
+    DECLARE_KFIFO(fifo, uint16_t, 8);
+    INIT_KFIFO(fifo);
+
+    struct kfifo_dma_seg seg[2];
+    struct iovec iov[2];
+    uint16_t src[6] = {100, 101, 102, 103, 104, 105};
+    uint16_t dst[6] = {0};
+    uint16_t tmp[5];
+    unsigned int n, ret;
+    int fds[2];
+
+    if (pipe(fds)) { fail("dma_pipe: pipe"); return; }
+
+    /* move in/out to offset 5 so that a 6 element transfer wraps */
+    ret = kfifo_in(&fifo, tmp, 5);
+    ret = kfifo_out(&fifo, tmp, ret);
+    if (ret != 5) { fail("dma_pipe: prepare"); goto out; }
+
+    /* "DMA" from the pipe into the fifo */
+    if (write(fds[1], src, sizeof(src)) != sizeof(src)) { fail("dma_pipe: feed"); goto out; }
+    n = kfifo_dma_in_prepare(&fifo, seg, 2, 6);
+    if (n != 2 || seg[0].len != 3 * sizeof(uint16_t) || seg[1].len != 3 * sizeof(uint16_t)) { fail("dma_pipe: in segments"); goto out; }
+    if (readv(fds[0], iov, seg_to_iov(iov, seg, n)) != sizeof(src)) { fail("dma_pipe: readv"); goto out; }
+    if (!kfifo_is_empty(&fifo)) { fail("dma_pipe: visible before finish"); goto out; }
+    kfifo_dma_in_finish(&fifo, 6);
+    if (kfifo_len(&fifo) != 6) { fail("dma_pipe: len after in"); goto out; }
+
+    /* "DMA" from the fifo into the pipe */
+    n = kfifo_dma_out_prepare(&fifo, seg, 2, 8);
+    if (n != 2) { fail("dma_pipe: out segments"); goto out; }
+    if (writev(fds[1], iov, seg_to_iov(iov, seg, n)) != sizeof(src)) { fail("dma_pipe: writev"); goto out; }
+    kfifo_dma_out_finish(&fifo, 6);
+    if (!kfifo_is_empty(&fifo)) { fail("dma_pipe: not empty after out"); goto out; }
+
+    if (read(fds[0], dst, sizeof(dst)) != sizeof(dst)) { fail("dma_pipe: drain"); goto out; }
+    if (memcmp(src, dst, sizeof(src)) != 0) { fail("dma_pipe: data mismatch"); goto out; }
+
+    /* nothing to describe on an empty fifo */
+    if (kfifo_dma_out_prepare(&fifo, seg, 2, 8) != 0) { fail("dma_pipe: empty out"); goto out; }
+
+    ok("test_dma_pipe");
+out:
+    close(fds[0]);
+    close(fds[1]);
+}
+
+static void test_dma_record(void)
+{
+    STRUCT_KFIFO_REC_1(16) rfifo;
+    INIT_KFIFO(rfifo);
+
+    struct kfifo_dma_seg seg[2];
+    const unsigned char rec[5] = {1, 2, 3, 4, 5};
+    unsigned char out[12] = {0};
+    unsigned int n, ret;
+
+    /* move in/out to offset 13 so that the record payload wraps */
+    ret = kfifo_in(&rfifo, out, 12);
+    ret = kfifo_out(&rfifo, out, ret);
+    if (ret != 12) { fail("dma_record: prepare"); return; }
+
+    n = kfifo_dma_in_prepare(&rfifo, seg, 2, 5);
+    if (n == 0) { fail("dma_record: in prepare"); return; }
+    for (unsigned int i = 0, k = 0; i < n; i++)
+        for (size_t j = 0; j < seg[i].len; j++)
+            ((unsigned char *)seg[i].addr)[j] = rec[k++];
+    kfifo_dma_in_finish(&rfifo, 5);
+
+    if (kfifo_peek_len(&rfifo) != 5) { fail("dma_record: peek_len"); return; }
+
+    n = kfifo_dma_out_prepare(&rfifo, seg, 2, 16);
+    if (n != 2 || seg[0].len != 2 || seg[1].len != 3) { fail("dma_record: out segments"); return; }
+    memcpy(out, seg[0].addr, seg[0].len);
+    memcpy(out + seg[0].len, seg[1].addr, seg[1].len);
+    if (memcmp(out, rec, 5) != 0) { fail("dma_record: data mismatch"); return; }
+    kfifo_dma_out_finish(&rfifo, 5);
+    if (!kfifo_is_empty(&rfifo)) { fail("dma_record: not empty"); return; }
+
+    ok("test_dma_record");
+}
+
+static void test_record_4(void)
+{
+    STRUCT_KFIFO_REC_4(64) rfifo;
+    INIT_KFIFO(rfifo);
+
+    struct msg { uint32_t id; uint16_t val[3]; } m = {0x12345678, {1, 2, 3}}, *pm;
+    unsigned char rec[32], out[32], *p;
+    unsigned int ret;
+
+    for (unsigned int i = 0; i < sizeof(rec); i++)
+        rec[i] = (unsigned char)i;
+
+    /* 16 + 24 + 24 bytes: the fifo is full */
+    ret = kfifo_in(&rfifo, &m, sizeof(m));
+    ret += kfifo_in(&rfifo, rec, 20);
+    ret += kfifo_in(&rfifo, rec, 20);
+    if (ret != sizeof(m) + 40 || kfifo_in(&rfifo, rec, 1) != 0) { fail("record_4: in"); return; }
+
+    /* access the struct in place */
+    ret = kfifo_peek_record_ptr(&rfifo, &pm);
+    if (ret != sizeof(m) || ((uintptr_t)pm & 3) || pm->id != m.id || pm->val[2] != 3) { fail("record_4: peek ptr"); return; }
+    kfifo_skip(&rfifo);
+
+    ret = kfifo_out(&rfifo, out, sizeof(out));
+    if (ret != 20 || memcmp(out, rec, 20) != 0) { fail("record_4: out"); return; }
+    ret = kfifo_out(&rfifo, out, sizeof(out));
+    if (ret != 20 || !kfifo_is_empty(&rfifo)) { fail("record_4: empty"); return; }
+
+    /* header at offset 52, the record does not fit till the end: skip marker */
+    ret = kfifo_in(&rfifo, rec, 28);
+    ret = kfifo_out(&rfifo, out, ret);
+    ret = kfifo_in(&rfifo, rec, 16);
+    ret = kfifo_out(&rfifo, out, ret);
+    ret = kfifo_in(&rfifo, rec + 4, 12);
+    if (ret != 12 || kfifo_len(&rfifo) != 12 + 16) { fail("record_4: wrap in"); return; }
+    ret = kfifo_peek_record_ptr(&rfifo, &p);
+    if (ret != 12 || p != rfifo.buf + 4 || memcmp(p, rec + 4, 12) != 0) { fail("record_4: wrap ptr"); return; }
+    kfifo_skip(&rfifo);
+    if (!kfifo_is_empty(&rfifo)) { fail("record_4: wrap skip"); return; }
+
+    /* records are limited to half the buffer */
+    if (kfifo_in(&rfifo, rec, 29) != 0 || kfifo_in(&rfifo, rec, 28) != 28) { fail("record_4: max"); return; }
+
+    ok("test_record_4");
+}
+
+static void test_record_4_wrap(void)
+{
+    struct kfifo_rec_ptr_4 rfifo;
+    STRUCT_KFIFO_REC_4(32) ofifo;
+    INIT_KFIFO(ofifo);
+
+    struct kfifo_dma_seg seg[2];
+    unsigned char rec[32], out[32], *p;
+    unsigned int i, n, ret;
+
+    for (i = 0; i < sizeof(rec); i++)
+        rec[i] = (unsigned char)i;
+
+    /* reader lags behind by 2 records, lengths 0..12 */
+    if (kfifo_alloc(&rfifo, 64)) { fail("record_4_wrap: alloc"); return; }
+    for (i = 0; i < 300; i++)
+    {
+        memset(rec, (int)i, sizeof(rec));
+        if (kfifo_in(&rfifo, rec, i % 13) != i % 13) { fail("record_4_wrap: in"); goto out; }
+        if (i < 2)
+            continue;
+        n = kfifo_peek_record_ptr(&rfifo, &p);
+        if (n != (i - 2) % 13 || ((uintptr_t)p & 3) || (n && (p[0] != (unsigned char)(i - 2) || p[n - 1] != (unsigned char)(i - 2))))
+        {
+            fail("record_4_wrap: out");
+            goto out;
+        }
+        kfifo_skip(&rfifo);
+    }
+
+#ifdef KFIFO_OVERWRITE
+    /* overwrite: 12 byte records take 16 bytes, the fifo holds two */
+    for (i = 0; i < 3; i++)
+        ret = kfifo_in_overwrite(&ofifo, rec, 12);
+    if (kfifo_discarded(&ofifo) != 1) { fail("record_4_wrap: overwrite"); goto out; }
+    ret = kfifo_in_overwrite(&ofifo, rec, 4);
+    ret = kfifo_in_overwrite(&ofifo, rec, 8);
+    if (ret != 8 || kfifo_discarded(&ofifo) != 3) { fail("record_4_wrap: overwrite wrap"); goto out; }
+    if (kfifo_out(&ofifo, out, sizeof(out)) != 4 || kfifo_out(&ofifo, out, sizeof(out)) != 8) { fail("record_4_wrap: overwrite out"); goto out; }
+#else /* KFIFO_OVERWRITE */
+    /* same indices as after the overwrite sequence: in = out = 12 */
+    ret = kfifo_in(&ofifo, rec, 8);
+    if (kfifo_out(&ofifo, out, sizeof(out)) != 8) { fail("record_4_wrap: position"); goto out; }
+#endif /* KFIFO_OVERWRITE */
+
+    /* dma: header at offset 24, the payload goes to the buffer begin */
+    ret = kfifo_in(&ofifo, rec, 8);
+    ret = kfifo_out(&ofifo, out, ret);
+    n = kfifo_dma_in_prepare(&ofifo, seg, 2, 8);
+    if (n != 1 || seg[0].addr != ofifo.buf + 4 || seg[0].len != 8) { fail("record_4_wrap: dma in"); goto out; }
+    memcpy(seg[0].addr, rec, 8);
+    kfifo_dma_in_finish(&ofifo, 8);
+    if (kfifo_peek_len(&ofifo) != 8) { fail("record_4_wrap: dma peek_len"); goto out; }
+    n = kfifo_dma_out_prepare(&ofifo, seg, 2, 32);
+    if (n != 1 || seg[0].addr != ofifo.buf + 4 || seg[0].len != 8) { fail("record_4_wrap: dma out"); goto out; }
+    kfifo_dma_out_finish(&ofifo, 8);
+    if (!kfifo_is_empty(&ofifo)) { fail("record_4_wrap: dma empty"); goto out; }
+
+    ok("test_record_4_wrap");
+out:
+    kfifo_free(&rfifo);
+}
+
+static void test_record_4_init(void)
+{
+    struct kfifo_rec_ptr_4 rfifo;
+    uint32_t buf[9];
+
+    /* the 4 byte headers need an aligned buffer of a multiple of 4 bytes */
+    if (kfifo_init(&rfifo, (unsigned char *)buf + 2, 16) != -EINVAL) { fail("record_4_init: misaligned"); return; }
+    if (kfifo_init(&rfifo, buf, 2) != -EINVAL || kfifo_alloc(&rfifo, 2) != -EINVAL) { fail("record_4_init: size 2"); return; }
+    if (kfifo_init(&rfifo, buf, sizeof(buf)) != 0 || kfifo_size(&rfifo) != 32) { fail("record_4_init: init"); return; }
+#ifdef KFIFO_NPOT
+    if (kfifo_alloc_npot(&rfifo, 3002) != -EINVAL || rfifo.kfifo.data != NULL) { fail("record_4_init: alloc_npot"); return; }
+    if (kfifo_init_npot(&rfifo, buf, 34) != -EINVAL) { fail("record_4_init: init_npot"); return; }
+    if (kfifo_init_npot(&rfifo, buf, sizeof(buf)) != 0 || kfifo_size(&rfifo) != 36) { fail("record_4_init: npot"); return; }
+    if (kfifo_alloc_npot(&rfifo, 3000) != 0) { fail("record_4_init: alloc_npot 3000"); return; }
+    kfifo_free(&rfifo);
+#endif /* KFIFO_NPOT */
+
+    ok("test_record_4_init");
+}
+
+static void test_out_records(void)
+{
+    STRUCT_KFIFO_REC_1(64) rfifo;
+    struct kfifo_rec_ptr_4 r4fifo;
+    INIT_KFIFO(rfifo);
+
+    unsigned char rec[16], buf[32];
+    unsigned int lens[8];
+    unsigned int i, ret;
+
+    for (i = 0; i < sizeof(rec); i++)
+        rec[i] = (unsigned char)i;
+
+    /* 5 records of 1..5 bytes, buf holds the first 4 (10 bytes) */
+    for (i = 1; i <= 5; i++)
+        ret = kfifo_in(&rfifo, rec, i);
+    if (kfifo_out_records(&rfifo, buf, 12, lens, 8) != 4) { fail("out_records: count"); return; }
+    if (lens[0] != 1 || lens[3] != 4 || memcmp(buf + 6, rec, 4) != 0) { fail("out_records: data"); return; }
+    if (kfifo_peek_len(&rfifo) != 5) { fail("out_records: rest"); return; }
+
+    /* limited by max */
+    ret = kfifo_in(&rfifo, rec, 3);
+    if (kfifo_out_records(&rfifo, buf, sizeof(buf), lens, 1) != 1 || lens[0] != 5) { fail("out_records: max"); return; }
+    if (kfifo_out_records(&rfifo, buf, sizeof(buf), lens, 8) != 1 || lens[0] != 3) { fail("out_records: last"); return; }
+    if (kfifo_out_records(&rfifo, buf, sizeof(buf), lens, 8) != 0) { fail("out_records: empty"); return; }
+
+    /* a first record larger than buf is truncated */
+    ret = kfifo_in(&rfifo, rec, 16);
+    if (kfifo_out_records(&rfifo, buf, 8, lens, 8) != 1 || lens[0] != 8 || !kfifo_is_empty(&rfifo)) { fail("out_records: truncate"); return; }
+
+    /* records with 4 byte header across the skip marker */
+    if (kfifo_alloc(&r4fifo, 32)) { fail("out_records: alloc"); return; }
+    ret = kfifo_in(&r4fifo, rec, 12);
+    ret = kfifo_out(&r4fifo, buf, ret);
+    ret = kfifo_in(&r4fifo, rec, 2);
+    ret = kfifo_in(&r4fifo, rec + 4, 8);
+    if (kfifo_out_records(&r4fifo, buf, sizeof(buf), lens, 8) != 2 || lens[1] != 8 || memcmp(buf + 2, rec + 4, 8) != 0 ||
+        !kfifo_is_empty(&r4fifo))
+        fail("out_records: record_4");
+    else
+        ok("test_out_records");
+    kfifo_free(&r4fifo);
+}
+
+static void test_peek_at_find(void)
+{
+    DECLARE_KFIFO(fifo, unsigned char, 16);
+    INIT_KFIFO(fifo);
+
+    const unsigned char line[] = "AT+OK\r\nAT";
+    unsigned char buf[16];
+    unsigned int ret;
+    int pos;
+
+    /* move in/out to offset 12 so that the data wraps */
+    ret = kfifo_in(&fifo, buf, 12);
+    ret = kfifo_out(&fifo, buf, ret);
+    ret = kfifo_in(&fifo, line, 9);
+    if (ret != 9) { fail("peek_at_find: in"); return; }
+
+    pos = kfifo_find_byte(&fifo, '\n', 0);
+    if (pos != 6) { fail("peek_at_find: find wrapped"); return; }
+    if (kfifo_find_byte(&fifo, 'A', 1) != 7 || kfifo_find_byte(&fifo, 'A', 0) != 0) { fail("peek_at_find: find start"); return; }
+    if (kfifo_find_byte(&fifo, 'X', 0) != -1 || kfifo_find_byte(&fifo, 'A', 9) != -1) { fail("peek_at_find: not found"); return; }
+
+    /* header byte at offset k, then the rest across the wrap */
+    ret = kfifo_peek_at(&fifo, 2, buf, 1);
+    if (ret != 1 || buf[0] != '+') { fail("peek_at_find: peek byte"); return; }
+    ret = kfifo_peek_at(&fifo, 3, buf, sizeof(buf));
+    if (ret != 6 || memcmp(buf, line + 3, 6) != 0) { fail("peek_at_find: peek wrap"); return; }
+    if (kfifo_peek_at(&fifo, 9, buf, 1) != 0 || kfifo_len(&fifo) != 9) { fail("peek_at_find: peek end"); return; }
+
+    /* copy out the complete line only */
+    ret = kfifo_out(&fifo, buf, pos + 1);
+    if (ret != 7 || memcmp(buf, line, 7) != 0 || kfifo_find_byte(&fifo, '\n', 0) != -1) { fail("peek_at_find: line"); return; }
+
+    ok("test_peek_at_find");
+}
+
+#ifdef KFIFO_OVERWRITE
+static void test_overwrite(void)
+{
+    DECLARE_KFIFO(fifo, int, 4);
+    INIT_KFIFO(fifo);
+
+    int in[6] = {1, 2, 3, 4, 5, 6};
+    int out[4] = {0};
+    unsigned int ret;
+
+    for (int i = 0; i < 6; i++)
+        if (kfifo_put_overwrite(&fifo, in[i]) != 1) { fail("overwrite: put"); return; }
+    if (kfifo_discarded(&fifo) != 2) { fail("overwrite: put discarded"); return; }
+    ret = kfifo_out(&fifo, out, 4);
+    if (ret != 4 || memcmp(out, in + 2, 4 * sizeof(int)) != 0) { fail("overwrite: put data"); return; }
+
+    /* partially full, then more than the fifo size in one call */
+    ret = kfifo_in(&fifo, in, 3);
+    ret = kfifo_in_overwrite(&fifo, in, 6);
+    if (ret != 4 || kfifo_discarded(&fifo) != 2 + 3 + 2) { fail("overwrite: in discarded"); return; }
+    ret = kfifo_out(&fifo, out, 4);
+    if (ret != 4 || memcmp(out, in + 2, 4 * sizeof(int)) != 0) { fail("overwrite: in data"); return; }
+
+    kfifo_reset(&fifo);
+    if (kfifo_discarded(&fifo) != 0) { fail("overwrite: reset"); return; }
+
+    ok("test_overwrite");
+}
+
+static void test_overwrite_record(void)
+{
+    STRUCT_KFIFO_REC_1(16) rfifo;
+    INIT_KFIFO(rfifo);
+
+    const unsigned char a[4] = {1, 1, 1, 1}, b[5] = {2, 2, 2, 2, 2}, c[6] = {3, 3, 3, 3, 3, 3};
+    unsigned char out[16];
+    unsigned int ret;
+
+    /* 5 + 6 bytes used, c needs 7: drop only a */
+    ret = kfifo_in_overwrite(&rfifo, a, sizeof(a));
+    ret += kfifo_in_overwrite(&rfifo, b, sizeof(b));
+    ret += kfifo_in_overwrite(&rfifo, c, sizeof(c));
+    if (ret != 15 || kfifo_discarded(&rfifo) != 1) { fail("overwrite_record: discarded"); return; }
+
+    ret = kfifo_out(&rfifo, out, sizeof(out));
+    if (ret != 5 || memcmp(out, b, 5) != 0) { fail("overwrite_record: first"); return; }
+    ret = kfifo_out(&rfifo, out, sizeof(out));
+    if (ret != 6 || memcmp(out, c, 6) != 0) { fail("overwrite_record: second"); return; }
+
+    /* larger than the fifo: rejected, nothing dropped */
+    ret = kfifo_in_overwrite(&rfifo, a, sizeof(a));
+    if (kfifo_in_overwrite(&rfifo, out, 16) != 0 || kfifo_discarded(&rfifo) != 1) { fail("overwrite_record: too large"); return; }
+    if (kfifo_peek_len(&rfifo) != 4) { fail("overwrite_record: kept"); return; }
+
+    ok("test_overwrite_record");
+}
+#endif /* KFIFO_OVERWRITE */
+
+#ifdef KFIFO_NPOT
+static void test_npot(void)
+{
+    DECLARE_KFIFO_PTR(fifo, uint16_t);
+    uint16_t buffer[7], in[5], out[5], v;
+    unsigned int i, lap, ret;
+    struct kfifo_dma_seg seg[2];
+
+    if (kfifo_init_npot(&fifo, buffer, sizeof(buffer))) { fail("npot: init"); return; }
+    if (kfifo_size(&fifo) != 7) { fail("npot: size"); return; }
+
+    /* many laps so that in/out wrap at 2 * size several times */
+    for (lap = 0; lap < 20; lap++)
+    {
+        for (i = 0; i < 5; i++)
+            in[i] = (uint16_t)(lap * 5 + i);
+        ret = kfifo_in(&fifo, in, 5);
+        if (ret != 5 || kfifo_len(&fifo) != 5 || kfifo_avail(&fifo) != 2) { fail("npot: in"); return; }
+        ret = kfifo_out(&fifo, out, 5);
+        if (ret != 5 || memcmp(in, out, sizeof(in)) != 0) { fail("npot: out"); return; }
+    }
+
+    for (i = 0; i < 7; i++)
+        if (!kfifo_put(&fifo, (uint16_t)i)) { fail("npot: put"); return; }
+    if (!kfifo_is_full(&fifo) || kfifo_put(&fifo, 7)) { fail("npot: full"); return; }
+
+    /* used data wraps: two dma segments covering 7 elements */
+    ret = kfifo_dma_out_prepare(&fifo, seg, 2, 7);
+    if (ret != 2 || seg[0].len + seg[1].len != 7 * sizeof(uint16_t)) { fail("npot: dma out"); return; }
+
+    for (i = 0; i < 7; i++)
+        if (!kfifo_get(&fifo, &v) || v != i) { fail("npot: get"); return; }
+    if (!kfifo_is_empty(&fifo)) { fail("npot: empty"); return; }
+
+#ifdef KFIFO_OVERWRITE
+    for (i = 0; i < 9; i++)
+        ret = kfifo_put_overwrite(&fifo, (uint16_t)i);
+    if (kfifo_discarded(&fifo) != 2 || !kfifo_get(&fifo, &v) || v != 2) { fail("npot: overwrite"); return; }
+#endif /* KFIFO_OVERWRITE */
+
+    ok("test_npot");
+}
+
+static void test_npot_record(void)
+{
+    struct kfifo_rec_ptr_1 rfifo;
+    unsigned char buffer[3000], rec[100], out[100];
+    unsigned int i, ret;
+
+    if (kfifo_init_npot(&rfifo, buffer, sizeof(buffer))) { fail("npot_record: init"); return; }
+    if (kfifo_size(&rfifo) != 3000) { fail("npot_record: size"); return; }
+
+    for (i = 0; i < 200; i++)
+    {
+        memset(rec, (int)i, sizeof(rec));
+        ret = kfifo_in(&rfifo, rec, 1 + i % 100);
+        if (ret != 1 + i % 100) { fail("npot_record: in"); return; }
+        if (i >= 20)
+        {
+            ret = kfifo_out(&rfifo, out, sizeof(out));
+            if (ret != 1 + (i - 20) % 100 || out[0] != (unsigned char)(i - 20) || out[ret - 1] != (unsigned char)(i - 20))
+            {
+                fail("npot_record: out");
+                return;
+            }
+        }
+    }
+
+    ok("test_npot_record");
+}
+#endif /* KFIFO_NPOT */
+
+#ifdef KFIFO_WATERMARK
+static unsigned int wm_high_calls, wm_low_calls;
+
+static void wm_on_high(void *arg)
+{
+    (void)arg;
+    wm_high_calls++;
+}
+
+static void wm_on_low(void *arg)
+{
+    (void)arg;
+    wm_low_calls++;
+}
+
+static void test_watermark(void)
+{
+    DECLARE_KFIFO(fifo, unsigned char, 16);
+    INIT_KFIFO(fifo);
+
+    struct kfifo_watermark wm = { 12, 4, wm_on_high, wm_on_low, NULL, 0 };
+    struct kfifo_watermark bad = { 4, 4, NULL, NULL, NULL, 0 };
+    unsigned char buf[16] = {0};
+    unsigned int i;
+
+    wm_high_calls = wm_low_calls = 0;
+    if (kfifo_set_watermark(&fifo, &bad) != -EINVAL) { fail("watermark: low >= high"); return; }
+    if (kfifo_set_watermark(&fifo, &wm) != 0) { fail("watermark: set"); return; }
+
+    /* fires once when rising to the high watermark */
+    kfifo_in(&fifo, buf, 11);
+    if (wm_high_calls != 0) { fail("watermark: below high"); return; }
+    kfifo_put(&fifo, 1);
+    kfifo_put(&fifo, 2);
+    if (wm_high_calls != 1 || wm_low_calls != 0) { fail("watermark: high"); return; }
+
+    /* no low edge above the low watermark, none either for the overwrite mode */
+    if (kfifo_out(&fifo, buf, 5) != 5) { fail("watermark: out"); return; }
+    kfifo_in(&fifo, buf, 8);
+#ifdef KFIFO_OVERWRITE
+    for (i = 0; i < 4; i++)
+        kfifo_put_overwrite(&fifo, (unsigned char)i);
+#else /* KFIFO_OVERWRITE */
+    for (i = 0; i < 4; i++)
+        kfifo_put(&fifo, (unsigned char)i);
+#endif /* KFIFO_OVERWRITE */
+    if (wm_high_calls != 1 || wm_low_calls != 0) { fail("watermark: hysteresis"); return; }
+
+    /* fires once when falling to the low watermark */
+    if (kfifo_out(&fifo, buf, 11) != 11 || wm_low_calls != 0) { fail("watermark: above low"); return; }
+    kfifo_skip_count(&fifo, 1);
+    kfifo_skip_count(&fifo, 1);
+    if (wm_low_calls != 1) { fail("watermark: low"); return; }
+
+    /* armed again */
+    kfifo_in(&fifo, buf, 10);
+    if (wm_high_calls != 2) { fail("watermark: rearm"); return; }
+
+    /* emptied by the reader */
+    kfifo_reset_out(&fifo);
+    if (wm_low_calls != 2) { fail("watermark: reset_out"); return; }
+
+    /* already above the high watermark when set */
+    kfifo_set_watermark(&fifo, NULL);
+    kfifo_in(&fifo, buf, 13);
+    kfifo_set_watermark(&fifo, &wm);
+    if (wm_high_calls != 3) { fail("watermark: set above high"); return; }
+
+    /* reset waits for the high watermark again */
+    kfifo_reset(&fifo);
+    kfifo_in(&fifo, buf, 12);
+    if (wm_high_calls != 4 || wm_low_calls != 2) { fail("watermark: reset"); return; }
+
+    ok("test_watermark");
+}
+
+/*
+ * the other side's index, published after this side took its snapshot,
+ * becomes visible when this side's callback runs
+ */
+static __kfifo_index_t *wm_race_idx;
+static unsigned int wm_race_val;
+
+static void wm_race_publish(void)
+{
+    if (wm_race_idx)
+        *wm_race_idx = wm_race_val;
+    wm_race_idx = NULL;
+}
+
+static void wm_race_on_high(void *arg)
+{
+    wm_on_high(arg);
+    wm_race_publish();
+}
+
+static void wm_race_on_low(void *arg)
+{
+    wm_on_low(arg);
+    wm_race_publish();
+}
+
+static void test_watermark_race(void)
+{
+    DECLARE_KFIFO(fifo, unsigned char, 16);
+    INIT_KFIFO(fifo);
+
+    struct kfifo_watermark wm = { 12, 4, wm_race_on_high, wm_race_on_low, NULL, 0 };
+    unsigned char buf[16] = {0};
+    unsigned int snap;
+
+    wm_high_calls = wm_low_calls = 0;
+    kfifo_set_watermark(&fifo, &wm);
+    kfifo_in(&fifo, buf, 12);
+
+    /* reader drains to 2, its watermark step is still pending */
+    snap = fifo.kfifo.in;
+    fifo.kfifo.wm = NULL;
+    if (kfifo_out(&fifo, buf, 10) != 10) { fail("watermark_race: out"); return; }
+    fifo.kfifo.wm = &wm;
+
+    /* writer fills the fifo, sees on_high already called and stays silent */
+    kfifo_in(&fifo, buf, 14);
+    if (wm_high_calls != 1 || wm_low_calls != 0) { fail("watermark_race: writer"); return; }
+
+    /* reader calls on_low with its snapshot, then finds the fifo full */
+    wm_race_idx = &fifo.kfifo.in;
+    wm_race_val = fifo.kfifo.in;
+    fifo.kfifo.in = snap;
+    __kfifo_wm_out(&fifo.kfifo);
+    if (wm_low_calls != 1 || wm_high_calls != 2 || !kfifo_is_full(&fifo)) { fail("watermark_race: lost on_high"); return; }
+
+    /* and the other way round: writer fills to 12, its step is pending */
+    kfifo_skip_count(&fifo, 12);
+    if (wm_low_calls != 2) { fail("watermark_race: drain"); return; }
+    snap = fifo.kfifo.out;
+    fifo.kfifo.wm = NULL;
+    kfifo_in(&fifo, buf, 8);
+    fifo.kfifo.wm = &wm;
+
+    /* reader drains the fifo, sees on_low already called and stays silent */
+    if (kfifo_out(&fifo, buf, 16) != 12 || wm_high_calls != 2 || wm_low_calls != 2) { fail("watermark_race: reader"); return; }
+
+    /* writer calls on_high with its snapshot, then finds the fifo empty */
+    wm_race_idx = &fifo.kfifo.out;
+    wm_race_val = fifo.kfifo.out;
+    fifo.kfifo.out = snap;
+    __kfifo_wm_in(&fifo.kfifo);
+    if (wm_high_calls != 3 || wm_low_calls != 3 || !kfifo_is_empty(&fifo)) { fail("watermark_race: lost on_low"); return; }
+
+    kfifo_set_watermark(&fifo, NULL);
+    ok("test_watermark_race");
+}
+#endif /* KFIFO_WATERMARK */
+
+#ifdef KFIFO_OVERWRITE
+static void test_overwrite_record_4(void)
+{
+    STRUCT_KFIFO_REC_4(32) rfifo;
+    INIT_KFIFO(rfifo);
+
+    unsigned char rec[16] = {0}, out[16];
+    unsigned int ret;
+#ifdef KFIFO_WATERMARK
+    struct kfifo_watermark wm = { 13, 12, wm_on_high, wm_on_low, NULL, 0 };
+#endif /* KFIFO_WATERMARK */
+#ifdef KFIFO_STATS
+    struct kfifo_stats st;
+    unsigned int bytes_out;
+#endif /* KFIFO_STATS */
+
+    /* 8 byte skip marker at offset 24 left at the tail, followed by an 8 byte record */
+    ret = kfifo_in(&rfifo, rec, 8);
+    ret = kfifo_in(&rfifo, rec, 8);
+    ret = kfifo_out(&rfifo, out, sizeof(out));
+    ret = kfifo_in(&rfifo, rec, 8);
+    ret = kfifo_out(&rfifo, out, sizeof(out));
+    if (ret != 8 || kfifo_len(&rfifo) != 20) { fail("overwrite_record_4: setup"); return; }
+
+#ifdef KFIFO_WATERMARK
+    wm_high_calls = wm_low_calls = 0;
+    kfifo_set_watermark(&rfifo, &wm);
+#endif /* KFIFO_WATERMARK */
+#ifdef KFIFO_STATS
+    kfifo_stats(&rfifo, &st);
+    bytes_out = st.bytes_out;
+#endif /* KFIFO_STATS */
+
+    /* stepping over the marker makes room, the 8 byte record stays */
+    if (kfifo_in_overwrite(&rfifo, rec, 12) != 12 || kfifo_discarded(&rfifo) != 0) { fail("overwrite_record_4: discarded"); return; }
+#ifdef KFIFO_WATERMARK
+    kfifo_set_watermark(&rfifo, NULL);
+    if (wm_high_calls != 1 || wm_low_calls != 0) { fail("overwrite_record_4: watermark"); return; }
+#endif /* KFIFO_WATERMARK */
+#ifdef KFIFO_STATS
+    kfifo_stats(&rfifo, &st);
+    if (st.bytes_out != bytes_out) { fail("overwrite_record_4: stats"); return; }
+#endif /* KFIFO_STATS */
+
+    if (kfifo_out(&rfifo, out, sizeof(out)) != 8 || kfifo_out(&rfifo, out, sizeof(out)) != 12) { fail("overwrite_record_4: out"); return; }
+
+    ok("test_overwrite_record_4");
+}
+#endif /* KFIFO_OVERWRITE */
+
+#ifdef KFIFO_STATS
+static void stats_count(const struct kfifo_stats *st, void *arg)
+{
+    unsigned int *n = (unsigned int *)arg;
+
+    if (st->name && strcmp(st->name, "dyn") == 0)
+        n[1]++;
+    n[0]++;
+}
+
+static void test_stats(void)
+{
+    DECLARE_KFIFO(fifo, uint16_t, 8);
+    INIT_KFIFO(fifo);
+    STRUCT_KFIFO_REC_1(32) rfifo;
+    INIT_KFIFO(rfifo);
+    DECLARE_KFIFO_PTR(dyn, uint8_t);
+
+    struct kfifo_stats st;
+    uint16_t buf[16] = {0}, v;
+    unsigned int n[2];
+
+    kfifo_in(&fifo, buf, 6);
+    if (kfifo_out(&fifo, buf, 4) != 4) { fail("stats: out"); return; }
+    kfifo_in(&fifo, buf, 10);
+    kfifo_put(&fifo, 1);
+
+    kfifo_stats(&fifo, &st);
+    if (st.size != 8 || st.len != 8 || st.peak != 8) { fail("stats: peak"); return; }
+    if (st.truncated != 2 || st.dropped != 5) { fail("stats: truncated"); return; }
+    if (st.bytes_in != 24 || st.bytes_out != 8 || st.empty != 0) { fail("stats: bytes"); return; }
+
+    if (kfifo_out(&fifo, buf, 16) != 8) { fail("stats: drain"); return; }
+    if (kfifo_get(&fifo, &v) || kfifo_out(&fifo, buf, 16)) { fail("stats: empty read"); return; }
+    kfifo_stats(&fifo, &st);
+    if (st.empty != 2 || st.bytes_out != 24 || st.len != 0 || st.name != NULL) { fail("stats: empty"); return; }
+
+    kfifo_put(&fifo, 1);
+    kfifo_stats_reset(&fifo);
+    kfifo_stats(&fifo, &st);
+    if (st.peak != 1 || st.truncated || st.empty || st.bytes_in || st.bytes_out) { fail("stats: reset"); return; }
+
+    /* record fifos count bytes, a record which does not fit is dropped */
+    kfifo_in(&rfifo, "0123456789", 10);
+    kfifo_in(&rfifo, "0123456789abcdefghijklmnopq", 27);
+    kfifo_stats(&rfifo, &st);
+    if (st.peak != 11 || st.truncated != 1 || st.dropped != 27 || st.bytes_in != 11) { fail("stats: record"); return; }
+
+    /* registry */
+    if (kfifo_alloc(&dyn, 16)) { fail("stats: alloc"); return; }
+    kfifo_stats_register(&fifo, "u16");
+    kfifo_stats_register(&rfifo, "rec");
+    kfifo_stats_register(&dyn, "dyn");
+    kfifo_stats_register(&dyn, "dyn");
+    memset(n, 0, sizeof(n));
+    kfifo_stats_foreach(stats_count, n);
+    if (n[0] != 3 || n[1] != 1) { fail("stats: foreach"); kfifo_free(&dyn); return; }
+
+    kfifo_free(&dyn);
+    kfifo_stats_unregister(&rfifo);
+    memset(n, 0, sizeof(n));
+    kfifo_stats_foreach(stats_count, n);
+    kfifo_stats_unregister(&fifo);
+    if (n[0] != 1 || n[1] != 0) { fail("stats: unregister"); return; }
+
+    ok("test_stats");
+}
+#endif /* KFIFO_STATS */
+
 int main(void)
 {
     printf("Running kfifo tests...\n");
@@ -303,11 +1089,38 @@ int main(void)
     test_static_u8();
     test_dynamic_u16();
     test_out_linear_ptr();
+    test_in_linear_ptr();
     test_full_empty();
+    test_reset_out();
     test_struct_frame();
     test_record_static();
     test_record_dynamic();
     test_struct_frame_r();
+    test_dma_pipe();
+    test_dma_record();
+#ifdef KFIFO_OVERWRITE
+    test_overwrite();
+    test_overwrite_record();
+#endif /* KFIFO_OVERWRITE */
+    test_record_4();
+    test_record_4_wrap();
+    test_record_4_init();
+#ifdef KFIFO_OVERWRITE
+    test_overwrite_record_4();
+#endif /* KFIFO_OVERWRITE */
+    test_out_records();
+    test_peek_at_find();
+#ifdef KFIFO_NPOT
+    test_npot();
+    test_npot_record();
+#endif /* KFIFO_NPOT */
+#ifdef KFIFO_WATERMARK
+    test_watermark();
+    test_watermark_race();
+#endif /* KFIFO_WATERMARK */
+#ifdef KFIFO_STATS
+    test_stats();
+#endif /* KFIFO_STATS */
 
     if (failures == 0) {
         printf("All tests passed.\n");
@@ -0,0 +1,131 @@
+/*
+ * test_kfifo16.c
+ * Tests for the compact 16-bit index kfifo (header size, put/get, in/out
+ * with wrap, index overflow at 65536, linear pointers).
+ *
+ * Build (Linux):
+ *   gcc -std=gnu11 test_kfifo16.c -o test_kfifo16
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "kfifo16.h"
+
+static int failures = 0;
+
+static void ok(const char *name)
+{
+    printf("[OK] %s\n", name);
+}
+
+static void fail(const char *name)
+{
+    printf("[FAIL] %s\n", name);
+    failures++;
+}
+
+static DEFINE_KFIFO16(uart_rx, uint8_t, 16);
+
+static void test_header_size(void)
+{
+    DECLARE_KFIFO16(fifo, uint8_t, 8);
+
+    if (sizeof(struct __kfifo16) != 4) { fail("header_size: header"); return; }
+    if (sizeof(fifo) != 4 + 8) { fail("header_size: fifo"); return; }
+    if (kfifo16_size(&uart_rx) != 16 || !kfifo16_is_empty(&uart_rx)) { fail("header_size: define"); return; }
+
+    ok("test_header_size");
+}
+
+static void test_put_get(void)
+{
+    DECLARE_KFIFO16(fifo, uint32_t, 4);
+    INIT_KFIFO16(fifo);
+
+    uint32_t v;
+    unsigned int i;
+
+    for (i = 0; i < 4; i++)
+        if (kfifo16_put(&fifo, i + 100) != 1) { fail("put_get: put"); return; }
+    if (!kfifo16_is_full(&fifo) || kfifo16_put(&fifo, 5) != 0) { fail("put_get: full"); return; }
+    if (kfifo16_peek(&fifo, &v) != 1 || v != 100) { fail("put_get: peek"); return; }
+
+    for (i = 0; i < 4; i++)
+        if (kfifo16_get(&fifo, &v) != 1 || v != i + 100) { fail("put_get: get"); return; }
+    if (kfifo16_get(&fifo, &v) != 0) { fail("put_get: empty"); return; }
+
+    ok("test_put_get");
+}
+
+static void test_wrap(void)
+{
+    DECLARE_KFIFO16(fifo, uint16_t, 8);
+    INIT_KFIFO16(fifo);
+
+    uint16_t in[5], out[5];
+    unsigned int lap, i, ret;
+
+    /* run the 16-bit indices over 65536 several times */
+    for (lap = 0; lap < 40000; lap++)
+    {
+        for (i = 0; i < 5; i++)
+            in[i] = (uint16_t)(lap + i);
+        ret = kfifo16_in(&fifo, in, 5);
+        if (ret != 5 || kfifo16_len(&fifo) != 5 || kfifo16_avail(&fifo) != 3) { fail("wrap: in"); return; }
+        ret = kfifo16_out(&fifo, out, 8);
+        if (ret != 5 || memcmp(in, out, sizeof(in)) != 0) { fail("wrap: out"); return; }
+    }
+
+    ok("test_wrap");
+}
+
+static void test_linear_ptr(void)
+{
+    DECLARE_KFIFO16(fifo, uint8_t, 8);
+    INIT_KFIFO16(fifo);
+
+    uint8_t tmp[6] = {0}, *p;
+    unsigned int n;
+
+    /* move in/out to offset 6 */
+    n = kfifo16_in(&fifo, tmp, 6);
+    n = kfifo16_out(&fifo, tmp, n);
+
+    n = kfifo16_in_linear_ptr(&fifo, &p, 8);
+    if (n != 2 || p != &fifo.data[6]) { fail("linear_ptr: in"); return; }
+    p[0] = 1;
+    p[1] = 2;
+    kfifo16_in_commit(&fifo, 2);
+    if (kfifo16_put(&fifo, 3) != 1) { fail("linear_ptr: put"); return; }
+
+    n = kfifo16_out_linear_ptr(&fifo, &p, 8);
+    if (n != 2 || p[0] != 1 || p[1] != 2) { fail("linear_ptr: out"); return; }
+    kfifo16_skip_count(&fifo, n);
+    if (kfifo16_len(&fifo) != 1 || kfifo16_get(&fifo, tmp) != 1 || tmp[0] != 3) { fail("linear_ptr: rest"); return; }
+
+    kfifo16_reset(&fifo);
+    if (!kfifo16_is_empty(&fifo)) { fail("linear_ptr: reset"); return; }
+
+    ok("test_linear_ptr");
+}
+
+int main(void)
+{
+    printf("Running kfifo16 tests...\n");
+
+    test_header_size();
+    test_put_get();
+    test_wrap();
+    test_linear_ptr();
+
+    if (failures == 0) {
+        printf("All tests passed.\n");
+        return 0;
+    }
+    else {
+        printf("%d test(s) failed.\n", failures);
+        return 2;
+    }
+}
@@ -0,0 +1,295 @@
+/*
+ * test_kfifo_bcast.c
+ * Tests for the broadcast kfifo (static + dynamic, slowest reader bounds the
+ * writer, overrun counting, zero-copy reads, readers lapped by the writer
+ * in the middle of a read, and a multi-threaded
+ * one-writer/many-readers check for both policies).
+ *
+ * Build (Linux):
+ *   gcc -std=gnu11 -pthread test_kfifo_bcast.c kfifo_bcast.c -o test_kfifo_bcast
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+#include "kfifo_bcast.h"
+
+static int failures = 0;
+
+static void ok(const char *name)
+{
+    printf("[OK] %s\n", name);
+}
+
+static void fail(const char *name)
+{
+    printf("[FAIL] %s\n", name);
+    failures++;
+}
+
+static void test_block(void)
+{
+    DECLARE_KFIFO_BCAST(fifo, int, 8, 2);
+    INIT_KFIFO_BCAST(fifo, KFIFO_BCAST_BLOCK);
+
+    int buf[8];
+    int v;
+    unsigned int i;
+
+    if (kfifo_bcast_size(&fifo) != 8 || kfifo_bcast_avail(&fifo) != 8) { fail("block: init"); return; }
+
+    for (i = 0; i < 8; i++)
+        if (kfifo_bcast_put(&fifo, (int)i) != 1) { fail("block: put"); return; }
+    if (kfifo_bcast_put(&fifo, 8) != 0) { fail("block: full"); return; }
+
+    /* reader 0 drains, reader 1 still holds the writer back */
+    if (kfifo_bcast_out(&fifo, 0, buf, 8) != 8 || buf[0] != 0 || buf[7] != 7) { fail("block: out r0"); return; }
+    if (kfifo_bcast_avail(&fifo) != 0 || kfifo_bcast_len(&fifo, 1) != 8) { fail("block: slowest"); return; }
+
+    if (kfifo_bcast_out(&fifo, 1, buf, 3) != 3 || buf[2] != 2) { fail("block: out r1"); return; }
+    if (kfifo_bcast_avail(&fifo) != 3) { fail("block: avail"); return; }
+
+    /* wrap around the end of the buffer */
+    for (i = 0; i < 3; i++)
+        buf[i] = 8 + (int)i;
+    if (kfifo_bcast_in(&fifo, buf, 5) != 3) { fail("block: in"); return; }
+
+    if (kfifo_bcast_len(&fifo, 0) != 3 || kfifo_bcast_len(&fifo, 1) != 8) { fail("block: len"); return; }
+    for (i = 3; i < 11; i++)
+        if (kfifo_bcast_get(&fifo, 1, &v) != 1 || v != (int)i) { fail("block: wrap"); return; }
+    if (!kfifo_bcast_is_empty(&fifo, 1) || kfifo_bcast_overrun(&fifo, 0) || kfifo_bcast_overrun(&fifo, 1)) { fail("block: empty"); return; }
+
+    ok("test_block");
+}
+
+static void test_drop(void)
+{
+    DECLARE_KFIFO_BCAST(fifo, int, 4, 2);
+    INIT_KFIFO_BCAST(fifo, KFIFO_BCAST_DROP);
+
+    int buf[10];
+    int v;
+    unsigned int i;
+
+    for (i = 0; i < 10; i++)
+        buf[i] = (int)i;
+
+    /* the writer never waits, only the newest 4 elements survive */
+    if (kfifo_bcast_in(&fifo, buf, 6) != 4) { fail("drop: in"); return; }
+    if (kfifo_bcast_avail(&fifo) != 4 || kfifo_bcast_len(&fifo, 0) != 4) { fail("drop: len"); return; }
+    if (kfifo_bcast_get(&fifo, 0, &v) != 1 || v != 2 || kfifo_bcast_overrun(&fifo, 0) != 2) { fail("drop: overrun r0"); return; }
+
+    if (kfifo_bcast_in(&fifo, buf + 6, 4) != 4) { fail("drop: in2"); return; }
+    /* 3 4 5 are overwritten before reader 0 gets to them */
+    memset(buf, 0, sizeof(buf));
+    if (kfifo_bcast_out(&fifo, 0, buf, 10) != 4 || buf[0] != 6 || buf[3] != 9) { fail("drop: out r0"); return; }
+    if (kfifo_bcast_overrun(&fifo, 0) != 5) { fail("drop: overrun r0 total"); return; }
+
+    /* reader 1 never read anything */
+    if (kfifo_bcast_out(&fifo, 1, buf, 10) != 4 || buf[0] != 6 || kfifo_bcast_overrun(&fifo, 1) != 6) { fail("drop: overrun r1"); return; }
+
+    kfifo_bcast_put(&fifo, 10);
+    kfifo_bcast_reader_reset(&fifo, 1);
+    if (kfifo_bcast_len(&fifo, 0) != 1 || !kfifo_bcast_is_empty(&fifo, 1)) { fail("drop: reader_reset"); return; }
+
+    ok("test_drop");
+}
+
+static void test_linear_ptr(void)
+{
+    DECLARE_KFIFO_BCAST(fifo, uint8_t, 8, 2);
+    INIT_KFIFO_BCAST(fifo, KFIFO_BCAST_DROP);
+
+    const uint8_t data[] = { 1, 2, 3, 4, 5, 6 };
+    uint8_t tmp[6];
+    uint8_t *p;
+    unsigned int n;
+
+    kfifo_bcast_in(&fifo, data, 6);
+    if (kfifo_bcast_out(&fifo, 0, tmp, 6) != 6 || kfifo_bcast_out(&fifo, 1, tmp, 6) != 6) { fail("linear_ptr: out"); return; }
+    kfifo_bcast_in(&fifo, data, 4);
+
+    /* the data wraps, only the part till the end of the buffer is returned */
+    n = kfifo_bcast_out_linear_ptr(&fifo, 0, &p, 8);
+    if (n != 2 || p[0] != 1 || p[1] != 2) { fail("linear_ptr: first"); return; }
+    if (kfifo_bcast_skip_count(&fifo, 0, n) != n) { fail("linear_ptr: skip"); return; }
+    n = kfifo_bcast_out_linear_ptr(&fifo, 0, &p, 8);
+    if (n != 2 || p[0] != 3 || p[1] != 4) { fail("linear_ptr: second"); return; }
+    if (kfifo_bcast_skip_count(&fifo, 0, n) != n || !kfifo_bcast_is_empty(&fifo, 0)) { fail("linear_ptr: drained"); return; }
+
+    /* the writer overwrites the data while reader 1 is processing it */
+    n = kfifo_bcast_out_linear_ptr(&fifo, 1, &p, 8);
+    if (n != 2) { fail("linear_ptr: r1"); return; }
+    kfifo_bcast_in(&fifo, data, 6);
+    if (kfifo_bcast_skip_count(&fifo, 1, n) != 0) { fail("linear_ptr: overwritten"); return; }
+    if (kfifo_bcast_overrun(&fifo, 1) != 2 || kfifo_bcast_len(&fifo, 1) != 8) { fail("linear_ptr: overrun"); return; }
+
+    ok("test_linear_ptr");
+}
+
+/*
+ * DROP: the writer announces head before it publishes in. A block larger
+ * than the fifo moves head more than size past the in a reader sees (the
+ * same happens when the writer laps a reader between its loads of in and
+ * head). The reader must report no data instead of reading past in.
+ */
+static void test_lapping(void)
+{
+    DECLARE_KFIFO_BCAST(fifo, uint8_t, 8, 1);
+    INIT_KFIFO_BCAST(fifo, KFIFO_BCAST_DROP);
+
+    uint8_t data[11], tmp[8], *p;
+    unsigned int i;
+
+    for (i = 0; i < sizeof(data); i++)
+        data[i] = (uint8_t)(100 + i);
+
+    kfifo_bcast_in(&fifo, data, 4);
+
+    /* writer stopped right after announcing an 11 element block */
+    atomic_store(&fifo.kfifo.head, 4 + 3 + 8);
+    if (kfifo_bcast_len(&fifo, 0) != 0) { fail("lapping: len"); return; }
+    if (kfifo_bcast_out(&fifo, 0, tmp, 8) != 0) { fail("lapping: out"); return; }
+    if (kfifo_bcast_out_linear_ptr(&fifo, 0, &p, 8) != 0) { fail("lapping: linear_ptr"); return; }
+
+    /* the writer finishes the block, the reader gets its newest 8 elements */
+    atomic_store(&fifo.kfifo.head, 4);
+    kfifo_bcast_in(&fifo, data, 11);
+    if (kfifo_bcast_out(&fifo, 0, tmp, 8) != 8 || tmp[0] != 103 || tmp[7] != 110) { fail("lapping: data"); return; }
+    if (kfifo_bcast_overrun(&fifo, 0) != 7 || !kfifo_bcast_is_empty(&fifo, 0)) { fail("lapping: overrun"); return; }
+
+    ok("test_lapping");
+}
+
+static void test_alloc(void)
+{
+    DECLARE_KFIFO_BCAST_PTR(fifo, uint16_t);
+    uint16_t v;
+
+    if (kfifo_bcast_alloc(&fifo, 0, 1, KFIFO_BCAST_BLOCK) == 0) { fail("alloc: size 0"); return; }
+    if (kfifo_bcast_alloc(&fifo, 16, 0, KFIFO_BCAST_BLOCK) == 0) { fail("alloc: no readers"); return; }
+    if (kfifo_bcast_alloc(&fifo, 0x80000001U, 1, KFIFO_BCAST_BLOCK) != -EINVAL) { fail("alloc: too large"); return; }
+    if (kfifo_bcast_alloc(&fifo, 10, 3, KFIFO_BCAST_BLOCK) != 0) { fail("alloc"); return; }
+    if (kfifo_bcast_size(&fifo) != 16) { fail("alloc: roundup"); kfifo_bcast_free(&fifo); return; }
+
+    kfifo_bcast_put(&fifo, 0x1234);
+    if (kfifo_bcast_get(&fifo, 2, &v) != 1 || v != 0x1234 || kfifo_bcast_len(&fifo, 0) != 1) { fail("alloc: get"); kfifo_bcast_free(&fifo); return; }
+
+    kfifo_bcast_free(&fifo);
+    if (fifo.kfifo.data != NULL || fifo.kfifo.readers != NULL) { fail("alloc: free"); return; }
+
+    ok("test_alloc");
+}
+
+#define MT_READERS 3
+#define MT_COUNT 200000
+
+static DECLARE_KFIFO_BCAST(mt_fifo, uint32_t, 64, MT_READERS);
+static unsigned int mt_received[MT_READERS];
+static int mt_error;
+
+static void *mt_writer(void *arg)
+{
+    uint32_t i;
+
+    (void)arg;
+    for (i = 0; i < MT_COUNT;)
+    {
+        if (kfifo_bcast_put(&mt_fifo, i))
+            i++;
+        else
+            sched_yield();
+    }
+
+    return NULL;
+}
+
+static void *mt_reader(void *arg)
+{
+    unsigned int r = (unsigned int)(uintptr_t)arg;
+    uint32_t buf[16];
+    uint32_t next = 0;
+    unsigned int n, i;
+
+    while (next < MT_COUNT)
+    {
+        n = kfifo_bcast_out(&mt_fifo, r, buf, 16);
+        if (n == 0)
+            sched_yield();
+        for (i = 0; i < n; i++)
+        {
+            /* data arrives in order, gaps only for dropped elements */
+            if (buf[i] < next)
+                mt_error = 1;
+            next = buf[i] + 1;
+            mt_received[r]++;
+        }
+    }
+
+    return NULL;
+}
+
+static int run_mt(KFIFO_BCAST_POLICY policy)
+{
+    pthread_t w, rd[MT_READERS];
+    unsigned int i;
+
+    INIT_KFIFO_BCAST(mt_fifo, policy);
+    mt_error = 0;
+    memset(mt_received, 0, sizeof(mt_received));
+
+    for (i = 0; i < MT_READERS; i++)
+        pthread_create(&rd[i], NULL, mt_reader, (void *)(uintptr_t)i);
+    pthread_create(&w, NULL, mt_writer, NULL);
+
+    pthread_join(w, NULL);
+    for (i = 0; i < MT_READERS; i++)
+        pthread_join(rd[i], NULL);
+
+    if (mt_error)
+        return 0;
+
+    /* every element is either received or counted as dropped */
+    for (i = 0; i < MT_READERS; i++)
+        if (mt_received[i] + kfifo_bcast_overrun(&mt_fifo, i) != MT_COUNT)
+            return 0;
+
+    return 1;
+}
+
+static void test_multithread(void)
+{
+    unsigned int i;
+
+    if (!run_mt(KFIFO_BCAST_BLOCK)) { fail("multithread: block"); return; }
+    for (i = 0; i < MT_READERS; i++)
+        if (mt_received[i] != MT_COUNT) { fail("multithread: block lost data"); return; }
+
+    if (!run_mt(KFIFO_BCAST_DROP)) { fail("multithread: drop"); return; }
+
+    ok("test_multithread");
+}
+
+int main(void)
+{
+    printf("Running kfifo_bcast tests...\n");
+
+    test_block();
+    test_drop();
+    test_linear_ptr();
+    test_lapping();
+    test_alloc();
+    test_multithread();
+
+    if (failures == 0) {
+        printf("All tests passed.\n");
+        return 0;
+    }
+    else {
+        printf("%d test(s) failed.\n", failures);
+        return 2;
+    }
+}
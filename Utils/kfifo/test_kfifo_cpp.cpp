@@ -0,0 +1,170 @@
+/*
+ * test_kfifo_cpp.cpp
+ * Tests for the C++ wrapper (mcu::kfifo<T, N>, mcu::kfifo_ref<T>): single
+ * and bulk access across the wrap, span views, sharing a fifo with the C
+ * macros.
+ *
+ * Build (Linux):
+ *   gcc -std=gnu11 -c kfifo.c -o kfifo.o
+ *   g++ -std=c++17 test_kfifo_cpp.cpp kfifo.o -o test_kfifo_cpp
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include "kfifo.hpp"
+
+static int failures = 0;
+
+static void ok(const char *name)
+{
+    printf("[OK] %s\n", name);
+}
+
+static void fail(const char *name)
+{
+    printf("[FAIL] %s\n", name);
+    failures++;
+}
+
+struct sample
+{
+    uint16_t ch;
+    int32_t value;
+};
+
+static void test_push_pop(void)
+{
+    mcu::kfifo<sample, 8> fifo;
+    sample s;
+    int i;
+
+    static_assert(decltype(fifo)::size == 8 && decltype(fifo)::mask == 7, "constexpr size");
+
+    if (!fifo.empty() || fifo.avail() != 8) { fail("push_pop: init"); return; }
+    if (fifo.pop(s)) { fail("push_pop: pop empty"); return; }
+
+    for (i = 0; i < 8; i++)
+        if (!fifo.push(sample{(uint16_t)i, i * 10})) { fail("push_pop: push"); return; }
+    if (!fifo.full() || fifo.push(sample{0, 0})) { fail("push_pop: full"); return; }
+
+    /* wrap the indices around several times */
+    for (i = 0; i < 100; i++)
+    {
+        if (!fifo.pop(s) || s.value != i * 10) { fail("push_pop: pop"); return; }
+        if (!fifo.push(sample{(uint16_t)(i + 8), (i + 8) * 10})) { fail("push_pop: refill"); return; }
+    }
+    if (fifo.len() != 8) { fail("push_pop: len"); return; }
+
+    fifo.reset();
+    if (!fifo.empty()) { fail("push_pop: reset"); return; }
+
+    ok("test_push_pop");
+}
+
+static void test_bulk(void)
+{
+    mcu::kfifo<uint32_t, 16> fifo;
+    uint32_t in[20], out[20];
+    unsigned int i;
+
+    for (i = 0; i < 20; i++)
+        in[i] = i;
+
+    if (fifo.push_bulk(in, 10) != 10) { fail("bulk: push"); return; }
+    if (fifo.pop_bulk(out, 6) != 6 || memcmp(out, in, 6 * sizeof(uint32_t)) != 0) { fail("bulk: pop"); return; }
+
+    /* 10 + 12 crosses the end of the buffer, only 12 fit */
+    if (fifo.push_bulk(in + 10, 10) != 10) { fail("bulk: wrap push"); return; }
+    if (fifo.push_bulk(in, 20) != 2) { fail("bulk: short push"); return; }
+    if (fifo.pop_bulk(out, 20) != 16) { fail("bulk: wrap pop"); return; }
+    if (memcmp(out, in + 6, 14 * sizeof(uint32_t)) != 0 || out[14] != 0 || out[15] != 1) { fail("bulk: data"); return; }
+    if (fifo.pop_bulk(out, 1) != 0) { fail("bulk: empty"); return; }
+
+    ok("test_bulk");
+}
+
+static void test_views(void)
+{
+    mcu::kfifo<uint8_t, 16> fifo;
+    unsigned int i;
+
+    /* move the indices to 12, the free space ends at the end of the buffer */
+    for (i = 0; i < 12; i++)
+        fifo.push((uint8_t)i);
+    fifo.consume(12);
+
+    mcu::span<uint8_t> w = fifo.write_view();
+    if (w.size() != 4) { fail("views: write size"); return; }
+    for (i = 0; i < w.size(); i++)
+        w[i] = (uint8_t)('a' + i);
+    fifo.commit(w.size());
+
+    w = fifo.write_view();
+    if (w.size() != 12 || w.data() != fifo.c_fifo()->data) { fail("views: wrapped write"); return; }
+    w[0] = 'e';
+    fifo.commit(1);
+
+    mcu::span<const uint8_t> r = fifo.read_view();
+    if (r.size() != 4 || memcmp(r.data(), "abcd", 4) != 0) { fail("views: read"); return; }
+    fifo.consume(r.size());
+
+    r = fifo.read_view();
+    if (r.size() != 1 || r[0] != 'e') { fail("views: wrapped read"); return; }
+    fifo.consume(1);
+    if (!fifo.empty() || fifo.read_view().size() != 0) { fail("views: empty"); return; }
+
+    ok("test_views");
+}
+
+static void test_c_interop(void)
+{
+    /*
+     * the typed macros of kfifo.h are C only, the C side is represented
+     * by the functions they call
+     */
+    mcu::kfifo<uint16_t, 8> cpp;
+    uint16_t v = 0x1234;
+
+    if (__kfifo_in(cpp.c_fifo(), &v, 1) != 1 || !cpp.pop(v) || v != 0x1234) { fail("c_interop: C in, C++ pop"); return; }
+    cpp.push(0x5678);
+    if (cpp.len() != 1 || __kfifo_out(cpp.c_fifo(), &v, 1) != 1 || v != 0x5678) { fail("c_interop: C++ push, C out"); return; }
+
+    /* typed access to a fifo set up in C */
+    static uint32_t storage[32];
+    struct __kfifo fifo;
+    uint32_t buf[40];
+    unsigned int i;
+
+    if (__kfifo_init(&fifo, storage, sizeof(storage), sizeof(uint32_t))) { fail("c_interop: init"); return; }
+    mcu::kfifo_ref<uint32_t> ref(&fifo);
+
+    for (i = 0; i < 40; i++)
+        buf[i] = i;
+    if (ref.capacity() != 32) { fail("c_interop: ref capacity"); return; }
+    __kfifo_in(&fifo, buf, 20);
+    if (ref.len() != 20 || ref.pop_bulk(buf, 15) != 15 || buf[14] != 14) { fail("c_interop: ref pop"); return; }
+    if (ref.push_bulk(buf + 20, 20) != 20 || ref.len() != 25) { fail("c_interop: ref push"); return; }
+    if (__kfifo_out(&fifo, buf, 40) != 25 || buf[0] != 15 || buf[4] != 19 || buf[5] != 20 || buf[24] != 39) { fail("c_interop: C out"); return; }
+
+    ok("test_c_interop");
+}
+
+int main(void)
+{
+    printf("Running kfifo C++ tests...\n");
+
+    test_push_pop();
+    test_bulk();
+    test_views();
+    test_c_interop();
+
+    if (failures == 0) {
+        printf("All tests passed.\n");
+        return 0;
+    }
+    else {
+        printf("%d test(s) failed.\n", failures);
+        return 2;
+    }
+}
@@ -0,0 +1,207 @@
+/*
+ * test_kfifo_frame.c
+ * Tests for the COBS/SLIP framer (reference encodings, round trips across
+ * the buffer end, decoding resumed byte by byte, full fifo, oversized and
+ * malformed frames).
+ *
+ * Build (Linux):
+ *   gcc -std=gnu11 test_kfifo_frame.c kfifo_frame.c kfifo.c -o test_kfifo_frame
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "kfifo_frame.h"
+
+static int failures = 0;
+
+static void ok(const char *name)
+{
+    printf("[OK] %s\n", name);
+}
+
+static void fail(const char *name)
+{
+    printf("[FAIL] %s\n", name);
+    failures++;
+}
+
+/* encodes @in and compares the bytes in the fifo with @out */
+static int check_encoding(KFIFO_FRAME_TYPE type, const void *in, unsigned int len,
+                          const void *out, unsigned int outlen)
+{
+    DECLARE_KFIFO(fifo, unsigned char, 1024);
+    unsigned char buf[1024];
+
+    INIT_KFIFO(fifo);
+    if (kfifo_frame_encode(&fifo, type, in, len) != outlen)
+        return -1;
+    if (kfifo_out(&fifo, buf, sizeof(buf)) != outlen || memcmp(buf, out, outlen) != 0)
+        return -1;
+    return 0;
+}
+
+static void test_reference(void)
+{
+    unsigned char in[300], out[310];
+    unsigned int i;
+
+    if (check_encoding(KFIFO_FRAME_COBS, "\x00", 1, "\x01\x01\x00", 3)) { fail("reference: cobs zero"); return; }
+    if (check_encoding(KFIFO_FRAME_COBS, "\x00\x00", 2, "\x01\x01\x01\x00", 4)) { fail("reference: cobs zeros"); return; }
+    if (check_encoding(KFIFO_FRAME_COBS, "\x11\x22\x00\x33", 4, "\x03\x11\x22\x02\x33\x00", 6)) { fail("reference: cobs mixed"); return; }
+    if (check_encoding(KFIFO_FRAME_COBS, "\x11\x00\x00\x00", 4, "\x02\x11\x01\x01\x01\x00", 6)) { fail("reference: cobs trailing"); return; }
+
+    /* 254 non-zero bytes fill one block, 255 need a second one */
+    for (i = 0; i < 255; i++)
+        in[i] = (unsigned char)(i + 1);
+    out[0] = 0xff;
+    memcpy(out + 1, in, 254);
+    out[255] = 0x00;
+    if (check_encoding(KFIFO_FRAME_COBS, in, 254, out, 256)) { fail("reference: cobs 254"); return; }
+    out[255] = 0x02;
+    out[256] = 0xff;
+    out[257] = 0x00;
+    if (check_encoding(KFIFO_FRAME_COBS, in, 255, out, 258)) { fail("reference: cobs 255"); return; }
+
+    if (check_encoding(KFIFO_FRAME_SLIP, "\x01\xc0\x02\xdb\x03", 5, "\xc0\x01\xdb\xdc\x02\xdb\xdd\x03\xc0", 9)) { fail("reference: slip"); return; }
+
+    ok("test_reference");
+}
+
+/* frames of all lengths with zeros and SLIP specials, wrapping in a small fifo */
+static void test_roundtrip(KFIFO_FRAME_TYPE type, const char *name)
+{
+    DECLARE_KFIFO(fifo, unsigned char, 1024);
+    struct kfifo_frame_decoder dec;
+    unsigned char in[600], frame[600];
+    unsigned int len, i, n;
+
+    INIT_KFIFO(fifo);
+    kfifo_frame_decoder_init(&dec, type, frame, sizeof(frame));
+    srand(1);
+
+    for (len = 1; len < sizeof(in); len += 7)
+    {
+        for (i = 0; i < len; i++)
+        {
+            int r = rand() % 8;
+
+            in[i] = r == 0 ? 0x00 : r == 1 ? KFIFO_SLIP_END : r == 2 ? KFIFO_SLIP_ESC : (unsigned char)rand();
+        }
+        if (kfifo_frame_encode(&fifo, type, in, len) == 0) { fail(name); return; }
+        n = kfifo_frame_decode(&fifo, &dec);
+        if (n != len || memcmp(frame, in, len) != 0 || !kfifo_is_empty(&fifo)) { fail(name); return; }
+    }
+    if (dec.errors) { fail(name); return; }
+
+    ok(name);
+}
+
+/* decoding resumes when the frame arrives one byte at a time */
+static void test_resume(void)
+{
+    DECLARE_KFIFO(tx, unsigned char, 256);
+    DECLARE_KFIFO(rx, unsigned char, 16);
+    struct kfifo_frame_decoder dec;
+    unsigned char frame[64], c;
+    static const char msg1[] = "hello\0world", msg2[] = "\xc0\xdb!";
+    KFIFO_FRAME_TYPE type;
+    unsigned int n, got;
+
+    for (type = KFIFO_FRAME_COBS; type <= KFIFO_FRAME_SLIP; type++)
+    {
+        INIT_KFIFO(tx);
+        INIT_KFIFO(rx);
+        kfifo_frame_decoder_init(&dec, type, frame, sizeof(frame));
+        kfifo_frame_encode(&tx, type, msg1, sizeof(msg1) - 1);
+        kfifo_frame_encode(&tx, type, msg2, sizeof(msg2) - 1);
+
+        got = 0;
+        while (kfifo_get(&tx, &c))
+        {
+            kfifo_put(&rx, c);
+            n = kfifo_frame_decode(&rx, &dec);
+            if (!n)
+                continue;
+            if (got == 0 && (n != sizeof(msg1) - 1 || memcmp(frame, msg1, n) != 0)) { fail("resume: first"); return; }
+            if (got == 1 && (n != sizeof(msg2) - 1 || memcmp(frame, msg2, n) != 0)) { fail("resume: second"); return; }
+            got++;
+        }
+        if (got != 2) { fail("resume: count"); return; }
+    }
+
+    ok("test_resume");
+}
+
+static void test_full(void)
+{
+    DECLARE_KFIFO(fifo, unsigned char, 16);
+    unsigned char buf[20] = {0};
+
+    INIT_KFIFO(fifo);
+    kfifo_put(&fifo, 0xaa);
+    kfifo_skip(&fifo);
+
+    /* 14 zeros need 16 bytes in COBS, 15 do not fit */
+    if (kfifo_frame_encode(&fifo, KFIFO_FRAME_COBS, buf, 15) != 0 || !kfifo_is_empty(&fifo)) { fail("full: too long"); return; }
+    if (kfifo_frame_encode(&fifo, KFIFO_FRAME_COBS, buf, 14) != 16 || !kfifo_is_full(&fifo)) { fail("full: exact"); return; }
+    if (kfifo_frame_encode(&fifo, KFIFO_FRAME_SLIP, buf, 0) != 0) { fail("full: no room"); return; }
+
+    if (KFIFO_FRAME_MAX_ENCODED(KFIFO_FRAME_COBS, 14) < 16 || KFIFO_FRAME_MAX_ENCODED(KFIFO_FRAME_SLIP, 7) != 16) { fail("full: max encoded"); return; }
+
+    ok("test_full");
+}
+
+static void test_errors(void)
+{
+    DECLARE_KFIFO(fifo, unsigned char, 256);
+    struct kfifo_frame_decoder dec;
+    unsigned char frame[8], big[20];
+
+    INIT_KFIFO(fifo);
+    memset(big, 'x', sizeof(big));
+
+    /* oversized frame is dropped, the next one is decoded */
+    kfifo_frame_decoder_init(&dec, KFIFO_FRAME_COBS, frame, sizeof(frame));
+    kfifo_frame_encode(&fifo, KFIFO_FRAME_COBS, big, sizeof(big));
+    kfifo_frame_encode(&fifo, KFIFO_FRAME_COBS, "ok", 2);
+    if (kfifo_frame_decode(&fifo, &dec) != 2 || memcmp(frame, "ok", 2) != 0 || dec.errors != 1) { fail("errors: cobs oversized"); return; }
+
+    /* truncated COBS block, empty frames */
+    kfifo_in(&fifo, (const unsigned char *)"\x05\x01\x02\x00\x00\x00\x02\x33\x00", 9);
+    if (kfifo_frame_decode(&fifo, &dec) != 1 || frame[0] != 0x33 || dec.errors != 2) { fail("errors: cobs truncated"); return; }
+
+    kfifo_frame_decoder_init(&dec, KFIFO_FRAME_SLIP, frame, sizeof(frame));
+    kfifo_frame_encode(&fifo, KFIFO_FRAME_SLIP, big, sizeof(big));
+    kfifo_frame_encode(&fifo, KFIFO_FRAME_SLIP, "ok", 2);
+    if (kfifo_frame_decode(&fifo, &dec) != 2 || memcmp(frame, "ok", 2) != 0 || dec.errors != 1) { fail("errors: slip oversized"); return; }
+
+    /* invalid escape */
+    kfifo_in(&fifo, (const unsigned char *)"\xc0\x01\xdb\x02\x03\xc0\xc0\x04\xc0", 9);
+    if (kfifo_frame_decode(&fifo, &dec) != 1 || frame[0] != 0x04 || dec.errors != 2) { fail("errors: slip escape"); return; }
+    if (kfifo_frame_decode(&fifo, &dec) != 0 || !kfifo_is_empty(&fifo)) { fail("errors: empty"); return; }
+
+    ok("test_errors");
+}
+
+int main(void)
+{
+    printf("Running kfifo_frame tests...\n");
+
+    test_reference();
+    test_roundtrip(KFIFO_FRAME_COBS, "test_roundtrip_cobs");
+    test_roundtrip(KFIFO_FRAME_SLIP, "test_roundtrip_slip");
+    test_resume();
+    test_full();
+    test_errors();
+
+    if (failures == 0) {
+        printf("All tests passed.\n");
+        return 0;
+    }
+    else {
+        printf("%d test(s) failed.\n", failures);
+        return 2;
+    }
+}
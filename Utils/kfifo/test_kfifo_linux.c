@@ -0,0 +1,259 @@
+/*
+ * test_kfifo_linux.c
+ * Tests for the Linux host extensions of kfifo (mirrored buffer, fd
+ * read/write through readv/writev incl. partial writes and EAGAIN, a
+ * persistent fifo in a mapped file).
+ *
+ * Build (Linux), the mirror tests need -DKFIFO_MIRROR:
+ *   gcc -std=gnu11 -DKFIFO_MIRROR test_kfifo_linux.c kfifo_linux.c kfifo_persist.c kfifo.c -o test_kfifo_linux
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include "kfifo_linux.h"
+#include "kfifo_persist.h"
+
+static int failures = 0;
+
+static void ok(const char *name)
+{
+    printf("[OK] %s\n", name);
+}
+
+static void fail(const char *name)
+{
+    printf("[FAIL] %s\n", name);
+    failures++;
+}
+
+#ifdef KFIFO_MIRROR
+static void test_mirror_alloc(void)
+{
+    DECLARE_KFIFO_PTR(fifo, uint32_t);
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+    if (kfifo_alloc_mirror(&fifo, 10)) { fail("mirror_alloc: alloc"); return; }
+    if (kfifo_size(&fifo) * sizeof(uint32_t) % page != 0) { fail("mirror_alloc: page multiple"); kfifo_free(&fifo); return; }
+
+    /* the second half aliases the first one */
+    ((uint32_t *)fifo.kfifo.data)[3] = 0x12345678;
+    if (((uint32_t *)fifo.kfifo.data)[kfifo_size(&fifo) + 3] != 0x12345678) { fail("mirror_alloc: alias"); kfifo_free(&fifo); return; }
+
+#ifdef KFIFO_OVERWRITE
+    for (unsigned int i = 0; i <= kfifo_size(&fifo); i++)
+        kfifo_put_overwrite(&fifo, i);
+    if (kfifo_discarded(&fifo) != 1) { fail("mirror_alloc: overwrite"); kfifo_free(&fifo); return; }
+#endif /* KFIFO_OVERWRITE */
+
+    kfifo_free(&fifo);
+    if (fifo.kfifo.data != NULL || kfifo_size(&fifo) != 1) { fail("mirror_alloc: free"); return; }
+#ifdef KFIFO_OVERWRITE
+    if (kfifo_discarded(&fifo) != 0) { fail("mirror_alloc: free discarded"); return; }
+#endif /* KFIFO_OVERWRITE */
+
+    /* same error codes as kfifo_alloc */
+    if (kfifo_alloc_mirror(&fifo, 1) != -EINVAL || kfifo_alloc(&fifo, 1) != -EINVAL) { fail("mirror_alloc: einval"); return; }
+    if (kfifo_alloc_mirror(&fifo, 0x80000001U) != -EINVAL || kfifo_alloc(&fifo, 0x80000001U) != -EINVAL) { fail("mirror_alloc: too large"); return; }
+
+    ok("test_mirror_alloc");
+}
+
+static void test_mirror_linear(void)
+{
+    DECLARE_KFIFO_PTR(fifo, unsigned char);
+    unsigned char buf[256], *p;
+    unsigned int size, i, n;
+    struct kfifo_dma_seg seg[2];
+
+    if (kfifo_alloc_mirror(&fifo, 4096)) { fail("mirror_linear: alloc"); return; }
+    size = kfifo_size(&fifo);
+
+    /* move in/out close to the end of the buffer */
+    for (i = 0; i < size - 100; i += n)
+    {
+        n = kfifo_in(&fifo, buf, sizeof(buf) < size - 100 - i ? sizeof(buf) : size - 100 - i);
+        n = kfifo_out(&fifo, buf, n);
+    }
+
+    for (i = 0; i < sizeof(buf); i++)
+        buf[i] = (unsigned char)i;
+    if (kfifo_in(&fifo, buf, sizeof(buf)) != sizeof(buf)) { fail("mirror_linear: in"); kfifo_free(&fifo); return; }
+
+    /* used data wraps, but is handed out as one span */
+    n = kfifo_out_linear_ptr(&fifo, &p, size);
+    if (n != sizeof(buf) || memcmp(p, buf, sizeof(buf)) != 0) { fail("mirror_linear: out span"); kfifo_free(&fifo); return; }
+
+    n = kfifo_dma_out_prepare(&fifo, seg, 2, size);
+    if (n != 1 || seg[0].len != sizeof(buf)) { fail("mirror_linear: dma out"); kfifo_free(&fifo); return; }
+
+    /* all free space as one span */
+    n = kfifo_in_linear_ptr(&fifo, &p, size);
+    if (n != size - sizeof(buf)) { fail("mirror_linear: in span"); kfifo_free(&fifo); return; }
+    memset(p, 0xa5, n);
+    kfifo_in_commit(&fifo, n);
+    if (!kfifo_is_full(&fifo)) { fail("mirror_linear: full"); kfifo_free(&fifo); return; }
+
+    n = kfifo_out(&fifo, buf, sizeof(buf));
+    for (i = 0; i < sizeof(buf); i++)
+        if (buf[i] != (unsigned char)i) { fail("mirror_linear: data"); kfifo_free(&fifo); return; }
+
+    kfifo_free(&fifo);
+    ok("test_mirror_linear");
+}
+#endif /* KFIFO_MIRROR */
+
+static void test_fd(void)
+{
+    DECLARE_KFIFO(fifo, unsigned char, 64);
+    INIT_KFIFO(fifo);
+
+    unsigned char buf[64];
+    unsigned int i;
+    int fd[2];
+
+    if (pipe(fd)) { fail("fd: pipe"); return; }
+
+    for (i = 0; i < sizeof(buf); i++)
+        buf[i] = (unsigned char)i;
+
+    /* move in/out close to the end of the buffer, the data wraps */
+    kfifo_in(&fifo, buf, 50);
+    kfifo_skip_count(&fifo, 50);
+    kfifo_in(&fifo, buf, 30);
+    if (kfifo_out_linear(&fifo, NULL, 30) != 14) { fail("fd: wrap"); goto out; }
+
+    /* both parts are written with one call */
+    if (kfifo_out_fd(&fifo, fd[1], 64) != 30 || !kfifo_is_empty(&fifo)) { fail("fd: out"); goto out; }
+    if (kfifo_out_fd(&fifo, fd[1], 64) != 0) { fail("fd: out empty"); goto out; }
+
+    /* max limits the transfer */
+    if (kfifo_in_fd(&fifo, fd[0], 10) != 10 || kfifo_len(&fifo) != 10) { fail("fd: in max"); goto out; }
+    if (kfifo_in_fd(&fifo, fd[0], 64) != 20 || kfifo_len(&fifo) != 30) { fail("fd: in"); goto out; }
+
+    memset(buf, 0, sizeof(buf));
+    if (kfifo_out(&fifo, buf, 64) != 30) { fail("fd: out data"); goto out; }
+    for (i = 0; i < 30; i++)
+        if (buf[i] != (unsigned char)i) { fail("fd: data"); goto out; }
+
+    /* end of file */
+    close(fd[1]);
+    fd[1] = -1;
+    if (kfifo_in_fd(&fifo, fd[0], 64) != 0 || !kfifo_is_empty(&fifo)) { fail("fd: eof"); goto out; }
+
+    ok("test_fd");
+out:
+    close(fd[0]);
+    if (fd[1] >= 0)
+        close(fd[1]);
+}
+
+static void test_fd_nonblock(void)
+{
+    DECLARE_KFIFO(fifo, unsigned char, 4096);
+    INIT_KFIFO(fifo);
+
+    unsigned char buf[1024];
+    unsigned int total = 0, i, j;
+    ssize_t n;
+    int fd[2];
+
+    if (pipe(fd)) { fail("fd_nonblock: pipe"); return; }
+    fcntl(fd[0], F_SETFL, O_NONBLOCK);
+    fcntl(fd[1], F_SETFL, O_NONBLOCK);
+
+    /* nothing to read */
+    errno = 0;
+    if (kfifo_in_fd(&fifo, fd[0], 64) != -1 || errno != EAGAIN || !kfifo_is_empty(&fifo)) { fail("fd_nonblock: read EAGAIN"); goto out; }
+
+    /* fill the pipe, the last write is partial and the rest stays in the fifo */
+    for (;;)
+    {
+        for (i = 0; i < sizeof(buf); i++)
+            buf[i] = (unsigned char)(total + kfifo_len(&fifo) + i);
+        kfifo_in(&fifo, buf, kfifo_avail(&fifo) < sizeof(buf) ? kfifo_avail(&fifo) : sizeof(buf));
+
+        n = kfifo_out_fd(&fifo, fd[1], ~0U);
+        if (n < 0)
+            break;
+        total += (unsigned int)n;
+    }
+    if (errno != EAGAIN || kfifo_is_empty(&fifo)) { fail("fd_nonblock: write EAGAIN"); goto out; }
+
+    /* drain the pipe and check that no byte was lost or duplicated */
+    for (i = 0; i < total;)
+    {
+        n = read(fd[0], buf, sizeof(buf));
+        if (n <= 0) { fail("fd_nonblock: read"); goto out; }
+        for (j = 0; j < (unsigned int)n; j++, i++)
+            if (buf[j] != (unsigned char)i) { fail("fd_nonblock: data"); goto out; }
+    }
+
+    /* the rest of the data follows */
+    n = kfifo_out_fd(&fifo, fd[1], ~0U);
+    if (n <= 0 || read(fd[0], buf, 1) != 1 || buf[0] != (unsigned char)i) { fail("fd_nonblock: rest"); goto out; }
+
+    ok("test_fd_nonblock");
+out:
+    close(fd[0]);
+    close(fd[1]);
+}
+
+static void test_persist_file(void)
+{
+    DECLARE_KFIFO_PERSIST(fifo, uint16_t);
+    char path[] = "/tmp/test_kfifo_persist_XXXXXX";
+    size_t len = KFIFO_PERSIST_BYTES(uint16_t, 1024);
+    uint16_t v;
+    void *p;
+    int fd;
+
+    fd = mkstemp(path);
+    if (fd < 0) { fail("persist_file: mkstemp"); return; }
+    close(fd);
+
+    p = kfifo_persist_map_file(path, len);
+    if (!p) { fail("persist_file: map"); unlink(path); return; }
+    if (kfifo_persist_attach(fifo, p, len) != 0 || kfifo_size(fifo) != 1024) { fail("persist_file: format"); goto out; }
+    kfifo_put(fifo, 0x1234);
+    kfifo_put(fifo, 0x5678);
+    munmap(p, len);
+
+    /* as after a restart of the process */
+    p = kfifo_persist_map_file(path, len);
+    if (!p) { fail("persist_file: remap"); unlink(path); return; }
+    if (kfifo_persist_attach(fifo, p, len) != 1 || kfifo_len(fifo) != 2) { fail("persist_file: attach"); goto out; }
+    if (!kfifo_get(fifo, &v) || v != 0x1234) { fail("persist_file: data"); goto out; }
+
+    ok("test_persist_file");
+out:
+    munmap(p, len);
+    unlink(path);
+}
+
+int main(void)
+{
+    printf("Running kfifo_linux tests...\n");
+
+#ifdef KFIFO_MIRROR
+    test_mirror_alloc();
+    test_mirror_linear();
+#endif /* KFIFO_MIRROR */
+    test_fd();
+    test_fd_nonblock();
+    test_persist_file();
+
+    if (failures == 0) {
+        printf("All tests passed.\n");
+        return 0;
+    }
+    else {
+        printf("%d test(s) failed.\n", failures);
+        return 2;
+    }
+}
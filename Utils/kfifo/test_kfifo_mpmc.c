@@ -0,0 +1,177 @@
+/*
+ * test_kfifo_mpmc.c
+ * Tests for the mpmc kfifo (static + dynamic, full/empty, wrap, and a
+ * multi-threaded producer/consumer check).
+ *
+ * Build (Linux):
+ *   gcc -std=gnu11 -pthread test_kfifo_mpmc.c kfifo_mpmc.c -o test_kfifo_mpmc
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+#include "kfifo_mpmc.h"
+
+static int failures = 0;
+
+static void ok(const char *name)
+{
+    printf("[OK] %s\n", name);
+}
+
+static void fail(const char *name)
+{
+    printf("[FAIL] %s\n", name);
+    failures++;
+}
+
+static void test_static_put_get(void)
+{
+    DECLARE_KFIFO_MPMC(fifo, int, 4);
+    INIT_KFIFO_MPMC(fifo);
+
+    int v;
+    unsigned int i, ret;
+
+    if (!kfifo_mpmc_is_empty(&fifo)) { fail("static_put_get: empty after init"); return; }
+    if (kfifo_mpmc_get(&fifo, &v) != 0) { fail("static_put_get: get on empty"); return; }
+
+    /* several laps to exercise the slot sequence numbers */
+    for (i = 0; i < 10; i++)
+    {
+        ret = kfifo_mpmc_put(&fifo, (int)i);
+        ret += kfifo_mpmc_put(&fifo, (int)(i + 100));
+        if (ret != 2) { fail("static_put_get: put"); return; }
+        if (kfifo_mpmc_len(&fifo) != 2) { fail("static_put_get: len"); return; }
+        if (kfifo_mpmc_get(&fifo, &v) != 1 || v != (int)i) { fail("static_put_get: get first"); return; }
+        if (kfifo_mpmc_get(&fifo, &v) != 1 || v != (int)(i + 100)) { fail("static_put_get: get second"); return; }
+    }
+
+    ok("test_static_put_get");
+}
+
+static void test_full(void)
+{
+    DECLARE_KFIFO_MPMC(fifo, uint16_t, 4);
+    INIT_KFIFO_MPMC(fifo);
+
+    uint16_t in[6] = {1, 2, 3, 4, 5, 6};
+    uint16_t out[6] = {0};
+    unsigned int ret;
+
+    ret = kfifo_mpmc_in(&fifo, in, 6);
+    if (ret != 4) { fail("full: in count"); return; }
+    if (kfifo_mpmc_put(&fifo, 7) != 0) { fail("full: put on full"); return; }
+
+    ret = kfifo_mpmc_out(&fifo, out, 6);
+    if (ret != 4) { fail("full: out count"); return; }
+    if (memcmp(in, out, 4 * sizeof(uint16_t)) != 0) { fail("full: data mismatch"); return; }
+
+    ok("test_full");
+}
+
+static void test_dynamic(void)
+{
+    DECLARE_KFIFO_MPMC_PTR(fifo, uint32_t);
+    uint32_t v;
+
+    if (kfifo_mpmc_alloc(&fifo, 0x80000001U) != -EINVAL) { fail("dynamic: too large"); return; }
+    if (kfifo_mpmc_alloc(&fifo, 5)) { fail("dynamic: alloc"); return; }
+    if (kfifo_mpmc_size(&fifo) != 8) { fail("dynamic: size roundup"); kfifo_mpmc_free(&fifo); return; }
+
+    for (v = 0; v < 8; v++)
+        if (!kfifo_mpmc_put(&fifo, v)) { fail("dynamic: put"); kfifo_mpmc_free(&fifo); return; }
+
+    for (uint32_t i = 0; i < 8; i++)
+        if (!kfifo_mpmc_get(&fifo, &v) || v != i) { fail("dynamic: get"); kfifo_mpmc_free(&fifo); return; }
+
+    kfifo_mpmc_free(&fifo);
+    ok("test_dynamic");
+}
+
+#define MT_THREADS 4
+#define MT_ITEMS 100000U
+
+static DECLARE_KFIFO_MPMC(mt_fifo, uint32_t, 64);
+static _Atomic unsigned long long mt_sum;
+static _Atomic unsigned int mt_count;
+
+static void *mt_producer(void *arg)
+{
+    uint32_t base = (uint32_t)(uintptr_t)arg * MT_ITEMS;
+
+    for (uint32_t i = 0; i < MT_ITEMS;)
+    {
+        if (kfifo_mpmc_put(&mt_fifo, base + i))
+            i++;
+        else
+            sched_yield(); // let a preempted thread finish its slot on a single CPU
+    }
+    return NULL;
+}
+
+static void *mt_consumer(void *arg)
+{
+    uint32_t v;
+
+    (void)arg;
+    while (atomic_load(&mt_count) < MT_THREADS * MT_ITEMS)
+    {
+        if (kfifo_mpmc_get(&mt_fifo, &v))
+        {
+            atomic_fetch_add(&mt_sum, v);
+            atomic_fetch_add(&mt_count, 1);
+        }
+        else
+            sched_yield();
+    }
+    return NULL;
+}
+
+static void test_multi_thread(void)
+{
+    pthread_t p[MT_THREADS], c[MT_THREADS];
+    unsigned long long n = (unsigned long long)MT_THREADS * MT_ITEMS;
+    unsigned int i;
+
+    INIT_KFIFO_MPMC(mt_fifo);
+
+    for (i = 0; i < MT_THREADS; i++)
+    {
+        pthread_create(&c[i], NULL, mt_consumer, NULL);
+        pthread_create(&p[i], NULL, mt_producer, (void *)(uintptr_t)i);
+    }
+    for (i = 0; i < MT_THREADS; i++)
+    {
+        pthread_join(p[i], NULL);
+        pthread_join(c[i], NULL);
+    }
+
+    if (atomic_load(&mt_count) != n) { fail("multi_thread: count"); return; }
+    if (atomic_load(&mt_sum) != n * (n - 1) / 2) { fail("multi_thread: sum"); return; }
+    if (!kfifo_mpmc_is_empty(&mt_fifo)) { fail("multi_thread: not empty"); return; }
+
+    ok("test_multi_thread");
+}
+
+int main(void)
+{
+    printf("Running kfifo_mpmc tests...\n");
+
+    test_static_put_get();
+    test_full();
+    test_dynamic();
+    test_multi_thread();
+
+    if (failures == 0) {
+        printf("All tests passed.\n");
+        return 0;
+    }
+    else {
+        printf("%d test(s) failed.\n", failures);
+        return 2;
+    }
+}
@@ -0,0 +1,144 @@
+/*
+ * test_kfifo_persist.c
+ * Tests for the persistent kfifo (format, recovery at a different address,
+ * rejected headers, record fifos).
+ *
+ * Build (Linux):
+ *   gcc -std=gnu11 test_kfifo_persist.c kfifo_persist.c kfifo.c -o test_kfifo_persist
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "kfifo_persist.h"
+
+#define REGION_BYTES KFIFO_PERSIST_BYTES(uint32_t, 64)
+
+/* two regions, the second one stands for the same memory after a restart */
+static unsigned char region[REGION_BYTES] __attribute__((aligned(KFIFO_PERSIST_ALIGN)));
+static unsigned char region2[REGION_BYTES] __attribute__((aligned(KFIFO_PERSIST_ALIGN)));
+
+static int failures = 0;
+
+static void ok(const char *name)
+{
+    printf("[OK] %s\n", name);
+}
+
+static void fail(const char *name)
+{
+    printf("[FAIL] %s\n", name);
+    failures++;
+}
+
+static void test_recover(void)
+{
+    DECLARE_KFIFO_PERSIST(fifo, uint32_t);
+    uint32_t buf[64];
+    unsigned int i;
+
+    memset(region, 0xa5, sizeof(region));
+    if (kfifo_persist_attach(fifo, region, sizeof(region)) != 0) { fail("recover: format"); return; }
+    if (kfifo_size(fifo) != 64 || !kfifo_is_empty(fifo)) { fail("recover: empty"); return; }
+
+    /* wrap the data around the end of the buffer */
+    for (i = 0; i < 64; i++)
+        buf[i] = i;
+    kfifo_in(fifo, buf, 50);
+    kfifo_skip_count(fifo, 40);
+    kfifo_in(fifo, buf + 50, 14);
+
+    /* the same content at another address, as after mapping a file again */
+    memcpy(region2, region, sizeof(region));
+    memset(region, 0, sizeof(region));
+    fifo = NULL;
+
+    if (kfifo_persist_attach(fifo, region2, sizeof(region2)) != 1) { fail("recover: attach"); return; }
+    if (fifo->kfifo.data != region2 + sizeof(struct kfifo_persist)) { fail("recover: data pointer"); return; }
+    if (kfifo_len(fifo) != 24) { fail("recover: len"); return; }
+
+    memset(buf, 0, sizeof(buf));
+    if (kfifo_out(fifo, buf, 64) != 24) { fail("recover: out"); return; }
+    for (i = 0; i < 24; i++)
+        if (buf[i] != 40 + i) { fail("recover: data"); return; }
+
+    /* attaching again keeps the (now empty) fifo */
+    kfifo_put(fifo, 7);
+    if (kfifo_persist_attach(fifo, region2, sizeof(region2)) != 1 || kfifo_len(fifo) != 1) { fail("recover: reattach"); return; }
+
+    if (kfifo_persist_format(fifo, region2, sizeof(region2)) != 0 || !kfifo_is_empty(fifo)) { fail("recover: format"); return; }
+
+    ok("test_recover");
+}
+
+static void test_reject(void)
+{
+    DECLARE_KFIFO_PERSIST(fifo, uint32_t);
+    DECLARE_KFIFO_PERSIST(fifo16, uint16_t);
+    struct kfifo_persist *hdr = (struct kfifo_persist *)region;
+
+    kfifo_persist_attach(fifo, region, sizeof(region));
+    kfifo_put(fifo, 1);
+
+    /* a different element size formats the region */
+    if (kfifo_persist_attach(fifo16, region, sizeof(region)) != 0 || !kfifo_is_empty(fifo16) || kfifo_size(fifo16) != 128) { fail("reject: esize"); return; }
+
+    /* corrupted mask */
+    kfifo_persist_attach(fifo, region, sizeof(region));
+    kfifo_put(fifo, 1);
+    hdr->kfifo.mask = 127;
+    if (kfifo_persist_attach(fifo, region, sizeof(region)) != 0 || kfifo_size(fifo) != 64) { fail("reject: crc"); return; }
+
+    /* in - out bigger than the fifo */
+    kfifo_put(fifo, 1);
+    hdr->kfifo.out -= 100;
+    if (kfifo_persist_attach(fifo, region, sizeof(region)) != 0 || !kfifo_is_empty(fifo)) { fail("reject: index"); return; }
+
+    /* the region is smaller than the fifo that was formatted in it */
+    if (kfifo_persist_attach(fifo, region, KFIFO_PERSIST_BYTES(uint32_t, 32)) != 0 || kfifo_size(fifo) != 32) { fail("reject: len"); return; }
+
+    if (kfifo_persist_attach(fifo, region, sizeof(struct kfifo_persist)) != -EINVAL || fifo != NULL) { fail("reject: too small"); return; }
+    if (kfifo_persist_attach(fifo, region + 4, sizeof(region) - 4) != -EINVAL) { fail("reject: misaligned"); return; }
+
+    ok("test_reject");
+}
+
+static void test_record(void)
+{
+    struct kfifo_rec_ptr_2 *fifo;
+    DECLARE_KFIFO_PERSIST(bytes, unsigned char);
+    char buf[32];
+
+    if (kfifo_persist_attach(fifo, region, sizeof(region)) != 0) { fail("record: format"); return; }
+    kfifo_in(fifo, "hello", 5);
+    kfifo_in(fifo, "persistent", 10);
+
+    /* a byte fifo must not take over the records */
+    memcpy(region2, region, sizeof(region));
+    if (kfifo_persist_attach(bytes, region2, sizeof(region2)) != 0) { fail("record: recsize"); return; }
+
+    if (kfifo_persist_attach(fifo, region, sizeof(region)) != 1) { fail("record: attach"); return; }
+    if (kfifo_out(fifo, buf, sizeof(buf)) != 5 || memcmp(buf, "hello", 5) != 0) { fail("record: first"); return; }
+    if (kfifo_out(fifo, buf, sizeof(buf)) != 10 || memcmp(buf, "persistent", 10) != 0) { fail("record: second"); return; }
+
+    ok("test_record");
+}
+
+int main(void)
+{
+    printf("Running kfifo_persist tests...\n");
+
+    test_recover();
+    test_reject();
+    test_record();
+
+    if (failures == 0) {
+        printf("All tests passed.\n");
+        return 0;
+    }
+    else {
+        printf("%d test(s) failed.\n", failures);
+        return 2;
+    }
+}
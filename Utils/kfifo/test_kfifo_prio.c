@@ -0,0 +1,163 @@
+/*
+ * test_kfifo_prio.c
+ * Tests for the priority fifo (ordering across lanes, full lanes, lanes
+ * drained through kfifo.h, one writer and one reader thread).
+ *
+ * Build (Linux):
+ *   gcc -std=gnu11 -pthread test_kfifo_prio.c kfifo_prio.c kfifo.c -o test_kfifo_prio
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+#include "kfifo_prio.h"
+
+static int failures = 0;
+
+static void ok(const char *name)
+{
+    printf("[OK] %s\n", name);
+}
+
+static void fail(const char *name)
+{
+    printf("[FAIL] %s\n", name);
+    failures++;
+}
+
+static void test_order(void)
+{
+    DECLARE_KFIFO_PRIO(fifo, uint32_t, 8, 4);
+    uint32_t v, buf[8];
+    unsigned int prio;
+
+    INIT_KFIFO_PRIO(fifo);
+    if (kfifo_prio_lanes(&fifo) != 4 || !kfifo_prio_is_empty(&fifo)) { fail("order: init"); return; }
+    if (kfifo_prio_get(&fifo, &v, &prio) != 0) { fail("order: get empty"); return; }
+
+    kfifo_prio_put(&fifo, 3, 30);
+    kfifo_prio_put(&fifo, 3, 31);
+    kfifo_prio_put(&fifo, 1, 10);
+    kfifo_prio_put(&fifo, 2, 20);
+    kfifo_prio_put(&fifo, 1, 11);
+
+    if (!kfifo_prio_get(&fifo, &v, &prio) || v != 10 || prio != 1) { fail("order: first"); return; }
+
+    /* a more urgent element overtakes the rest */
+    kfifo_prio_put(&fifo, 0, 1);
+    if (!kfifo_prio_get(&fifo, &v, NULL) || v != 1) { fail("order: urgent"); return; }
+    if (!kfifo_prio_get(&fifo, &v, &prio) || v != 11 || prio != 1) { fail("order: second"); return; }
+    if (!kfifo_prio_get(&fifo, &v, &prio) || v != 20 || prio != 2) { fail("order: third"); return; }
+
+    /* bulk read stays within one lane */
+    kfifo_prio_put(&fifo, 3, 32);
+    if (kfifo_prio_out(&fifo, buf, 8, &prio) != 3 || prio != 3 || buf[0] != 30 || buf[2] != 32) { fail("order: bulk"); return; }
+    if (!kfifo_prio_is_empty(&fifo) || atomic_load(&fifo.kfifo.ready) != 0) { fail("order: empty"); return; }
+
+    ok("test_order");
+}
+
+static void test_full(void)
+{
+    DECLARE_KFIFO_PRIO(fifo, uint8_t, 4, 2);
+    uint8_t buf[8] = {1, 2, 3, 4, 5, 6, 7, 8}, v;
+
+    INIT_KFIFO_PRIO(fifo);
+    if (kfifo_prio_in(&fifo, 1, buf, 8) != 4) { fail("full: in"); return; }
+    if (kfifo_prio_put(&fifo, 1, 9) != 0) { fail("full: put"); return; }
+    if (kfifo_prio_put(&fifo, 0, 9) != 1) { fail("full: other lane"); return; }
+    if (!kfifo_prio_get(&fifo, &v, NULL) || v != 9) { fail("full: get"); return; }
+    if (!kfifo_prio_get(&fifo, &v, NULL) || v != 1) { fail("full: low"); return; }
+
+    ok("test_full");
+}
+
+static void test_drained(void)
+{
+    DECLARE_KFIFO_PRIO(fifo, uint16_t, 8, 3);
+    uint16_t v;
+
+    INIT_KFIFO_PRIO(fifo);
+    kfifo_prio_put(&fifo, 0, 1);
+    kfifo_prio_put(&fifo, 2, 3);
+
+    /* the reader empties lane 0 with kfifo.h, its bit is left over */
+    if (!kfifo_get(&fifo.lanes[0], &v) || v != 1) { fail("drained: kfifo_get"); return; }
+    if (!kfifo_prio_get(&fifo, &v, NULL) || v != 3) { fail("drained: next lane"); return; }
+    if (!kfifo_prio_is_empty(&fifo)) { fail("drained: empty"); return; }
+
+    ok("test_drained");
+}
+
+#define THREAD_ITEMS 200000U
+
+static DECLARE_KFIFO_PRIO(tfifo, uint32_t, 64, 3);
+
+static void *writer(void *arg)
+{
+    uint32_t i;
+
+    (void)arg;
+    /* the value carries its lane and a per lane sequence number */
+    for (i = 0; i < THREAD_ITEMS; i++)
+    {
+        unsigned int prio = i % 7 == 0 ? 0 : i % 3 == 0 ? 1 : 2;
+
+        while (!kfifo_prio_put(&tfifo, prio, (i << 2) | prio))
+            sched_yield();
+    }
+    return NULL;
+}
+
+static void test_threads(void)
+{
+    uint32_t last[3], v;
+    int seen[3] = {0, 0, 0};
+    unsigned int got = 0, prio, bad = 0;
+    pthread_t t;
+
+    INIT_KFIFO_PRIO(tfifo);
+    pthread_create(&t, NULL, writer, NULL);
+
+    while (got < THREAD_ITEMS)
+    {
+        if (!kfifo_prio_get(&tfifo, &v, &prio))
+        {
+            sched_yield();
+            continue;
+        }
+        /* nothing lost, nothing reordered within a lane */
+        if ((v & 3) != prio || (seen[prio] && (v >> 2) <= last[prio]))
+            bad++;
+        last[prio] = v >> 2;
+        seen[prio] = 1;
+        got++;
+    }
+    pthread_join(t, NULL);
+
+    if (bad || !kfifo_prio_is_empty(&tfifo)) { fail("test_threads"); return; }
+
+    ok("test_threads");
+}
+
+int main(void)
+{
+    printf("Running kfifo_prio tests...\n");
+
+    test_order();
+    test_full();
+    test_drained();
+    test_threads();
+
+    if (failures == 0) {
+        printf("All tests passed.\n");
+        return 0;
+    }
+    else {
+        printf("%d test(s) failed.\n", failures);
+        return 2;
+    }
+}
@@ -0,0 +1,219 @@
+/*
+ * bench_async.c
+ * Caller-side cost of log_printf() with a blocking output function, which
+ * write()s every line like printf -> HAL_UART_Transmit does, against the
+ * log_async sink drained by the LOG_ASYNC_POSIX writer thread.
+ *
+ * 1. /dev/null: the bare cost per call, a write() per line against a copy into
+ *    the fifo plus waking the writer thread. Writing to /dev/null is about as
+ *    cheap as the wakeup, so the async sink does not win here (on a single
+ *    CPU the writer thread also runs inside the caller's time slice); on the
+ *    target the wakeup is a DMA start.
+ * 2. slow device: a pipe shrunk to one page and read by a thread at the rate
+ *    of a 1 Mbaud UART. The page of pipe buffer acts like a hardware FIFO, so
+ *    bursts larger than that are sent: the blocking sink stalls the caller
+ *    until the device catches up, the async sink keeps the burst in its
+ *    buffer (or handles the overflow by LOG_ASYNC_POLICY). Latency per call
+ *    and the log_async counters are printed.
+ *
+ * Build (Linux):
+ *   gcc -O2 -std=gnu11 -pthread -DLOG_ASYNC_POSIX -DLOG_ASYNC_SIZE=8192 -I.. -I../../kfifo bench_async.c ../log.c ../log_async.c ../../kfifo/kfifo.c -o bench_async
+ * With the default 1 KB buffer the burst does not fit, add
+ * -DLOG_ASYNC_POLICY=LOG_ASYNC_DROP_OLDEST / LOG_ASYNC_BLOCK to compare the policies.
+ */
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "log.h"
+#include "log_async.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLES() __rdtsc()
+#define UNIT "cycles"
+#else
+#define CYCLES() ns_now()
+#define UNIT "ns"
+#endif
+
+#define ROUNDS 20000U     // lines per mode on /dev/null
+#define BURSTS 20U        // bursts on the slow device
+#define BURST_LINES 64U   // lines per burst, about 4.5 KB
+#define PERIOD_MS 60U     // one burst every PERIOD_MS, the device needs ~45 ms
+#define DEV_RATE 100000U  // device bytes/s, 1 Mbaud 8N1
+
+static int out_fd;
+static int dev_rd;
+static volatile size_t dev_bytes;
+static uint64_t lat[BURSTS * BURST_LINES];
+
+static inline uint64_t ns_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void sleep_until(uint64_t t)
+{
+    struct timespec ts = {(time_t)(t / 1000000000ULL), (long)(t % 1000000000ULL)};
+
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+/* what printf + HAL_UART_Transmit does: the caller waits for the device */
+static void blocking_output(const char *msg)
+{
+    size_t len = strlen(msg);
+
+    while (len)
+    {
+        ssize_t n = write(out_fd, msg, len);
+
+        if (n <= 0)
+            break;
+        msg += n;
+        len -= n;
+    }
+}
+
+/* the device: reads the pipe no faster than DEV_RATE */
+static void *device(void *arg)
+{
+    uint64_t t0 = ns_now();
+    char buf[64];
+
+    (void)arg;
+    for (;;)
+    {
+        ssize_t n = read(dev_rd, buf, sizeof(buf));
+
+        if (n <= 0)
+            break;
+        dev_bytes += n;
+        sleep_until(t0 + (uint64_t)dev_bytes * 1000000000ULL / DEV_RATE);
+    }
+    return NULL;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+static void bench_null(const char *name, int async)
+{
+    uint64_t t0, t = 0;
+    unsigned int i;
+
+    out_fd = open("/dev/null", O_WRONLY);
+    if (async)
+    {
+        log_async_posix_start(out_fd);
+        set_log_output(log_async_output);
+    }
+    else
+    {
+        set_log_output(blocking_output);
+    }
+
+    for (i = 0; i < ROUNDS; i++)
+    {
+        t0 = CYCLES();
+        log_printf(LOG_INFO, "ctrl: i=%u err=%d state=%s\n", i, (int)(ROUNDS - i), "run");
+        t += CYCLES() - t0;
+        /* let the writer keep up, like an idle loop between log statements */
+        if (async && (i & 31) == 31)
+            while (log_async_pending() > LOG_ASYNC_SIZE / 2)
+                sched_yield();
+    }
+
+    if (async)
+        log_async_posix_stop();
+    close(out_fd);
+    printf("/dev/null %-9s %8.1f %s/call\n", name, (double)t / ROUNDS, UNIT);
+}
+
+static void bench_device(const char *name, int async)
+{
+    struct log_async_stats st = {0};
+    pthread_t dev;
+    uint64_t t_start, sum = 0;
+    size_t total;
+    unsigned int b, i, k = 0;
+    int p[2];
+
+    if (pipe(p) < 0)
+        exit(1);
+    fcntl(p[1], F_SETPIPE_SZ, 4096);
+    out_fd = p[1];
+    dev_rd = p[0];
+    dev_bytes = 0;
+    pthread_create(&dev, NULL, device, NULL);
+
+    if (async)
+    {
+        log_async_posix_start(out_fd);
+        set_log_output(log_async_output);
+    }
+    else
+    {
+        set_log_output(blocking_output);
+    }
+
+    t_start = ns_now();
+    for (b = 0; b < BURSTS; b++)
+    {
+        for (i = 0; i < BURST_LINES; i++)
+        {
+            uint64_t t0 = ns_now();
+
+            log_printf(LOG_INFO, "ctrl: burst=%u i=%u err=%d state=%s\n", b, i, (int)(i * 7 - b), "run");
+            lat[k++] = ns_now() - t0;
+        }
+        sleep_until(t_start + (uint64_t)(b + 1) * PERIOD_MS * 1000000ULL);
+    }
+
+    if (async)
+    {
+        log_async_get_stats(&st);
+        log_async_posix_stop();
+    }
+    close(out_fd);
+    pthread_join(dev, NULL);
+    close(dev_rd);
+    total = dev_bytes;
+
+    for (i = 0; i < k; i++)
+        sum += lat[i];
+    qsort(lat, k, sizeof(lat[0]), cmp_u64);
+    printf("device    %-9s avg %8.2f us  p50 %8.2f us  p99 %8.2f us  max %8.2f us  received %zu bytes\n",
+           name, sum / 1000.0 / k, lat[k / 2] / 1000.0, lat[k * 99 / 100] / 1000.0, lat[k - 1] / 1000.0, total);
+    if (async)
+        printf("          log_async written %u sent %u dropped %u (%u bytes) blocked %u peak %u/%u\n",
+               (unsigned)st.written, (unsigned)st.sent, (unsigned)st.dropped, (unsigned)st.dropped_bytes,
+               (unsigned)st.blocked, (unsigned)st.peak, (unsigned)LOG_ASYNC_SIZE);
+}
+
+int main(void)
+{
+    static const char *const policy[] = {"DROP_NEWEST", "DROP_OLDEST", "BLOCK"};
+
+    printf("LOG_ASYNC_SIZE %u, LOG_ASYNC_CHUNK %u, LOG_ASYNC_POLICY %s\n",
+           (unsigned)LOG_ASYNC_SIZE, (unsigned)LOG_ASYNC_CHUNK, policy[LOG_ASYNC_POLICY]);
+    bench_null("blocking", 0);
+    bench_null("async", 1);
+    bench_device("blocking", 0);
+    bench_device("async", 1);
+    return 0;
+}
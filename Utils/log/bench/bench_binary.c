@@ -0,0 +1,136 @@
+/*
+ * bench_binary.c
+ * Bytes on the wire per message: the text line of log_message() (what the
+ * printf output sends today, with the ANSI colors) against the LOG_BINARY
+ * frame of log_printf() for the same statements, plus the caller's cost of
+ * both. The binary stream is written to log.bin and the text to log.txt, so
+ * the decoder can be checked against it:
+ *
+ *   ../tools/log_decode -c bench_binary log.bin | cmp - log.txt
+ *
+ * Build (Linux):
+ *   gcc -O2 -std=gnu11 -DLOG_BINARY -I.. bench_binary.c ../log.c -o bench_binary
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include "log.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLES() __rdtsc()
+#define UNIT "cycles"
+#else
+static inline uint64_t ns_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#define CYCLES() ns_now()
+#define UNIT "ns"
+#endif
+
+#define ROUNDS 1000U
+
+static FILE *f_bin, *f_txt;
+static size_t bin_bytes, txt_bytes;
+static unsigned int msgs;
+static uint64_t t_bin, t_txt;
+
+static void bin_output(const void *data, unsigned int len)
+{
+    fwrite(data, 1, len, f_bin);
+    bin_bytes += len;
+}
+
+static void txt_output(const char *msg)
+{
+    fputs(msg, f_txt);
+    while (*msg++)
+        txt_bytes++;
+}
+
+/* the same statement in both formats, on the same line */
+#define LOG_BOTH(level, ...)                                     \
+    do                                                           \
+    {                                                            \
+        uint64_t t0 = CYCLES();                                  \
+        log_printf(level, __VA_ARGS__);                          \
+        uint64_t t1 = CYCLES();                                  \
+        log_message(level, __FUNCTION__, __LINE__, __VA_ARGS__); \
+        t_bin += t1 - t0;                                        \
+        t_txt += CYCLES() - t1;                                  \
+        msgs++;                                                  \
+    } while (0)
+
+/*
+ * the argument type does not match the conversion: the decoder prints the
+ * argument by its own type (the string of a char array for %p, given as
+ * txt_fmt) and the following arguments stay aligned
+ */
+#define LOG_MISMATCH(level, fmt, txt_fmt, ...)                            \
+    do                                                                    \
+    {                                                                     \
+        log_printf(level, fmt, __VA_ARGS__);                              \
+        log_message(level, __FUNCTION__, __LINE__, txt_fmt, __VA_ARGS__); \
+        msgs++;                                                           \
+    } while (0)
+
+static void mismatch(void)
+{
+    char name[] = "uart1";
+    const uint8_t dev[] = "bme280";
+
+    LOG_MISMATCH(LOG_INFO, "ptr=%p n=%d\n", "ptr=%s n=%d\n", name, 42);
+    LOG_BOTH(LOG_INFO, "u=%s n=%d\n", dev, 7);
+}
+
+static void control_loop(unsigned int i)
+{
+    LOG_BOTH(LOG_DEBUG, "ctrl: i=%u err=%d state=%s\n", i, (int)(i % 200) - 100, i & 1 ? "run" : "idle");
+    LOG_BOTH(LOG_DEBUG, "pid: p=%ld i=%ld out=%d\n", (long)i * 3 - 1500, -(long)i, (int)(i * 7 % 1000));
+}
+
+static void sensors(unsigned int i)
+{
+    LOG_BOTH(LOG_INFO, "adc ch%d = %u mV, temp %.2f C\n", (int)(i % 8), 3300U * (i % 100) / 100, 20.0 + i * 0.01);
+    if (i % 10 == 0)
+        LOG_BOTH(LOG_WARN, "uart rx overflow, lost %u bytes (0x%08x)\n", i % 17, 0xdead0000U | i);
+    if (i % 100 == 0)
+        LOG_BOTH(LOG_ERROR, "i2c timeout on dev %p, retry %d\n", (void *)(uintptr_t)(0x40005400U + i), (int)i / 100);
+}
+
+int main(void)
+{
+    unsigned int i;
+
+    f_bin = fopen("log.bin", "wb");
+    f_txt = fopen("log.txt", "w");
+    if (!f_bin || !f_txt)
+    {
+        perror("fopen");
+        return 1;
+    }
+    set_log_binary_output(bin_output);
+    set_log_output(txt_output);
+
+    LOG_BOTH(LOG_INFO, "boot\n");
+    mismatch();
+    for (i = 0; i < ROUNDS; i++)
+    {
+        control_loop(i);
+        sensors(i);
+    }
+    fclose(f_bin);
+    fclose(f_txt);
+
+    printf("%u messages\n", msgs);
+    printf("text (log_message): %6.1f bytes/msg, %7.1f %s/call\n",
+           (double)txt_bytes / msgs, (double)t_txt / msgs, UNIT);
+    printf("LOG_BINARY        : %6.1f bytes/msg, %7.1f %s/call\n",
+           (double)bin_bytes / msgs, (double)t_bin / msgs, UNIT);
+    return 0;
+}
@@ -0,0 +1,83 @@
+/*
+ * bench_log.c
+ * Cost of one log_printf() call on the caller's side with the immediate
+ * mode (vsnprintf twice + snprintf + output) and with LOG_DEFERRED (only the
+ * arguments are recorded). In the deferred build the cost of log_process()
+ * per message, which runs later from the idle hook, is printed as well.
+ * The output function discards the text.
+ *
+ * Build (Linux):
+ *   gcc -O2 -std=gnu11 -I.. bench_log.c ../log.c -o bench_log
+ *   gcc -O2 -std=gnu11 -DLOG_DEFERRED -I.. -I../../kfifo bench_log.c ../log.c ../../kfifo/kfifo.c -o bench_log_deferred
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include "log.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLES() __rdtsc()
+#define UNIT "cycles"
+#else
+static inline uint64_t ns_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#define CYCLES() ns_now()
+#define UNIT "ns"
+#endif
+
+#define BATCH 32 // messages per idle pass, fits into the default record buffer
+#define ROUNDS 20000U
+
+static size_t out_bytes;
+static uint32_t ticks;
+
+static void null_output(const char *msg)
+{
+    while (*msg++)
+        out_bytes++;
+}
+
+static uint32_t get_ticks(void)
+{
+    return ticks++;
+}
+
+int main(void)
+{
+    uint64_t t_call = 0, t_idle = 0, t0;
+    unsigned int r, i;
+
+    set_log_output(null_output);
+    set_log_time_func(get_ticks);
+
+    for (r = 0; r < ROUNDS; r++)
+    {
+        t0 = CYCLES();
+        for (i = 0; i < BATCH; i++)
+            log_printf(LOG_INFO, "ctrl: i=%u err=%d state=%s\n", i, (int)(r - i), "run");
+        t_call += CYCLES() - t0;
+
+#ifdef LOG_DEFERRED
+        t0 = CYCLES();
+        log_process(BATCH);
+        t_idle += CYCLES() - t0;
+#endif
+    }
+
+#ifdef LOG_DEFERRED
+    printf("LOG_DEFERRED: log_printf %.1f %s/call, log_process %.1f %s/msg, dropped %u\n",
+           (double)t_call / (ROUNDS * BATCH), UNIT, (double)t_idle / (ROUNDS * BATCH), UNIT, log_dropped());
+#else
+    (void)t_idle;
+    printf("immediate: log_printf %.1f %s/call\n", (double)t_call / (ROUNDS * BATCH), UNIT);
+#endif
+    printf("output %zu bytes\n", out_bytes);
+    return 0;
+}
@@ -10,14 +10,23 @@
  * - `log_message`：记录日志消息，输出日志级别、函数名、行号及格式化的日志内容。
  * - `set_log_output`：设置自定义的日志输出函数，以便用户可以定制日志输出方式。
  * - `get_log_level`：根据日志级别获取对应的日志级别字符串（仅在 `_DEBUG` 被定义时有效）。
+ * - `log_deferred` / `log_process`：延迟模式（`LOG_DEFERRED`）下记录参数、稍后格式化输出。
+ * - `log_bin_*`：二进制模式（`LOG_BINARY`）下编码消息 ID 和参数。
+ * - `log_module_set_level` / `log_module_get_level`：按模块名设置/获取运行时的日志级别。
  *
  * @note
  * - `log_message`：记录日志并输出到控制台或通过自定义函数输出。
  * - `set_log_output`：设置日志输出函数，可以替换默认的 `printf`。
  * - `get_log_level`：根据日志级别返回字符串描述，仅在调试模式下有效。
+ * - 延迟模式下每条日志在 KFIFO 中占用一条连续的记录（`uintptr_t` 为单位）：
+ *   头（字数和级别）、`struct log_site` 的地址、时间戳、参数的原始值。
+ *   记录通过 `kfifo_in_linear_ptr` 直接写入缓冲区，不会跨越缓冲区末尾（剩余空间不足时
+ *   写入一条填充记录）；参数类型在每条语句第一次执行时解析 `fmt` 得到，之后不再解析。
+ * - 二进制模式下一条消息为：消息 ID（变长整数）、依次编码的参数，整条消息 COBS 编码，
+ *   以 0x00 结束，丢失字节后解码器可以在下一个 0x00 处重新同步。
  *
- * @version 1.1.1
- * @date 2025-04-22
+ * @version 1.5.0
+ * @date 2026-10-16
  * @author [Jia Zhenyu]
  *
  * @par Example
@@ -41,7 +50,19 @@
  * @endcode
  */
 
+#include <string.h>
 #include "log.h"
+#ifdef LOG_DEFERRED
+#include "kfifo.h"
+#endif
+#ifdef LOG_TPRINTF
+#include "tprintf.h"
+#define LOG_SNPRINTF tprintf_snprintf
+#define LOG_VSNPRINTF tprintf_vsnprintf
+#else
+#define LOG_SNPRINTF snprintf
+#define LOG_VSNPRINTF vsnprintf
+#endif
 
 /**
  * @brief 当前日志输出函数指针
@@ -51,6 +72,25 @@
  */
 static log_output_func log_output = NULL;
 
+/**
+ * @brief 获取时间戳的函数指针，为 NULL 时不记录时间戳
+ */
+static uint32_t (*log_get_time)(void) = NULL;
+
+/**
+ * @brief 模块名称表，与模块编号一一对应
+ */
+static const char *const log_module_names[LOG_MODULE_COUNT] = {
+#define LOG_MODULE_ENTRY(name) #name,
+#include "log_modules.h"
+#undef LOG_MODULE_ENTRY
+};
+
+/**
+ * @brief 每个模块运行时的日志级别，初始为 LOG_DEBUG（0）
+ */
+unsigned char log_module_levels[LOG_MODULE_COUNT];
+
 /**
  * @brief 获取日志级别的字符串表示
  *
@@ -89,6 +129,149 @@ void set_log_output(log_output_func func)
     log_output = func;
 }
 
+/**
+ * @brief 设置获取时间戳的函数
+ *
+ * @param[in] func 获取时间戳的函数
+ */
+void set_log_time_func(uint32_t (*func)(void))
+{
+    log_get_time = func;
+}
+
+/**
+ * @brief 设置模块运行时的日志级别
+ *
+ * @param[in] name 模块名，为 NULL 时设置所有模块
+ * @param[in] level 日志级别
+ * @return 0 成功，-1 没有该模块
+ */
+int log_module_set_level(const char *name, LOGLEVEL level)
+{
+    int ret = -1;
+
+    for (int i = 0; i < LOG_MODULE_COUNT; i++)
+    {
+        if (!name || strcmp(name, log_module_names[i]) == 0)
+        {
+            log_module_levels[i] = (unsigned char)level;
+            ret = 0;
+        }
+    }
+    return ret;
+}
+
+/**
+ * @brief 获取模块运行时的日志级别
+ *
+ * @param[in] name 模块名
+ * @return 日志级别，没有该模块时返回 -1
+ */
+int log_module_get_level(const char *name)
+{
+    for (int i = 0; i < LOG_MODULE_COUNT; i++)
+    {
+        if (strcmp(name, log_module_names[i]) == 0)
+        {
+            return log_module_levels[i];
+        }
+    }
+    return -1;
+}
+
+#ifdef _DEBUG
+/**
+ * @brief 拼接并输出一行日志
+ *
+ * 依次把颜色、时间戳、级别、函数名、行号和日志内容格式化到同一个缓冲区中
+ * （内容只格式化一次，不再需要单独的缓冲区），通过自定义输出函数或 `printf` 输出。
+ * 内容过长时被截断，颜色结束序列总是保留。
+ *
+ * @param[in] level 日志级别
+ * @param[in] ts 时间戳，为 NULL 时不输出
+ * @param[in] fun 函数名
+ * @param[in] line 行号
+ * @param[in] fmt 格式化字符串
+ * @param[in] ap 格式化字符串的可变参数
+ */
+static void log_vemit(LOGLEVEL level, const uint32_t *ts, const char *fun, int line, const char *fmt, va_list ap)
+{
+    char log_buf[LOG_BUF_SIZE];
+    const char *color_start = "";       // 默认没有颜色
+#ifdef ANSI_ESCAPE_SEQUENCES
+    static const char color_end[] = "\033[0m"; // 颜色重置
+
+    /* 根据日志级别添加颜色 */
+    switch (level)
+    {
+    case LOG_DEBUG:
+        color_start = "\033[34m";  // 蓝色
+        break;
+    case LOG_INFO:
+        color_start = "\033[32m";  // 绿色
+        break;
+    case LOG_WARN:
+        color_start = "\033[33m";  // 黄色
+        break;
+    case LOG_ERROR:
+        color_start = "\033[31m";  // 红色
+        break;
+    default:
+        break;
+    }
+#else
+    static const char color_end[] = "";
+#endif /* ANSI_ESCAPE_SEQUENCES */
+
+    /* 为颜色结束序列保留空间 */
+    const size_t room = sizeof(log_buf) - (sizeof(color_end) - 1);
+    size_t len;
+    int ret;
+
+    if (ts)
+    {
+        ret = LOG_SNPRINTF(log_buf, room, "%s[%lu] [%s] [Fun:%s Line:%d] ",
+                           color_start, (unsigned long)*ts, get_log_level(level), fun, line);
+    }
+    else
+    {
+        ret = LOG_SNPRINTF(log_buf, room, "%s[%s] [Fun:%s Line:%d] ",
+                           color_start, get_log_level(level), fun, line);
+    }
+    len = ret < 0 ? 0 : ((size_t)ret < room ? (size_t)ret : room - 1);
+
+    ret = LOG_VSNPRINTF(log_buf + len, room - len, fmt, ap);
+    if (ret > 0)
+    {
+        len += (size_t)ret < room - len ? (size_t)ret : room - len - 1;
+    }
+    memcpy(log_buf + len, color_end, sizeof(color_end));
+
+    if (log_output)
+    {
+        log_output(log_buf);
+    }
+    else
+    {
+        printf("%s", log_buf);
+    }
+}
+
+#ifdef LOG_DEFERRED
+/**
+ * @brief 拼接并输出一行日志，参数同 `log_vemit`
+ */
+static void log_emit(LOGLEVEL level, const uint32_t *ts, const char *fun, int line, const char *fmt, ...)
+{
+    va_list ap;
+
+    va_start(ap, fmt);
+    log_vemit(level, ts, fun, line, fmt, ap);
+    va_end(ap);
+}
+#endif /* LOG_DEFERRED */
+#endif /* _DEBUG */
+
 /**
  * @brief 记录日志消息
  *
@@ -113,59 +296,582 @@ void log_message(LOGLEVEL level, const char *fun, const int line, const char *fm
     va_list arg;
 
     va_start(arg, fmt);
-    int size = vsnprintf(NULL, 0, fmt, arg);
+    log_vemit(level, NULL, fun, line, fmt, arg);
     va_end(arg);
-    if (size < 0)
+#endif /* _DEBUG */
+}
+
+#ifdef LOG_DEFERRED
+
+#define LOG_REC_HEAD 3    // 记录头的字数：头、site、时间戳
+#define LOG_REC_PAD 0xff  // 填充记录的级别，读端直接跳过
+#define LOG_WORDS_64 ((8 + sizeof(uintptr_t) - 1) / sizeof(uintptr_t)) // 64 位参数占用的字数
+
+/* 参数类型，每个参数 2 位 */
+enum
+{
+    LOG_ARG_INT = 0, // int 及更短的整数、%c
+    LOG_ARG_WORD,    // long、size_t、指针、%s
+    LOG_ARG_LLONG,   // long long、intmax_t
+    LOG_ARG_DOUBLE,  // double
+};
+
+#define LOG_SPEC_NONE -1  // 不需要参数（%%）
+#define LOG_SPEC_STOP -2  // 不支持的转换说明，之后的参数不再记录
+
+static DEFINE_KFIFO(log_fifo, uintptr_t, LOG_DEFERRED_SIZE);
+static volatile unsigned int log_dropped_count = 0;
+
+/**
+ * @brief 解析一个转换说明
+ *
+ * @param[in] p 指向 '%' 之后的字符
+ * @param[out] stars 宽度/精度中 '*' 的个数，每个 '*' 需要一个 int 参数
+ * @param[out] type 参数类型，或 `LOG_SPEC_NONE` / `LOG_SPEC_STOP`
+ * @return 转换说明之后的位置
+ */
+static const char *log_parse_spec(const char *p, int *stars, int *type)
+{
+    int l = 0;
+
+    *stars = 0;
+    if (*p == '%')
     {
-        return; // 错误处理
+        *type = LOG_SPEC_NONE;
+        return p + 1;
     }
 
-    char buf[size + 1];
-    va_start(arg, fmt);
-    vsnprintf(buf, sizeof(buf), fmt, arg);
-    va_end(arg);
+    while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0')
+        p++;
+    if (*p == '*')
+    {
+        (*stars)++;
+        p++;
+    }
+    while (*p >= '0' && *p <= '9')
+        p++;
+    if (*p == '.')
+    {
+        p++;
+        if (*p == '*')
+        {
+            (*stars)++;
+            p++;
+        }
+        while (*p >= '0' && *p <= '9')
+            p++;
+    }
 
-    char log_buf[LOG_BUF_SIZE];
-    
-#ifdef ANSI_ESCAPE_SEQUENCES
-    /* 根据日志级别添加颜色 */
-    const char *color_start = "";       // 默认没有颜色
-    const char *color_end = "\033[0m";  // 默认颜色重置
-    
-    switch (level)
+    for (;; p++)
     {
-    case LOG_DEBUG:
-        color_start = "\033[34m";  // 蓝色
+        if (*p == 'h')
+            continue;
+        if (*p == 'l')
+            l++;
+        else if (*p == 'z' || *p == 't')
+            l = 1;
+        else if (*p == 'j' || *p == 'q' || *p == 'L')
+            l = 2;
+        else
+            break;
+    }
+
+    switch (*p)
+    {
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+        *type = l == 0 ? LOG_ARG_INT : l == 1 ? LOG_ARG_WORD : LOG_ARG_LLONG;
         break;
-    case LOG_INFO:
-        color_start = "\033[32m";  // 绿色
+    case 'c':
+        *type = LOG_ARG_INT;
         break;
-    case LOG_WARN:
-        color_start = "\033[33m";  // 黄色
+    case 's':
+    case 'p':
+        *type = LOG_ARG_WORD;
         break;
-    case LOG_ERROR:
-        color_start = "\033[31m";  // 红色
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+        *type = l == 2 ? LOG_SPEC_STOP : LOG_ARG_DOUBLE; // 不支持 long double
         break;
     default:
-        break;
+        *type = LOG_SPEC_STOP; // %n、未知的转换说明或字符串结束
+        return p;
     }
+    return p + 1;
+}
+
+/**
+ * @brief 解析日志语句的参数类型，结果保存在 `site` 中
+ *
+ * @param[in,out] site 日志语句的静态信息
+ */
+static void log_parse_site(struct log_site *site)
+{
+    const char *p = site->fmt;
+    uint32_t types = 0;
+    unsigned int n = 0, words = LOG_REC_HEAD;
+    int stars, type;
 
-    // 拼接日志消息，带颜色
-    snprintf(log_buf, sizeof(log_buf), "%s[%s] [Fun:%s Line:%d] %s%s",
-             color_start, get_log_level(level), fun, line, buf, color_end);
+    while ((p = strchr(p, '%')) != NULL)
+    {
+        p = log_parse_spec(p + 1, &stars, &type);
+        if (type == LOG_SPEC_NONE)
+            continue;
+        if (type == LOG_SPEC_STOP || n + stars + 1 > LOG_DEFERRED_MAX_ARGS)
+            break;
+
+        words += stars; // '*' 对应的参数为 int，类型为 0
+        n += stars;
+        types |= (uint32_t)type << (2 * n);
+        words += (type == LOG_ARG_LLONG || type == LOG_ARG_DOUBLE) ? LOG_WORDS_64 : 1;
+        n++;
+    }
+
+    site->types = types;
+    site->nargs = n;
+    site->words = words;
+}
+
+/**
+ * @brief 记录一条延迟格式化的日志
+ *
+ * @param[in] site 日志语句的静态信息
+ * @param[in] level 日志级别
+ * @param[in] ... 格式化字符串的可变参数
+ */
+void log_deferred(struct log_site *site, LOGLEVEL level, ...)
+{
+#ifdef _DEBUG
+    if ((int)level < (int)LOG_LEVEL)
+    {
+        return;
+    }
+
+    if (!site->words)
+    {
+        log_parse_site(site);
+    }
+
+    unsigned int words = site->words;
+    uint32_t types = site->types;
+    uint32_t ts = log_get_time ? log_get_time() : 0;
+    uintptr_t *rec;
+    va_list arg;
+
+    LOG_DEFERRED_LOCK();
+
+    unsigned int l = kfifo_in_linear_ptr(&log_fifo, &rec, words);
+    if (l < words)
+    {
+        /* 到缓冲区末尾的空间不够，填充后从缓冲区开头写入 */
+        if (kfifo_avail(&log_fifo) < l + words)
+        {
+            log_dropped_count++;
+            LOG_DEFERRED_UNLOCK();
+            return;
+        }
+        rec[0] = ((uintptr_t)l << 8) | LOG_REC_PAD;
+        kfifo_in_commit(&log_fifo, l);
+        l = kfifo_in_linear_ptr(&log_fifo, &rec, words);
+    }
+
+    rec[0] = ((uintptr_t)words << 8) | (uintptr_t)level;
+    rec[1] = (uintptr_t)site;
+    rec[2] = ts;
+    rec += LOG_REC_HEAD;
+
+    va_start(arg, level);
+    for (unsigned int i = 0; i < site->nargs; i++, types >>= 2)
+    {
+        switch (types & 3)
+        {
+        case LOG_ARG_INT:
+            *rec++ = (uintptr_t)va_arg(arg, int);
+            break;
+        case LOG_ARG_WORD:
+            *rec++ = (uintptr_t)va_arg(arg, void *);
+            break;
+        case LOG_ARG_LLONG:
+        {
+            long long v = va_arg(arg, long long);
+            memcpy(rec, &v, sizeof(v));
+            rec += LOG_WORDS_64;
+            break;
+        }
+        default:
+        {
+            double v = va_arg(arg, double);
+            memcpy(rec, &v, sizeof(v));
+            rec += LOG_WORDS_64;
+            break;
+        }
+        }
+    }
+    va_end(arg);
+
+    kfifo_in_commit(&log_fifo, words);
+    LOG_DEFERRED_UNLOCK();
 #else
-    /* 没有颜色输出，直接拼接日志消息 */
-    snprintf(log_buf, sizeof(log_buf), "[%s] [Fun:%s Line:%d] %s",
-             get_log_level(level), fun, line, buf);
-#endif /* ANSI_ESCAPE_SEQUENCES */
+    (void)site;
+    (void)level;
+#endif /* _DEBUG */
+}
 
-    if (log_output)
+#ifdef _DEBUG
+/**
+ * @brief 按记录中的参数格式化日志内容
+ *
+ * 逐个转换说明调用 `snprintf`，参数按 `site` 中的类型取出。
+ *
+ * @param[out] buf 输出缓冲区
+ * @param[in] size 输出缓冲区大小
+ * @param[in] site 日志语句的静态信息
+ * @param[in] args 记录中的参数
+ */
+static void log_format(char *buf, size_t size, const struct log_site *site, const uintptr_t *args)
+{
+    const char *p = site->fmt, *q;
+    unsigned int i = 0;
+    size_t len = 0;
+    int stars, type, ret;
+
+    while ((q = strchr(p, '%')) != NULL)
     {
-        log_output(log_buf);
+        const char *e = log_parse_spec(q + 1, &stars, &type);
+        char spec[24];
+        int w[2] = {0, 0};
+
+        if (type == LOG_SPEC_STOP || (type != LOG_SPEC_NONE && i + stars + 1 > site->nargs) ||
+            (size_t)(e - q) >= sizeof(spec))
+            break;
+
+        /* 转换说明之前的文本，%% 输出一个 % */
+        ret = snprintf(buf + len, size - len, "%.*s", (int)(q - p) + (type == LOG_SPEC_NONE), p);
+        len += ret < (int)(size - len) ? (size_t)ret : size - len - 1;
+        p = e;
+        if (type == LOG_SPEC_NONE)
+            continue;
+
+        memcpy(spec, q, e - q);
+        spec[e - q] = '\0';
+        for (int k = 0; k < stars; k++, i++)
+            w[k] = (int)*args++;
+        i++;
+
+#define LOG_FORMAT_ARG(v)                                                     \
+    (stars == 0   ? snprintf(buf + len, size - len, spec, v)                   \
+     : stars == 1 ? snprintf(buf + len, size - len, spec, w[0], v)             \
+                  : snprintf(buf + len, size - len, spec, w[0], w[1], v))
+
+        switch ((site->types >> (2 * (i - 1))) & 3)
+        {
+        case LOG_ARG_INT:
+            ret = LOG_FORMAT_ARG((int)*args++);
+            break;
+        case LOG_ARG_WORD:
+            if (e[-1] == 's' || e[-1] == 'p')
+                ret = LOG_FORMAT_ARG((void *)*args++);
+            else
+                ret = LOG_FORMAT_ARG((long)*args++);
+            break;
+        case LOG_ARG_LLONG:
+        {
+            long long v;
+            memcpy(&v, args, sizeof(v));
+            args += LOG_WORDS_64;
+            ret = LOG_FORMAT_ARG(v);
+            break;
+        }
+        default:
+        {
+            double v;
+            memcpy(&v, args, sizeof(v));
+            args += LOG_WORDS_64;
+            ret = LOG_FORMAT_ARG(v);
+            break;
+        }
+        }
+#undef LOG_FORMAT_ARG
+
+        if (ret > 0)
+            len += ret < (int)(size - len) ? (size_t)ret : size - len - 1;
+    }
+
+    /* 剩余的文本（未记录参数的转换说明原样输出） */
+    snprintf(buf + len, size - len, "%s", p);
+}
+#endif /* _DEBUG */
+
+/**
+ * @brief 格式化并输出已记录的日志
+ *
+ * @param[in] max 最多处理的日志条数
+ * @return 实际处理的日志条数
+ */
+unsigned int log_process(unsigned int max)
+{
+    unsigned int n = 0;
+
+    while (n < max)
+    {
+        const uintptr_t *rec;
+
+        if (!kfifo_out_linear_ptr(&log_fifo, &rec, LOG_DEFERRED_SIZE))
+            break;
+
+        unsigned int words = rec[0] >> 8;
+        unsigned int level = rec[0] & 0xff;
+
+        if (level != LOG_REC_PAD)
+        {
+#ifdef _DEBUG
+            const struct log_site *site = (const struct log_site *)rec[1];
+            uint32_t ts = (uint32_t)rec[2];
+            char msg[LOG_BUF_SIZE];
+
+            log_format(msg, sizeof(msg), site, rec + LOG_REC_HEAD);
+            log_emit((LOGLEVEL)level, log_get_time ? &ts : NULL, site->fun, site->line, "%s", msg);
+#endif /* _DEBUG */
+            n++;
+        }
+        kfifo_skip_count(&log_fifo, words);
+    }
+    return n;
+}
+
+/**
+ * @brief 获取因缓冲区已满而丢弃的日志条数
+ *
+ * @return 丢弃的日志条数
+ */
+unsigned int log_dropped(void)
+{
+    return log_dropped_count;
+}
+
+#endif /* LOG_DEFERRED */
+
+#ifdef LOG_BINARY
+
+/**
+ * @brief 当前二进制日志输出函数指针，为 NULL 时写入 `stdout`
+ */
+static log_binary_output_func log_binary_output = NULL;
+
+/**
+ * @brief 设置二进制日志输出函数
+ *
+ * @param[in] func 二进制日志输出函数
+ */
+void set_log_binary_output(log_binary_output_func func)
+{
+    log_binary_output = func;
+}
+
+/* 最后一个字节留给帧结束符 0x00 */
+#define LOG_BIN_END(b) ((b)->buf + sizeof((b)->buf) - 1)
+
+/**
+ * @brief 写入一个变长整数（每字节 7 位，低位在前）
+ *
+ * 剩余空间不足时丢弃整条消息（`p` 置为 NULL）。
+ */
+static inline void log_bin_varint32(struct log_bin *b, uint32_t v)
+{
+    unsigned char *p = b->p;
+
+    if (!p || LOG_BIN_END(b) - p < 5)
+    {
+        b->p = NULL;
+        return;
+    }
+    while (v >= 0x80)
+    {
+        *p++ = (unsigned char)v | 0x80;
+        v >>= 7;
+    }
+    *p++ = (unsigned char)v;
+    b->p = p;
+}
+
+/*
+ * 参数的类型标记，放在每个参数第一个字节的低 2 位。解码器按标记读取参数、
+ * 按转换说明输出，类型与转换说明不一致时只影响这一个参数
+ */
+#define LOG_BIN_T_INT 0    // zigzag 整数
+#define LOG_BIN_T_STR 1    // 字符串：值为长度，后跟内容
+#define LOG_BIN_T_DOUBLE 2 // 值为 0，后跟 8 字节 double
+#define LOG_BIN_T_PTR 3    // 指针
+
+/**
+ * @brief 写入一个带类型标记的参数
+ *
+ * 第一个字节为：继续位、值的低 5 位、类型标记（低 2 位），之后每字节 7 位，
+ * 小于 32 的值只占 1 个字节。剩余空间不足时丢弃整条消息。
+ */
+static inline void log_bin_arg32(struct log_bin *b, unsigned int tag, uint32_t v)
+{
+    unsigned char *p = b->p;
+
+    if (!p || LOG_BIN_END(b) - p < 5)
+    {
+        b->p = NULL;
+        return;
+    }
+    *p = (unsigned char)((v & 0x1f) << 2 | tag);
+    for (v >>= 5; v; v >>= 7)
+    {
+        *p++ |= 0x80;
+        *p = (unsigned char)(v & 0x7f);
+    }
+    b->p = p + 1;
+}
+
+static void log_bin_arg64(struct log_bin *b, unsigned int tag, uint64_t v)
+{
+    unsigned char *p = b->p;
+
+    if (v <= 0xffffffffU)
+    {
+        log_bin_arg32(b, tag, (uint32_t)v);
+        return;
+    }
+    if (!p || LOG_BIN_END(b) - p < 10)
+    {
+        b->p = NULL;
+        return;
+    }
+    *p = (unsigned char)((v & 0x1f) << 2 | tag);
+    for (v >>= 5; v; v >>= 7)
+    {
+        *p++ |= 0x80;
+        *p = (unsigned char)(v & 0x7f);
+    }
+    b->p = p + 1;
+}
+
+/**
+ * @brief 开始一条消息，写入消息 ID
+ */
+void log_bin_begin(struct log_bin *b, unsigned int id)
+{
+    b->p = b->buf + 1;
+    log_bin_varint32(b, id);
+}
+
+/* 整数统一使用 zigzag 编码，解码器只需按格式化字符串的转换说明截断 */
+void log_bin_int(struct log_bin *b, int32_t v)
+{
+    log_bin_arg32(b, LOG_BIN_T_INT, ((uint32_t)v << 1) ^ (uint32_t)(v >> 31));
+}
+
+void log_bin_uint(struct log_bin *b, uint32_t v)
+{
+    log_bin_arg64(b, LOG_BIN_T_INT, (uint64_t)v << 1);
+}
+
+void log_bin_int64(struct log_bin *b, int64_t v)
+{
+    log_bin_arg64(b, LOG_BIN_T_INT, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+}
+
+void log_bin_uint64(struct log_bin *b, uint64_t v)
+{
+    /* 超过 63 位的值按 int64 解码，最高位丢失 */
+    log_bin_arg64(b, LOG_BIN_T_INT, v << 1);
+}
+
+void log_bin_double(struct log_bin *b, double v)
+{
+    log_bin_arg32(b, LOG_BIN_T_DOUBLE, 0);
+    if (!b->p || LOG_BIN_END(b) - b->p < (int)sizeof(v))
+    {
+        b->p = NULL;
+        return;
+    }
+    memcpy(b->p, &v, sizeof(v));
+    b->p += sizeof(v);
+}
+
+/* 字符串：长度加内容，超出剩余空间的部分被截断 */
+void log_bin_str(struct log_bin *b, const void *s)
+{
+    size_t len = s ? strlen((const char *)s) : 0;
+    int room;
+
+    if (!b->p)
+        return;
+    /* 长度不超过 255，带类型标记时占 2 个字节 */
+    room = LOG_BIN_END(b) - b->p - 2;
+    if (room < 0)
+    {
+        b->p = NULL;
+        return;
+    }
+    if (len > (size_t)room)
+        len = room;
+    log_bin_arg32(b, LOG_BIN_T_STR, (uint32_t)len);
+    if (b->p)
+    {
+        memcpy(b->p, s, len);
+        b->p += len;
+    }
+}
+
+void log_bin_ptr(struct log_bin *b, const void *p)
+{
+    log_bin_arg64(b, LOG_BIN_T_PTR, (uint64_t)(uintptr_t)p);
+}
+
+/**
+ * @brief 结束一条消息：原地 COBS 编码并输出
+ *
+ * 消息不超过 254 字节，每个零字节替换为到下一个零字节（或帧尾）的距离，
+ * `buf[0]` 为第一个距离，最后加上帧结束符 0x00。
+ */
+void log_bin_end(struct log_bin *b)
+{
+#ifdef _DEBUG
+    unsigned char *buf = b->buf;
+    int n, i, last;
+
+    if (!b->p)
+    {
+        return; // 消息超过 LOG_BINARY_SIZE，丢弃
+    }
+
+    n = b->p - buf;
+    buf[n] = 0;
+    for (i = n - 1, last = n; i >= 0; i--)
+    {
+        if (i == 0 || buf[i] == 0)
+        {
+            buf[i] = (unsigned char)(last - i);
+            last = i;
+        }
+    }
+
+    if (log_binary_output)
+    {
+        log_binary_output(buf, n + 1);
     }
     else
     {
-        printf("%s", log_buf);
+        fwrite(buf, 1, n + 1, stdout);
     }
+#else
+    (void)b;
 #endif /* _DEBUG */
 }
+
+#endif /* LOG_BINARY */
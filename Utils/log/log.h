@@ -9,9 +9,14 @@
  * - 日志级别的定义包括 `LOG_DEBUG`、`LOG_INFO`、`LOG_WARN` 和 `LOG_ERROR`。
  * - 通过 `set_log_output` 函数可以设置自定义的日志输出函数。
  * - 在编译时可以定义 `_DEBUG` 来启用调试信息输出。
+ * - 每个源文件可以定义 `LOG_MODULE` / `LOG_MODULE_LEVEL`，低于编译时级别的日志不产生代码；
+ *   `log_module_set_level` 在运行时按模块调整级别。
+ * - 定义 `LOG_DEFERRED` 后 `log_printf` 只记录参数，格式化和输出由 `log_process` 在空闲时完成。
+ * - 定义 `LOG_BINARY` 后 `log_printf` 输出二进制消息（消息 ID 加参数），格式化字符串等放在
+ *   不下载的 `log_meta` 段中，由主机上的 `tools/log_decode` 还原为文本。
  *
- * @version 1.1.1
- * @date 2025-04-22
+ * @version 1.5.0
+ * @date 2026-10-16
  * @author [Jia Zhenyu]
  */
 
@@ -20,6 +25,7 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdint.h>
 
 /* 定义调试模式 */
 #define _DEBUG
@@ -29,8 +35,48 @@
 #define LOG_LEVEL LOG_DEBUG
 #endif
 
+/* 当前源文件所属的模块，在包含 log.h 之前定义，模块需要在 log_modules.h 中登记 */
+#ifndef LOG_MODULE
+#define LOG_MODULE default
+#endif
+
+/* 当前源文件编译时的日志级别，低于该级别的 log_printf 不产生代码 */
+#ifndef LOG_MODULE_LEVEL
+#define LOG_MODULE_LEVEL LOG_LEVEL
+#endif
+
 #define ANSI_ESCAPE_SEQUENCES       /* 是否使用 ANSI 转义序列，即带颜色的输出 */
 #define LOG_BUF_SIZE    256         /* 输出 buffer 大小 */
+// #define LOG_TPRINTF                 /* 使用 tprintf 代替 libc 的 snprintf/vsnprintf，需要编译 tprintf.c */
+
+// #define LOG_DEFERRED                /* 延迟格式化模式，需要编译 kfifo.c */
+
+#ifdef LOG_DEFERRED
+#ifndef LOG_DEFERRED_SIZE
+#define LOG_DEFERRED_SIZE 256       /* 记录缓冲区大小（字），必须为 2 的幂 */
+#endif
+#ifndef LOG_DEFERRED_MAX_ARGS
+#define LOG_DEFERRED_MAX_ARGS 8     /* 每条日志最多记录的参数个数，不超过 16 */
+#endif
+/* 多个上下文（如中断和主循环）都会写日志时，定义为关中断/恢复，例如
+   #define LOG_DEFERRED_LOCK() uint32_t _primask = enter_critical()
+   #define LOG_DEFERRED_UNLOCK() exit_critical(_primask) */
+#ifndef LOG_DEFERRED_LOCK
+#define LOG_DEFERRED_LOCK()
+#define LOG_DEFERRED_UNLOCK()
+#endif
+#endif /* LOG_DEFERRED */
+
+// #define LOG_BINARY                  /* 二进制模式，需要在链接脚本中放置 log_meta 段 */
+
+#ifdef LOG_BINARY
+#ifdef LOG_DEFERRED
+#error "LOG_BINARY and LOG_DEFERRED cannot be used together"
+#endif
+#ifndef LOG_BINARY_SIZE
+#define LOG_BINARY_SIZE 128         /* 一条二进制消息编码后的最大字节数，不超过 255 */
+#endif
+#endif /* LOG_BINARY */
 
 /**
  * @brief 日志级别的枚举类型
@@ -43,6 +89,28 @@ typedef enum
     LOG_ERROR,
 } LOGLEVEL;
 
+#define __LOG_CAT(a, b) __LOG_CAT_(a, b)
+#define __LOG_CAT_(a, b) a##b
+
+/**
+ * @brief 模块编号，由 log_modules.h 中的登记生成
+ */
+enum
+{
+#define LOG_MODULE_ENTRY(name) LOG_MODULE_ID_##name,
+#include "log_modules.h"
+#undef LOG_MODULE_ENTRY
+    LOG_MODULE_COUNT
+};
+
+/**
+ * @brief 每个模块运行时的日志级别，按模块编号索引
+ *
+ * 初始为 `LOG_DEBUG`，即只按编译时级别过滤。现场调试时通过 `log_module_set_level`
+ * 修改，只能在编译时已保留的语句中进一步过滤。
+ */
+extern unsigned char log_module_levels[LOG_MODULE_COUNT];
+
 /**
  * @brief 日志输出函数类型
  *
@@ -52,6 +120,56 @@ typedef enum
  */
 typedef void (*log_output_func)(const char *);
 
+/**
+ * @brief 延迟模式下一条日志语句的静态信息
+ *
+ * 由 `log_printf` 在调用处定义为静态变量，记录中只保存它的地址。
+ * `types`/`nargs`/`words` 在第一次调用时由 `fmt` 解析得到。
+ */
+struct log_site
+{
+    const char *fmt;      // 格式化字符串
+    const char *fun;      // 函数名
+    int line;             // 行号
+    uint32_t types;       // 每个参数 2 位的类型
+    unsigned char nargs;  // 参数个数
+    unsigned char words;  // 记录的总字数，0 表示尚未解析
+};
+
+/**
+ * @brief 二进制模式下一条日志语句的元数据
+ *
+ * 由 `log_printf` 在调用处定义在 `log_meta` 段中，只用于链接得到消息 ID
+ * （元数据在段中的偏移），运行时不会读取，该段不需要下载到 Flash。
+ * 主机解码器从 ELF 文件中读取，由 `pc` 在符号表中查找函数名。
+ */
+struct log_meta
+{
+    const void *pc;        // 调用处的代码地址
+    int line;              // 行号
+    unsigned char level;   // 日志级别
+    char fmt[];            // 格式化字符串
+};
+
+/**
+ * @brief 二进制日志输出函数类型
+ *
+ * @param[in] data 一条 COBS 编码的消息，以 0x00 结束
+ * @param[in] len 字节数（包括结尾的 0x00）
+ */
+typedef void (*log_binary_output_func)(const void *data, unsigned int len);
+
+#ifdef LOG_BINARY
+/**
+ * @brief 正在编码的二进制消息，`buf[0]` 保留给 COBS 编码
+ */
+struct log_bin
+{
+    unsigned char *p;
+    unsigned char buf[LOG_BINARY_SIZE];
+};
+#endif /* LOG_BINARY */
+
 /**
  * @brief 记录日志消息
  *
@@ -65,16 +183,60 @@ typedef void (*log_output_func)(const char *);
  */
 void log_message(LOGLEVEL level, const char *fun, const int line, const char *fmt, ...);
 
+/* 每种模式下输出一条日志，由 log_printf 在级别检查之后调用 */
+#if defined(LOG_BINARY)
+#define __LOG_EMIT(level, format, ...)                                                         \
+    do                                                                                         \
+    {                                                                                          \
+        __label__ _log_pc;                                                                     \
+    _log_pc: __attribute__((unused));                                                          \
+        static const struct log_meta _log_meta __attribute__((section("log_meta"))) =          \
+            {&&_log_pc, __LINE__, (level), format};                                            \
+        struct log_bin _log_bin;                                                               \
+        log_bin_begin(&_log_bin, (unsigned int)((const char *)&_log_meta - __start_log_meta)); \
+        __LOG_BIN_ARGS(&_log_bin, ##__VA_ARGS__)                                               \
+        log_bin_end(&_log_bin);                                                                \
+    } while (0)
+#elif defined(LOG_DEFERRED)
+#define __LOG_EMIT(level, format, ...)                                                               \
+    do                                                                                               \
+    {                                                                                                \
+        static struct log_site _log_site = {.fmt = (format), .fun = __FUNCTION__, .line = __LINE__}; \
+        log_deferred(&_log_site, (level), ##__VA_ARGS__);                                            \
+    } while (0)
+#else
+#define __LOG_EMIT(level, fmt...) log_message(level, __FUNCTION__, __LINE__, fmt)
+#endif
+
+/*
+ * 调用处的级别检查：先与编译时的 LOG_MODULE_LEVEL 比较（常量，低于该级别的语句连同参数
+ * 一起被编译器删除），再与运行时的模块级别表比较（一次数组访问）
+ */
+#ifdef _DEBUG
+#define __LOG_ENABLED(level)                  \
+    ((int)(level) >= (int)LOG_MODULE_LEVEL && \
+     (int)(level) >= (int)log_module_levels[__LOG_CAT(LOG_MODULE_ID_, LOG_MODULE)])
+#else
+#define __LOG_ENABLED(level) 0
+#endif
+
 /**
  * @brief 记录格式化日志消息的宏
  *
  * 这个宏用来简化日志记录的调用，自动传递当前函数名和行号。
+ * 级别低于当前模块编译时级别 `LOG_MODULE_LEVEL` 的语句（或未定义 `_DEBUG` 时的所有语句）
+ * 不产生任何代码，参数也不会被求值；其余语句还要通过运行时的模块级别检查。
  *
  * @param[in] level 日志级别
  * @param[in] fmt 格式化字符串
  * @param[in] ... 格式化字符串的可变参数
  */
-#define log_printf(level, fmt...) log_message(level, __FUNCTION__, __LINE__, fmt)
+#define log_printf(level, fmt...)   \
+    do                              \
+    {                               \
+        if (__LOG_ENABLED(level))   \
+            __LOG_EMIT(level, fmt); \
+    } while (0)
 
 /**
  * @brief 设置自定义日志输出函数
@@ -86,4 +248,133 @@ void log_message(LOGLEVEL level, const char *fun, const int line, const char *fm
  */
 void set_log_output(log_output_func func);
 
+/**
+ * @brief 设置获取时间戳的函数
+ *
+ * 延迟模式下记录日志时调用该函数，输出时在每行开头加上 `[时间戳]`。
+ * 不设置时不记录时间戳。
+ *
+ * @param[in] func 获取时间戳的函数，例如返回系统 tick
+ */
+void set_log_time_func(uint32_t (*func)(void));
+
+/**
+ * @brief 设置模块运行时的日志级别
+ *
+ * 用于现场调试，例如通过命令行打开某个模块的调试日志。级别低于该模块编译时
+ * 级别的语句已被删除，无法通过本函数打开。
+ *
+ * @param[in] name 模块名（`log_modules.h` 中登记的名称），为 NULL 时设置所有模块
+ * @param[in] level 日志级别
+ * @return 0 成功，-1 没有该模块
+ */
+int log_module_set_level(const char *name, LOGLEVEL level);
+
+/**
+ * @brief 获取模块运行时的日志级别
+ *
+ * @param[in] name 模块名
+ * @return 日志级别，没有该模块时返回 -1
+ */
+int log_module_get_level(const char *name);
+
+#ifdef LOG_DEFERRED
+/**
+ * @brief 记录一条延迟格式化的日志（由 `log_printf` 调用）
+ *
+ * 只把时间戳、级别、`site` 的地址和参数的原始值写入记录缓冲区，不进行格式化。
+ * `%s` 只保存字符串的地址，字符串在 `log_process` 输出之前必须保持有效。
+ * 缓冲区已满时丢弃该日志，计入 `log_dropped`。
+ *
+ * @param[in] site 日志语句的静态信息
+ * @param[in] level 日志级别
+ * @param[in] ... 格式化字符串的可变参数
+ */
+void log_deferred(struct log_site *site, LOGLEVEL level, ...);
+
+/**
+ * @brief 格式化并输出已记录的日志
+ *
+ * 在空闲钩子（如 `scheduler_set_idle_hook`）或低优先级任务中调用，
+ * 输出格式与立即模式相同。只能在一个上下文中调用。
+ *
+ * @param[in] max 最多处理的日志条数
+ * @return 实际处理的日志条数
+ */
+unsigned int log_process(unsigned int max);
+
+/**
+ * @brief 获取因缓冲区已满而丢弃的日志条数
+ *
+ * @return 丢弃的日志条数
+ */
+unsigned int log_dropped(void);
+#endif /* LOG_DEFERRED */
+
+#ifdef LOG_BINARY
+/**
+ * @brief 设置二进制日志输出函数
+ *
+ * 不设置时使用 `fwrite` 写入 `stdout`。
+ *
+ * @param[in] func 二进制日志输出函数
+ */
+void set_log_binary_output(log_binary_output_func func);
+
+/* log_meta 段的起始地址，由链接器定义 */
+extern const char __start_log_meta[];
+
+/* 以下函数由 log_printf 调用：每个参数以类型标记开头，整数使用 zigzag 变长编码，
+   浮点数为 8 字节 double，字符串为长度加内容，指针为变长整数 */
+void log_bin_begin(struct log_bin *b, unsigned int id);
+void log_bin_int(struct log_bin *b, int32_t v);
+void log_bin_uint(struct log_bin *b, uint32_t v);
+void log_bin_int64(struct log_bin *b, int64_t v);
+void log_bin_uint64(struct log_bin *b, uint64_t v);
+void log_bin_double(struct log_bin *b, double v);
+void log_bin_str(struct log_bin *b, const void *s);
+void log_bin_ptr(struct log_bin *b, const void *p);
+void log_bin_end(struct log_bin *b);
+
+/* 按参数类型选择编码函数 */
+#define __LOG_BIN_ARG(b, x)                 \
+    _Generic((x),                           \
+        _Bool: log_bin_uint,                \
+        char: log_bin_int,                  \
+        signed char: log_bin_int,           \
+        short: log_bin_int,                 \
+        int: log_bin_int,                   \
+        unsigned char: log_bin_uint,        \
+        unsigned short: log_bin_uint,       \
+        unsigned int: log_bin_uint,         \
+        long: log_bin_int64,                \
+        long long: log_bin_int64,           \
+        unsigned long: log_bin_uint64,      \
+        unsigned long long: log_bin_uint64, \
+        float: log_bin_double,              \
+        double: log_bin_double,             \
+        long double: log_bin_double,        \
+        char *: log_bin_str,                \
+        const char *: log_bin_str,          \
+        signed char *: log_bin_str,         \
+        const signed char *: log_bin_str,   \
+        unsigned char *: log_bin_str,       \
+        const unsigned char *: log_bin_str, \
+        default: log_bin_ptr)(b, x);
+
+/* 对每个参数调用 __LOG_BIN_ARG，最多 8 个参数 */
+#define __LOG_NARGS(...) __LOG_NARGS_(_, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define __LOG_NARGS_(_, _1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+#define __LOG_BIN_ARGS(b, ...) __LOG_CAT(__LOG_BIN_ARGS_, __LOG_NARGS(__VA_ARGS__))(b, ##__VA_ARGS__)
+#define __LOG_BIN_ARGS_0(b)
+#define __LOG_BIN_ARGS_1(b, x) __LOG_BIN_ARG(b, x)
+#define __LOG_BIN_ARGS_2(b, x, ...) __LOG_BIN_ARG(b, x) __LOG_BIN_ARGS_1(b, __VA_ARGS__)
+#define __LOG_BIN_ARGS_3(b, x, ...) __LOG_BIN_ARG(b, x) __LOG_BIN_ARGS_2(b, __VA_ARGS__)
+#define __LOG_BIN_ARGS_4(b, x, ...) __LOG_BIN_ARG(b, x) __LOG_BIN_ARGS_3(b, __VA_ARGS__)
+#define __LOG_BIN_ARGS_5(b, x, ...) __LOG_BIN_ARG(b, x) __LOG_BIN_ARGS_4(b, __VA_ARGS__)
+#define __LOG_BIN_ARGS_6(b, x, ...) __LOG_BIN_ARG(b, x) __LOG_BIN_ARGS_5(b, __VA_ARGS__)
+#define __LOG_BIN_ARGS_7(b, x, ...) __LOG_BIN_ARG(b, x) __LOG_BIN_ARGS_6(b, __VA_ARGS__)
+#define __LOG_BIN_ARGS_8(b, x, ...) __LOG_BIN_ARG(b, x) __LOG_BIN_ARGS_7(b, __VA_ARGS__)
+#endif /* LOG_BINARY */
+
 #endif /* __LOG_H__ */
@@ -0,0 +1,471 @@
+/**
+ * @file log_async.c
+ * @brief 异步日志输出（中断/DMA 发送）的实现文件。
+ *
+ * 日志拷贝进 KFIFO 字节缓冲区后立即返回。发送空闲时由 `kfifo_out_linear_ptr` 取出一段
+ * 连续数据（不跨越缓冲区末尾，不超过 `LOG_ASYNC_CHUNK` 字节）直接交给启动函数（DMA），
+ * 并立即 `kfifo_skip_count` 跳过这段数据；这段数据仍然在缓冲区中，写入时的空闲空间要减去
+ * 正在发送的字节数 `log_async_tx_len`，发送完成后才释放。
+ *
+ * @note
+ * - `LOG_ASYNC_DROP_OLDEST` 时丢弃的数据在正在发送的一段之后，跳过它们空出的位置要等
+ *   这一段发送完成才能使用，因此这种方式下先把这一段拷贝到 `LOG_ASYNC_CHUNK` 字节的
+ *   发送缓冲区，FIFO 中不再保留。
+ * - 丢弃最旧的日志时用 `kfifo_find_byte` 找到 `LOG_ASYNC_DELIM`，一次丢弃一整条日志；
+ *   读端是已经发送了一半的日志时保留它的剩余部分，丢弃它后面的日志。
+ * - `LOG_ASYNC_BLOCK` 时一条日志可以分几次写入，每次等待一段发送完成。
+ * - `LOG_ASYNC_POSIX` 时锁为 pthread 互斥锁，写线程代替 DMA 调用 `write(2)`。
+ *
+ * @version 1.0.0
+ * @date 2026-10-16
+ * @author [Jia Zhenyu]
+ *
+ * @par Example
+ * @code
+ * // STM32 HAL：UART DMA 发送
+ * static void uart_tx_dma(const void *buf, unsigned int len)
+ * {
+ *     HAL_UART_Transmit_DMA(&huart1, (uint8_t *)buf, len);
+ * }
+ *
+ * void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+ * {
+ *     if (huart == &huart1)
+ *     {
+ *         log_async_tx_complete();
+ *     }
+ * }
+ *
+ * log_async_init(uart_tx_dma);
+ * set_log_output(log_async_output);
+ * @endcode
+ */
+
+#include <string.h>
+#ifdef LOG_ASYNC_POSIX
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+
+static pthread_mutex_t log_async_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t log_async_space = PTHREAD_COND_INITIALIZER; // 一段发送完成
+static pthread_cond_t log_async_kick = PTHREAD_COND_INITIALIZER;  // 有新的一段要发送
+
+#define LOG_ASYNC_LOCK() pthread_mutex_lock(&log_async_mutex)
+#define LOG_ASYNC_UNLOCK() pthread_mutex_unlock(&log_async_mutex)
+#endif /* LOG_ASYNC_POSIX */
+
+#include "log_async.h"
+#include "kfifo.h"
+
+/**
+ * @brief 日志缓冲区
+ */
+static DEFINE_KFIFO(log_async_fifo, uint8_t, LOG_ASYNC_SIZE);
+
+/* 丢弃最旧的日志时正在发送的一段先拷贝到发送缓冲区，不占用 FIFO */
+#define LOG_ASYNC_COPY (LOG_ASYNC_POLICY == LOG_ASYNC_DROP_OLDEST)
+
+/**
+ * @brief 发送缓冲区，只在 `LOG_ASYNC_COPY` 时使用
+ */
+static uint8_t log_async_tx_buf[LOG_ASYNC_COPY ? LOG_ASYNC_CHUNK : 1];
+
+/**
+ * @brief 启动发送的函数
+ */
+static log_async_tx_func log_async_tx = NULL;
+
+/**
+ * @brief 正在发送的字节数，0 表示发送空闲
+ */
+static volatile unsigned int log_async_tx_len = 0;
+
+/**
+ * @brief 发送完成的次数，`LOG_ASYNC_BLOCK` 时用于等待
+ */
+static volatile uint32_t log_async_tx_done = 0;
+
+/**
+ * @brief 读端的数据是否从一条日志的中间开始（前半部分已经发送）
+ */
+static int log_async_partial = 0;
+
+/**
+ * @brief 统计计数
+ */
+static struct log_async_stats log_async_stats;
+
+/**
+ * @brief 获取可以写入的字节数（加锁调用）
+ *
+ * @return 空闲空间减去留在 FIFO 中正在发送的字节数
+ */
+static inline unsigned int log_async_room(void)
+{
+    return kfifo_avail(&log_async_fifo) - (LOG_ASYNC_COPY ? 0 : log_async_tx_len);
+}
+
+/**
+ * @brief 发送空闲时启动下一段发送（加锁调用）
+ */
+static void log_async_start(void)
+{
+    uint8_t *p;
+    unsigned int n;
+
+    if (log_async_tx_len || !log_async_tx)
+    {
+        return;
+    }
+
+    n = kfifo_out_linear_ptr(&log_async_fifo, &p, LOG_ASYNC_CHUNK);
+    if (n)
+    {
+        log_async_partial = p[n - 1] != LOG_ASYNC_DELIM;
+        if (LOG_ASYNC_COPY)
+        {
+            memcpy(log_async_tx_buf, p, n);
+            p = log_async_tx_buf;
+        }
+        log_async_tx_len = n;
+        kfifo_skip_count(&log_async_fifo, n);
+        log_async_tx(p, n);
+    }
+}
+
+/**
+ * @brief 从读端删除第 keep 个字节之后的 n 个字节（加锁调用）
+ *
+ * 把前面的 keep 个字节向后移动 n 个字节，再跳过 n 个字节。
+ *
+ * @param[in] keep 保留的字节数
+ * @param[in] n 删除的字节数
+ */
+static void log_async_cut(unsigned int keep, unsigned int n)
+{
+    struct __kfifo *f = &log_async_fifo.kfifo;
+    uint8_t *data = f->data;
+    unsigned int out = __kfifo_load(&f->out);
+
+    while (keep--)
+    {
+        data[__kfifo_off(f, out + n + keep)] = data[__kfifo_off(f, out + keep)];
+    }
+    kfifo_skip_count(&log_async_fifo, n);
+}
+
+/**
+ * @brief 丢弃最旧的整条日志，直到可以写入 len 字节（加锁调用）
+ *
+ * 读端是一条已经发送了前半部分的日志时保留它的后半部分，丢弃它之后的日志，
+ * 否则接收端会看到两条日志拼在一起。
+ *
+ * @param[in] len 需要的字节数
+ * @return 丢弃后可以写入的字节数
+ */
+static unsigned int log_async_drop_oldest(unsigned int len)
+{
+    unsigned int room = log_async_room();
+    unsigned int keep = 0;
+    int end;
+
+    /* 全部丢弃也放不下时不丢弃 */
+    if (len > kfifo_size(&log_async_fifo))
+    {
+        return room;
+    }
+
+    if (log_async_partial)
+    {
+        end = kfifo_find_byte(&log_async_fifo, LOG_ASYNC_DELIM, 0);
+        keep = end < 0 ? kfifo_len(&log_async_fifo) : (unsigned int)end + 1;
+    }
+
+    while (room < len)
+    {
+        unsigned int n;
+
+        end = kfifo_find_byte(&log_async_fifo, LOG_ASYNC_DELIM, keep);
+        n = (end < 0 ? kfifo_len(&log_async_fifo) : (unsigned int)end + 1) - keep;
+        if (!n)
+        {
+            break;
+        }
+
+        log_async_cut(keep, n);
+        log_async_stats.dropped++;
+        log_async_stats.dropped_bytes += n;
+        room += n;
+    }
+    return room;
+}
+
+/**
+ * @brief 等待一段发送完成（`LOG_ASYNC_BLOCK`）
+ *
+ * @param[in] done 写入前读到的发送完成次数
+ */
+static void log_async_wait(uint32_t done)
+{
+#ifdef LOG_ASYNC_POSIX
+    pthread_mutex_lock(&log_async_mutex);
+    while (log_async_tx_done == done && log_async_tx_len)
+    {
+        pthread_cond_wait(&log_async_space, &log_async_mutex);
+    }
+    pthread_mutex_unlock(&log_async_mutex);
+#else
+    while (log_async_tx_done == done && log_async_tx_len)
+    {
+    }
+#endif
+}
+
+/**
+ * @brief 初始化异步输出
+ *
+ * @param[in] tx 启动发送的函数
+ */
+void log_async_init(log_async_tx_func tx)
+{
+    LOG_ASYNC_LOCK();
+    kfifo_reset(&log_async_fifo);
+    log_async_tx = tx;
+    log_async_tx_len = 0;
+    log_async_tx_done = 0;
+    log_async_partial = 0;
+    memset(&log_async_stats, 0, sizeof(log_async_stats));
+    LOG_ASYNC_UNLOCK();
+}
+
+/**
+ * @brief 写入任意数据
+ *
+ * 空间不足时按 `LOG_ASYNC_POLICY` 处理：丢弃这条数据、丢弃最旧的日志，
+ * 或写入能放下的部分后等待一段发送完成再继续。
+ *
+ * @param[in] data 数据
+ * @param[in] len 字节数
+ * @return 写入缓冲区的字节数
+ */
+unsigned int log_async_write(const void *data, unsigned int len)
+{
+    const uint8_t *p = data;
+    unsigned int ret = 0;
+
+    for (;;)
+    {
+        unsigned int n, used;
+        uint32_t done;
+        int wait = 0;
+
+        LOG_ASYNC_LOCK();
+        done = log_async_tx_done;
+        n = log_async_room();
+        if (LOG_ASYNC_POLICY == LOG_ASYNC_DROP_OLDEST && n < len - ret)
+        {
+            n = log_async_drop_oldest(len - ret);
+        }
+
+        if (n >= len - ret)
+        {
+            n = len - ret;
+        }
+        else if (LOG_ASYNC_POLICY != LOG_ASYNC_BLOCK)
+        {
+            n = 0;
+        }
+
+        n = kfifo_in(&log_async_fifo, p + ret, n);
+        ret += n;
+        log_async_stats.written += n;
+        used = kfifo_size(&log_async_fifo) - log_async_room();
+        if (used > log_async_stats.peak)
+        {
+            log_async_stats.peak = used;
+        }
+
+        log_async_start();
+
+        if (ret < len)
+        {
+            /* 没有正在进行的发送时不会腾出空间，不再等待 */
+            if (LOG_ASYNC_POLICY == LOG_ASYNC_BLOCK && log_async_tx_len)
+            {
+                log_async_stats.blocked++;
+                wait = 1;
+            }
+            else
+            {
+                log_async_stats.dropped++;
+                log_async_stats.dropped_bytes += len - ret;
+            }
+        }
+        LOG_ASYNC_UNLOCK();
+
+        if (!wait)
+        {
+            break;
+        }
+        log_async_wait(done);
+    }
+    return ret;
+}
+
+/**
+ * @brief 文本日志的输出函数
+ *
+ * @param[in] msg 日志消息字符串
+ */
+void log_async_output(const char *msg)
+{
+    log_async_write(msg, strlen(msg));
+}
+
+/**
+ * @brief 发送完成回调
+ */
+void log_async_tx_complete(void)
+{
+    LOG_ASYNC_LOCK();
+    log_async_stats.sent += log_async_tx_len;
+    log_async_tx_len = 0;
+    log_async_tx_done++;
+    log_async_start();
+#ifdef LOG_ASYNC_POSIX
+    pthread_cond_broadcast(&log_async_space);
+#endif
+    LOG_ASYNC_UNLOCK();
+}
+
+/**
+ * @brief 获取还没有发送完成的字节数
+ *
+ * @return 缓冲区中的字节数（包括正在发送的一段）
+ */
+unsigned int log_async_pending(void)
+{
+    unsigned int n;
+
+    LOG_ASYNC_LOCK();
+    n = kfifo_len(&log_async_fifo) + log_async_tx_len;
+    LOG_ASYNC_UNLOCK();
+    return n;
+}
+
+/**
+ * @brief 获取统计计数
+ *
+ * @param[out] stats 统计计数
+ */
+void log_async_get_stats(struct log_async_stats *stats)
+{
+    LOG_ASYNC_LOCK();
+    *stats = log_async_stats;
+    LOG_ASYNC_UNLOCK();
+}
+
+#ifdef LOG_ASYNC_POSIX
+static pthread_t log_async_thread;
+static int log_async_fd = -1;
+static const void *log_async_posix_buf = NULL; // 交给写线程的一段数据
+static unsigned int log_async_posix_len = 0;
+static int log_async_posix_quit = 0;
+
+/**
+ * @brief 启动发送的函数：把这段数据交给写线程（加锁调用）
+ */
+static void log_async_posix_tx(const void *buf, unsigned int len)
+{
+    log_async_posix_buf = buf;
+    log_async_posix_len = len;
+    pthread_cond_signal(&log_async_kick);
+}
+
+/**
+ * @brief 写线程，相当于 DMA 和发送完成中断
+ */
+static void *log_async_posix_thread(void *arg)
+{
+    (void)arg;
+
+    for (;;)
+    {
+        const char *p;
+        unsigned int len;
+
+        pthread_mutex_lock(&log_async_mutex);
+        while (!log_async_posix_buf && !log_async_posix_quit)
+        {
+            pthread_cond_wait(&log_async_kick, &log_async_mutex);
+        }
+        p = log_async_posix_buf;
+        len = log_async_posix_len;
+        log_async_posix_buf = NULL;
+        pthread_mutex_unlock(&log_async_mutex);
+
+        if (!p)
+        {
+            break;
+        }
+
+        while (len)
+        {
+            ssize_t n = write(log_async_fd, p, len);
+
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                break; // 写入出错时丢弃这一段，与发送出错的 UART 相同
+            }
+            p += n;
+            len -= (unsigned int)n;
+        }
+        log_async_tx_complete();
+    }
+    return NULL;
+}
+
+/**
+ * @brief 启动 Linux 写线程
+ *
+ * @param[in] fd 文件描述符
+ * @return 0 成功，-1 创建线程失败
+ */
+int log_async_posix_start(int fd)
+{
+    log_async_fd = fd;
+    log_async_posix_buf = NULL;
+    log_async_posix_quit = 0;
+    log_async_init(log_async_posix_tx);
+
+    if (pthread_create(&log_async_thread, NULL, log_async_posix_thread, NULL) != 0)
+    {
+        log_async_init(NULL);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 等待数据全部写出，然后停止写线程
+ */
+void log_async_posix_stop(void)
+{
+    pthread_mutex_lock(&log_async_mutex);
+    while (log_async_tx_len || !kfifo_is_empty(&log_async_fifo))
+    {
+        pthread_cond_wait(&log_async_space, &log_async_mutex);
+    }
+    log_async_posix_quit = 1;
+    pthread_cond_signal(&log_async_kick);
+    pthread_mutex_unlock(&log_async_mutex);
+
+    pthread_join(log_async_thread, NULL);
+    log_async_init(NULL);
+}
+#endif /* LOG_ASYNC_POSIX */
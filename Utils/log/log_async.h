@@ -0,0 +1,159 @@
+/**
+ * @file log_async.h
+ * @brief 异步日志输出（中断/DMA 发送）的头文件。
+ *
+ * 默认的 `printf` 输出最终调用阻塞的 `HAL_UART_Transmit`，115200 波特率下一行日志
+ * 要占用约 20 ms。本模块提供一个用于 `set_log_output`（以及 `set_log_binary_output`）的输出函数：
+ * 日志只拷贝进 KFIFO 字节缓冲区后立即返回，由发送完成中断逐块取出发送。
+ *
+ * @note
+ * - 发送由用户提供的启动函数完成，例如 `HAL_UART_Transmit_DMA`。每次传入
+ *   `kfifo_out_linear_ptr` 得到的一段连续数据（不超过 `LOG_ASYNC_CHUNK` 字节），
+ *   在发送完成中断中调用 `log_async_tx_complete`，再启动下一段。
+ * - 正在发送的一段数据在缓冲区中保留到发送完成，不会被新的日志覆盖
+ *   （`LOG_ASYNC_DROP_OLDEST` 时先拷贝到单独的发送缓冲区）。
+ * - 缓冲区已满时的处理方式由 `LOG_ASYNC_POLICY` 选择：丢弃新日志、丢弃最旧的日志、
+ *   等待发送腾出空间。丢弃以整条日志为单位（文本以 `'\n'` 结尾，二进制模式以 0x00 结尾）。
+ * - 日志来自多个上下文，或者启动函数、发送完成在中断中执行时，需要定义
+ *   `LOG_ASYNC_LOCK` / `LOG_ASYNC_UNLOCK`（通常为关中断/恢复）。
+ * - 在 Linux 主机上定义 `LOG_ASYNC_POSIX` 后，`log_async_posix_start` 创建一个写线程
+ *   代替 DMA，把数据写入文件描述符，可以在主机上测试和做性能测试（需要链接 pthread）。
+ * - 需要编译 `kfifo.c`。
+ *
+ * @version 1.0.0
+ * @date 2026-10-16
+ * @author [Jia Zhenyu]
+ */
+
+#ifndef __LOG_ASYNC_H__
+#define __LOG_ASYNC_H__
+
+#include <stdint.h>
+#include "log.h"
+
+#ifndef LOG_ASYNC_SIZE
+#define LOG_ASYNC_SIZE 1024         /* 缓冲区大小（字节），必须为 2 的幂 */
+#endif
+#ifndef LOG_ASYNC_CHUNK
+#define LOG_ASYNC_CHUNK 128         /* 每次启动发送的最大字节数 */
+#endif
+#ifndef LOG_ASYNC_POLICY
+#define LOG_ASYNC_POLICY LOG_ASYNC_DROP_NEWEST  /* 缓冲区已满时的处理方式 */
+#endif
+#ifndef LOG_ASYNC_DELIM
+#ifdef LOG_BINARY
+#define LOG_ASYNC_DELIM 0x00        /* 一条日志的结束字节，用于按整条丢弃 */
+#else
+#define LOG_ASYNC_DELIM '\n'
+#endif
+#endif
+/* 多个上下文都会写日志，或者发送完成在中断中处理时，定义为关中断/恢复，例如
+   #define LOG_ASYNC_LOCK() uint32_t _primask = enter_critical()
+   #define LOG_ASYNC_UNLOCK() exit_critical(_primask) */
+#ifndef LOG_ASYNC_LOCK
+#define LOG_ASYNC_LOCK()
+#define LOG_ASYNC_UNLOCK()
+#endif
+
+/**
+ * @brief 缓冲区已满时的处理方式
+ */
+typedef enum
+{
+    LOG_ASYNC_DROP_NEWEST = 0,  // 丢弃新日志，已缓冲的日志不受影响
+    LOG_ASYNC_DROP_OLDEST,      // 丢弃最旧的日志，保留最新的日志，多占用 LOG_ASYNC_CHUNK 字节的发送缓冲区
+    LOG_ASYNC_BLOCK,            // 等待发送腾出空间，不能在中断中或关中断时使用
+} LOG_ASYNC_POLICY_TYPE;
+
+/**
+ * @brief 启动一次发送的函数类型
+ *
+ * 启动发送后立即返回，发送完成时调用 `log_async_tx_complete`。
+ * `buf` 在发送完成之前保持有效。
+ *
+ * @param[in] buf 要发送的数据
+ * @param[in] len 字节数
+ */
+typedef void (*log_async_tx_func)(const void *buf, unsigned int len);
+
+/**
+ * @brief 异步输出的统计计数
+ */
+struct log_async_stats
+{
+    uint32_t written;        // 写入缓冲区的字节数
+    uint32_t sent;           // 已发送完成的字节数
+    uint32_t dropped;        // 丢弃（或只写入一部分）的日志条数
+    uint32_t dropped_bytes;  // 丢弃的字节数
+    uint32_t blocked;        // LOG_ASYNC_BLOCK 时等待空间的次数
+    uint32_t peak;           // 缓冲区的最大占用（字节）
+};
+
+/**
+ * @brief 初始化异步输出
+ *
+ * 清空缓冲区和统计计数。之后通过 `set_log_output(log_async_output)` 使用。
+ *
+ * @param[in] tx 启动发送的函数
+ */
+void log_async_init(log_async_tx_func tx);
+
+/**
+ * @brief 文本日志的输出函数，用于 `set_log_output`
+ *
+ * @param[in] msg 日志消息字符串
+ */
+void log_async_output(const char *msg);
+
+/**
+ * @brief 写入任意数据，也可以用于 `set_log_binary_output`
+ *
+ * 数据拷贝进缓冲区后，如果当前没有正在进行的发送，立即启动发送。
+ *
+ * @param[in] data 数据
+ * @param[in] len 字节数
+ * @return 写入缓冲区的字节数，丢弃时为 0
+ */
+unsigned int log_async_write(const void *data, unsigned int len);
+
+/**
+ * @brief 发送完成回调，在发送完成中断（如 `HAL_UART_TxCpltCallback`）中调用
+ *
+ * 释放刚发送完的一段数据，缓冲区中还有数据时启动下一段发送。
+ */
+void log_async_tx_complete(void);
+
+/**
+ * @brief 获取还没有发送完成的字节数
+ *
+ * 在复位或进入低功耗之前可以等待该值变为 0。
+ *
+ * @return 缓冲区中的字节数（包括正在发送的一段）
+ */
+unsigned int log_async_pending(void);
+
+/**
+ * @brief 获取统计计数
+ *
+ * @param[out] stats 统计计数
+ */
+void log_async_get_stats(struct log_async_stats *stats);
+
+#ifdef LOG_ASYNC_POSIX
+/**
+ * @brief 启动 Linux 写线程，代替 DMA 把日志写入文件描述符
+ *
+ * 调用 `log_async_init`，写线程每次 `write` 一段数据后调用 `log_async_tx_complete`。
+ *
+ * @param[in] fd 文件描述符
+ * @return 0 成功，-1 创建线程失败
+ */
+int log_async_posix_start(int fd);
+
+/**
+ * @brief 等待缓冲区中的数据全部写出，然后停止写线程
+ */
+void log_async_posix_stop(void);
+#endif /* LOG_ASYNC_POSIX */
+
+#endif /* __LOG_ASYNC_H__ */
@@ -0,0 +1,16 @@
+/**
+ * @file log_modules.h
+ * @brief 日志模块登记表
+ *
+ * 每个模块一行 `LOG_MODULE_ENTRY(名称)`，由 `log.h` 和 `log.c` 多次包含，生成模块编号、
+ * 名称表和运行时级别表。源文件在包含 `log.h` 之前定义 `LOG_MODULE` 为登记的名称，
+ * 未定义时属于 `default` 模块。
+ *
+ * @version 1.0.0
+ * @date 2026-10-16
+ * @author [Jia Zhenyu]
+ */
+
+/* 本文件没有包含保护，需要被多次包含 */
+
+LOG_MODULE_ENTRY(default) // 未定义 LOG_MODULE 的源文件
@@ -0,0 +1,584 @@
+/**
+ * @file log_decode.c
+ * @brief 二进制日志（`LOG_BINARY`）的主机端解码器
+ *
+ * 从目标程序的 ELF 文件中读取 `log_meta` 段（格式化字符串、行号、级别、调用处地址）和符号表，
+ * 再从文件、串口或 pty 读取 COBS 编码的消息流，还原为与文本模式相同的
+ * `[LEVEL] [Fun:函数名 Line:行号] 内容` 文本。
+ *
+ * 支持 32/64 位、大小端的 ELF 文件（目标的 `long` 和指针大小由 ELF 位数决定）。
+ *
+ * 用法：
+ *   log_decode [-c] <elf> [<stream>]
+ *   -c       按日志级别输出 ANSI 颜色
+ *   stream   消息流文件、串口或 pty，默认读取 stdin；终端设备设置为原始模式
+ *
+ * Build (Linux):
+ *   gcc -O2 -std=gnu11 log_decode.c -o log_decode
+ *
+ * @version 1.0.0
+ * @date 2026-10-16
+ * @author Jia Zhenyu
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+
+#define FRAME_MAX 256 // LOG_BINARY_SIZE 不超过 255
+
+/* ELF 文件中解码需要的部分 */
+struct elf_info
+{
+    unsigned char *data;
+    size_t size;
+    int is64;          // ELFCLASS64
+    int big;           // ELFDATA2MSB
+    const unsigned char *meta;
+    size_t meta_size;
+    struct func *funcs; // 按地址排序的函数符号
+    size_t nfuncs;
+};
+
+struct func
+{
+    uint64_t addr;
+    uint64_t size;
+    const char *name;
+};
+
+/* 读取消息参数的位置 */
+struct reader
+{
+    const unsigned char *p;
+    const unsigned char *end;
+    int bad;
+};
+
+static const char *level_str[] = {"DEBUG", " INFO", " WARN", "ERROR"};
+static const char *level_color[] = {"\033[34m", "\033[32m", "\033[33m", "\033[31m"};
+
+static uint64_t rd(const struct elf_info *e, const unsigned char *p, int n)
+{
+    uint64_t v = 0;
+    int i;
+
+    for (i = 0; i < n; i++)
+        v |= (uint64_t)p[e->big ? n - 1 - i : i] << (8 * i);
+    return v;
+}
+
+/* ELF 头和节头中字段的偏移，32/64 位不同 */
+#define EH(e, off32, off64, n32, n64) rd(e, (e)->data + ((e)->is64 ? (off64) : (off32)), (e)->is64 ? (n64) : (n32))
+#define SH(e, sh, off32, off64, n32, n64) rd(e, (sh) + ((e)->is64 ? (off64) : (off32)), (e)->is64 ? (n64) : (n32))
+
+static int func_cmp(const void *a, const void *b)
+{
+    const struct func *x = a, *y = b;
+
+    return x->addr < y->addr ? -1 : x->addr > y->addr;
+}
+
+static int elf_load(struct elf_info *e, const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    const unsigned char *shdrs, *shstr, *symtab = NULL, *strtab = NULL;
+    uint64_t shoff, shentsize, shnum, shstrndx, symsize = 0, i;
+
+    if (!f)
+    {
+        perror(path);
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    e->size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    e->data = malloc(e->size);
+    if (!e->data || fread(e->data, 1, e->size, f) != e->size || e->size < 64 ||
+        memcmp(e->data, "\177ELF", 4) != 0)
+    {
+        fprintf(stderr, "%s: not an ELF file\n", path);
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+
+    e->is64 = e->data[4] == 2;
+    e->big = e->data[5] == 2;
+    shoff = EH(e, 0x20, 0x28, 4, 8);
+    shentsize = EH(e, 0x2e, 0x3a, 2, 2);
+    shnum = EH(e, 0x30, 0x3c, 2, 2);
+    shstrndx = EH(e, 0x32, 0x3e, 2, 2);
+    if (shoff + shnum * shentsize > e->size || shstrndx >= shnum)
+    {
+        fprintf(stderr, "%s: bad section headers\n", path);
+        return -1;
+    }
+    shdrs = e->data + shoff;
+    shstr = e->data + SH(e, shdrs + shstrndx * shentsize, 0x10, 0x18, 4, 8);
+
+    for (i = 0; i < shnum; i++)
+    {
+        const unsigned char *sh = shdrs + i * shentsize;
+        const char *name = (const char *)shstr + SH(e, sh, 0x00, 0x00, 4, 4);
+        uint64_t type = SH(e, sh, 0x04, 0x04, 4, 4);
+        uint64_t off = SH(e, sh, 0x10, 0x18, 4, 8);
+        uint64_t size = SH(e, sh, 0x14, 0x20, 4, 8);
+
+        if (off + size > e->size && type != 8) // SHT_NOBITS 没有内容
+            continue;
+        if (strcmp(name, "log_meta") == 0)
+        {
+            e->meta = e->data + off;
+            e->meta_size = size;
+        }
+        else if (type == 2) // SHT_SYMTAB
+        {
+            uint64_t link = SH(e, sh, 0x18, 0x28, 4, 4);
+
+            symtab = e->data + off;
+            symsize = size;
+            if (link < shnum)
+                strtab = e->data + SH(e, shdrs + link * shentsize, 0x10, 0x18, 4, 8);
+        }
+    }
+    if (!e->meta)
+    {
+        fprintf(stderr, "%s: no log_meta section\n", path);
+        return -1;
+    }
+
+    /* 函数符号，Thumb 函数地址的最低位为 1 */
+    if (symtab && strtab)
+    {
+        size_t entsize = e->is64 ? 24 : 16, n = symsize / entsize;
+
+        e->funcs = calloc(n, sizeof(*e->funcs));
+        for (i = 0; i < n && e->funcs; i++)
+        {
+            const unsigned char *s = symtab + i * entsize;
+            unsigned char info = s[e->is64 ? 4 : 12];
+
+            if ((info & 0xf) != 2) // STT_FUNC
+                continue;
+            e->funcs[e->nfuncs].name = (const char *)strtab + rd(e, s, 4);
+            e->funcs[e->nfuncs].addr = rd(e, s + (e->is64 ? 8 : 4), e->is64 ? 8 : 4) & ~(uint64_t)1;
+            e->funcs[e->nfuncs].size = rd(e, s + (e->is64 ? 16 : 8), e->is64 ? 8 : 4);
+            e->nfuncs++;
+        }
+        qsort(e->funcs, e->nfuncs, sizeof(*e->funcs), func_cmp);
+    }
+    return 0;
+}
+
+static const char *func_name(const struct elf_info *e, uint64_t pc)
+{
+    size_t lo = 0, hi = e->nfuncs;
+
+    /* 最后一个 addr <= pc 的函数 */
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+
+        if (e->funcs[mid].addr <= pc)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo > 0 && pc < e->funcs[lo - 1].addr + (e->funcs[lo - 1].size ? e->funcs[lo - 1].size : 1))
+        return e->funcs[lo - 1].name;
+    return "?";
+}
+
+static uint64_t get_varint(struct reader *r)
+{
+    uint64_t v = 0;
+    int shift = 0;
+
+    while (r->p < r->end && shift < 64)
+    {
+        unsigned char c = *r->p++;
+
+        v |= (uint64_t)(c & 0x7f) << shift;
+        if (!(c & 0x80))
+            return v;
+        shift += 7;
+    }
+    r->bad = 1;
+    return 0;
+}
+
+/* 参数的类型标记（第一个字节的低 2 位），与 log.c 相同 */
+#define T_INT 0    // zigzag 整数
+#define T_STR 1    // 字符串：值为长度，后跟内容
+#define T_DOUBLE 2 // 后跟 8 字节 double
+#define T_PTR 3    // 指针
+
+/* 解码后的一个参数 */
+struct arg
+{
+    int tag;
+    int64_t i;         // T_INT、T_PTR
+    double d;          // T_DOUBLE
+    char s[FRAME_MAX]; // T_STR
+};
+
+/*
+ * 读取一个参数：第一个字节为继续位、值的低 5 位、类型标记，之后每字节 7 位。
+ * 参数按自身的类型标记读取，与转换说明无关，两者不一致时后面的参数不会错位
+ */
+static int get_arg(const struct elf_info *e, struct reader *r, struct arg *a)
+{
+    uint64_t v, bits;
+    unsigned char c;
+    int shift = 5;
+
+    if (r->p >= r->end)
+    {
+        r->bad = 1;
+        return 0;
+    }
+    c = *r->p++;
+    a->tag = c & 3;
+    v = (c >> 2) & 0x1f;
+    while (c & 0x80)
+    {
+        if (r->p >= r->end || shift >= 64)
+        {
+            r->bad = 1;
+            return 0;
+        }
+        c = *r->p++;
+        v |= (uint64_t)(c & 0x7f) << shift;
+        shift += 7;
+    }
+
+    switch (a->tag)
+    {
+    case T_INT:
+        a->i = (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+        break;
+    case T_PTR:
+        a->i = (int64_t)v;
+        break;
+    case T_STR:
+        if (v > (uint64_t)(r->end - r->p))
+        {
+            r->bad = 1;
+            return 0;
+        }
+        memcpy(a->s, r->p, v);
+        a->s[v] = '\0';
+        r->p += v;
+        break;
+    default:
+        if (r->end - r->p < 8)
+        {
+            r->bad = 1;
+            return 0;
+        }
+        bits = rd(e, r->p, 8);
+        memcpy(&a->d, &bits, sizeof(a->d));
+        r->p += 8;
+        break;
+    }
+    return 1;
+}
+
+/* 参数类型与转换说明不一致时按参数自身的类型输出 */
+static int format_arg(char *out, size_t size, const struct arg *a)
+{
+    switch (a->tag)
+    {
+    case T_INT:
+        return snprintf(out, size, "%lld", (long long)a->i);
+    case T_STR:
+        return snprintf(out, size, "%s", a->s);
+    case T_PTR:
+        return snprintf(out, size, "%p", (void *)(uintptr_t)(uint64_t)a->i);
+    default:
+        return snprintf(out, size, "%g", a->d);
+    }
+}
+
+/*
+ * 按格式化字符串还原一条消息的内容，转换说明的解析与 log.c 中的延迟模式相同：
+ * 整数按目标上的宽度截断后用 long long 输出。参数的类型由消息中的类型标记决定，
+ * 与转换说明不一致时（例如 `%p` 的参数是字符数组）按参数自身的类型输出
+ */
+static void format_msg(const struct elf_info *e, const char *fmt, struct reader *r, char *out, size_t size)
+{
+    const char *p = fmt;
+    size_t len = 0;
+    int word = e->is64 ? 8 : 4; // 目标上 long 和指针的字节数
+    struct arg a;
+
+    out[0] = '\0';
+    while (*p && len < size - 1)
+    {
+        const char *start = p;
+        char spec[32], *s = spec;
+        int stars[2], nstars = 0, l = 0, n, tag, conv;
+
+        if (*p != '%')
+        {
+            out[len++] = *p++;
+            out[len] = '\0';
+            continue;
+        }
+        if (p[1] == '%')
+        {
+            out[len++] = '%';
+            out[len] = '\0';
+            p += 2;
+            continue;
+        }
+
+        *s++ = *p++;
+        while (*p && strchr("-+ #0", *p) && s < spec + 16)
+            *s++ = *p++;
+        if (*p == '*')
+        {
+            stars[nstars++] = get_arg(e, r, &a) && a.tag != T_STR ? (int)a.i : 0;
+            *s++ = *p++;
+        }
+        while (*p >= '0' && *p <= '9' && s < spec + 20)
+            *s++ = *p++;
+        if (*p == '.')
+        {
+            *s++ = *p++;
+            if (*p == '*')
+            {
+                stars[nstars++] = get_arg(e, r, &a) && a.tag != T_STR ? (int)a.i : 0;
+                *s++ = *p++;
+            }
+            while (*p >= '0' && *p <= '9' && s < spec + 24)
+                *s++ = *p++;
+        }
+        for (;; p++)
+        {
+            if (*p == 'h')
+                l = l > 0 ? l : l - 1;
+            else if (*p == 'l')
+                l = l < 0 ? 1 : l + 1;
+            else if (*p == 'z' || *p == 't')
+                l = 1;
+            else if (*p == 'j' || *p == 'q' || *p == 'L')
+                l = 2;
+            else
+                break;
+        }
+        if (!*p)
+            break;
+
+#define OUT(...)                                                                                  \
+    (nstars == 0   ? snprintf(out + len, size - len, spec, __VA_ARGS__)                           \
+     : nstars == 1 ? snprintf(out + len, size - len, spec, stars[0], __VA_ARGS__)                 \
+                   : snprintf(out + len, size - len, spec, stars[0], stars[1], __VA_ARGS__))
+
+        /* 转换说明需要的参数类型，整数和指针可以互换 */
+        if (strchr("diouxXc", *p))
+            tag = T_INT;
+        else if (*p == 's')
+            tag = T_STR;
+        else if (*p == 'p')
+            tag = T_PTR;
+        else if (strchr("eEfFgGaA", *p))
+            tag = T_DOUBLE;
+        else
+            tag = -1;
+
+        conv = *p;
+        if (tag >= 0)
+        {
+            if (!get_arg(e, r, &a))
+                break;
+            if (a.tag != tag && !((tag == T_INT || tag == T_PTR) && (a.tag == T_INT || a.tag == T_PTR)))
+                conv = 0;
+        }
+
+        switch (conv)
+        {
+        case 0:
+            n = format_arg(out + len, size - len, &a);
+            break;
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+        {
+            int64_t v = a.i;
+            int bytes = l <= -2 ? 1 : l == -1 ? 2 : l == 0 ? 4 : l == 1 ? word : 8;
+            int sign = *p == 'd' || *p == 'i';
+
+            if (bytes < 8)
+            {
+                uint64_t m = ((uint64_t)1 << (8 * bytes)) - 1;
+
+                v = (int64_t)((uint64_t)v & m);
+                if (sign && (v >> (8 * bytes - 1)))
+                    v -= (int64_t)m + 1;
+            }
+            s = stpcpy(s, "ll");
+            *s++ = *p;
+            *s = '\0';
+            n = OUT((long long)v);
+            break;
+        }
+        case 'c':
+            *s++ = 'c';
+            *s = '\0';
+            n = OUT((int)(char)a.i);
+            break;
+        case 's':
+            *s++ = 's';
+            *s = '\0';
+            n = OUT(a.s);
+            break;
+        case 'p':
+            *s++ = 'p';
+            *s = '\0';
+            n = OUT((void *)(uintptr_t)(uint64_t)a.i);
+            break;
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            *s++ = *p;
+            *s = '\0';
+            n = OUT(a.d);
+            break;
+        default:
+            /* 不支持的转换说明原样输出 */
+            n = snprintf(out + len, size - len, "%.*s", (int)(p + 1 - start), start);
+            break;
+        }
+#undef OUT
+        p++;
+        if (n > 0)
+            len += (size_t)n < size - len ? (size_t)n : size - len - 1;
+        if (r->bad)
+            break;
+    }
+}
+
+static void decode_frame(const struct elf_info *e, const unsigned char *f, size_t n, int color)
+{
+    unsigned char msg[FRAME_MAX];
+    char text[1024];
+    size_t i = 0, m = 0;
+    struct reader r;
+    const unsigned char *meta;
+    uint64_t id, pc;
+    int ptr = e->is64 ? 8 : 4, line;
+    unsigned int level;
+
+    /* COBS 解码 */
+    while (i < n)
+    {
+        unsigned char code = f[i++];
+
+        if (!code || i + code - 1 > n)
+            return;
+        memcpy(msg + m, f + i, code - 1);
+        m += code - 1;
+        i += code - 1;
+        if (i < n && code != 0xff)
+            msg[m++] = 0;
+    }
+
+    r.p = msg;
+    r.end = msg + m;
+    r.bad = 0;
+    id = get_varint(&r);
+    if (r.bad || id + ptr + 5 > e->meta_size)
+    {
+        printf("<bad message id %llu>\n", (unsigned long long)id);
+        return;
+    }
+
+    /* struct log_meta：pc、line、level、fmt[] */
+    meta = e->meta + id;
+    pc = rd(e, meta, ptr) & ~(uint64_t)1;
+    line = (int)rd(e, meta + ptr, 4);
+    level = meta[ptr + 4];
+
+    format_msg(e, (const char *)meta + ptr + 5, &r, text, sizeof(text));
+    if (level > 3)
+        level = 3;
+    if (color)
+        printf("%s[%s] [Fun:%s Line:%d] %s\033[0m", level_color[level], level_str[level],
+               func_name(e, pc), line, text);
+    else
+        printf("[%s] [Fun:%s Line:%d] %s", level_str[level], func_name(e, pc), line, text);
+    if (r.bad)
+        printf("<truncated>\n");
+}
+
+int main(int argc, char *argv[])
+{
+    struct elf_info elf = {0};
+    unsigned char frame[FRAME_MAX], buf[4096];
+    size_t n = 0;
+    ssize_t got;
+    int fd = 0, color = 0, a = 1;
+
+    if (a < argc && strcmp(argv[a], "-c") == 0)
+    {
+        color = 1;
+        a++;
+    }
+    if (a >= argc)
+    {
+        fprintf(stderr, "usage: %s [-c] <elf> [<stream>]\n", argv[0]);
+        return 2;
+    }
+    if (elf_load(&elf, argv[a++]) < 0)
+        return 1;
+
+    if (a < argc && (fd = open(argv[a], O_RDONLY | O_NOCTTY)) < 0)
+    {
+        perror(argv[a]);
+        return 1;
+    }
+    if (isatty(fd))
+    {
+        struct termios t;
+
+        if (tcgetattr(fd, &t) == 0)
+        {
+            cfmakeraw(&t);
+            tcsetattr(fd, TCSANOW, &t);
+        }
+    }
+
+    /* 按 0x00 分帧，超长的帧丢弃到下一个 0x00 */
+    while ((got = read(fd, buf, sizeof(buf))) > 0)
+    {
+        for (ssize_t i = 0; i < got; i++)
+        {
+            if (buf[i])
+            {
+                if (n < sizeof(frame))
+                    frame[n] = buf[i];
+                n++;
+                continue;
+            }
+            if (n && n <= sizeof(frame))
+                decode_frame(&elf, frame, n, color);
+            n = 0;
+        }
+        fflush(stdout);
+    }
+    return 0;
+}
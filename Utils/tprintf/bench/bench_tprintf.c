@@ -0,0 +1,255 @@
+/*
+ * bench_tprintf.c
+ * tprintf_vsnprintf against glibc vsnprintf on the same format strings:
+ *
+ * 1. output check: every combination of flags, width, precision and length
+ *    modifier for the integer conversions, plus %s %c %p, must give the
+ *    same text as glibc (a mismatch is printed and makes the exit status 1).
+ * 2. throughput: time per call for typical log/error lines.
+ * 3. stack: each formatter runs once on a thread whose stack was filled with
+ *    a pattern, the untouched part is measured afterwards (high water mark
+ *    of the formatting call alone, the caller's frame is the same for both).
+ *
+ * Build (Linux):
+ *   gcc -O2 -std=gnu11 -pthread -I.. bench_tprintf.c ../tprintf.c -o bench_tprintf
+ */
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "tprintf.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLES() __rdtsc()
+#define UNIT "cycles"
+#else
+static inline uint64_t ns_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#define CYCLES() ns_now()
+#define UNIT "ns"
+#endif
+
+#define ROUNDS 200000U
+#define STACK_SIZE (64 * 1024)
+#define STACK_FILL 0xa5
+
+typedef int (*vfmt_func)(char *buf, size_t size, const char *fmt, va_list ap);
+
+static unsigned int checks, errors;
+
+/* same arguments to both, compare text and return value */
+static void check(const char *fmt, ...)
+{
+    char a[128], b[128];
+    va_list ap;
+    int na, nb;
+
+    va_start(ap, fmt);
+    na = vsnprintf(a, sizeof(a), fmt, ap);
+    va_end(ap);
+    va_start(ap, fmt);
+    nb = tprintf_vsnprintf(b, sizeof(b), fmt, ap);
+    va_end(ap);
+
+    checks++;
+    if (na != nb || strcmp(a, b))
+    {
+        errors++;
+        if (errors <= 20)
+            printf("mismatch \"%s\": glibc \"%s\" (%d), tprintf \"%s\" (%d)\n", fmt, a, na, b, nb);
+    }
+}
+
+static void check_all(void)
+{
+    static const char *const flags[] = {"", "-", "0", "+", " ", "#", "-0", "+0", "- ", "#0", "-#"};
+    static const char *const widths[] = {"", "1", "6", "13"};
+    static const char *const precs[] = {"", ".", ".0", ".1", ".4", ".12"};
+    static const char *const lens[] = {"hh", "h", "", "l", "ll", "z", "j"};
+    static const char convs[] = "diuxXo";
+    static const long long values[] = {0, 1, -1, 7, 42, -99, 255, 256, 1000, -32768, 65535, 123456789,
+                                       INT_MAX, INT_MIN, UINT_MAX, 4294967296LL, LLONG_MAX, LLONG_MIN};
+    char fmt[32];
+    size_t f, w, p, l, c, v;
+
+    for (f = 0; f < sizeof(flags) / sizeof(flags[0]); f++)
+        for (w = 0; w < sizeof(widths) / sizeof(widths[0]); w++)
+            for (p = 0; p < sizeof(precs) / sizeof(precs[0]); p++)
+                for (l = 0; l < sizeof(lens) / sizeof(lens[0]); l++)
+                    for (c = 0; c < sizeof(convs) - 1; c++)
+                    {
+                        snprintf(fmt, sizeof(fmt), "[%%%s%s%s%s%c]", flags[f], widths[w], precs[p], lens[l], convs[c]);
+                        for (v = 0; v < sizeof(values) / sizeof(values[0]); v++)
+                        {
+                            long long x = values[v];
+
+                            if (lens[l][0] == 'l' && lens[l][1] == 'l')
+                                check(fmt, x);
+                            else if (lens[l][0] == 'j')
+                                check(fmt, (intmax_t)x);
+                            else if (lens[l][0] == 'l')
+                                check(fmt, (long)x);
+                            else if (lens[l][0] == 'z')
+                                check(fmt, (size_t)x);
+                            else
+                                check(fmt, (int)x);
+                        }
+                    }
+
+    for (f = 0; f < sizeof(flags) / sizeof(flags[0]); f++)
+        for (w = 0; w < sizeof(widths) / sizeof(widths[0]); w++)
+            for (p = 0; p < sizeof(precs) / sizeof(precs[0]); p++)
+            {
+                if (strchr(flags[f], '0') || strchr(flags[f], '#') || strchr(flags[f], '+') || strchr(flags[f], ' '))
+                    continue; // undefined for %s and %c
+                snprintf(fmt, sizeof(fmt), "[%%%s%s%ss]", flags[f], widths[w], precs[p]);
+                check(fmt, "hello, world");
+                check(fmt, "");
+                snprintf(fmt, sizeof(fmt), "[%%%s%sc]", flags[f], widths[w]);
+                check(fmt, 'A');
+                snprintf(fmt, sizeof(fmt), "[%%%s%sp]", flags[f], widths[w]);
+                check(fmt, (void *)&checks);
+            }
+
+    check("%*d|%-*d|%.*d|%.*s|", 8, -5, 8, 5, 5, 42, 3, "abcdef");
+    check("%*d|%.*d|", -6, 7, -1, 7);
+    check("100%% %s %c%c", "done", 'o', 'k');
+    check("%s", (char *)NULL);
+    check("[Fun:%s Line:%d] %s", __func__, __LINE__, "msg");
+}
+
+/* typical lines of the log and error paths */
+#define CASES(X)                                                                                   \
+    X("ctrl: i=%u err=%d state=%s\n", 12345u, -42, "run")                                          \
+    X("[Error %d]: %s at \"%s\":[%d] in function [%s]", -22, "HW failure", "motor.c", 318, "step") \
+    X("adc=%4u %4u %4u %4u id=%08lx", 1023u, 4u, 512u, 77u, 0xdeadbeefUL)                          \
+    X("p=%p len=%zu crc=%#06x", (void *)&checks, (size_t)4096, 0x1d0fu)                            \
+    X("t=%llu dt=%lld", 123456789012ULL, -987654321LL)
+
+static int wrap(vfmt_func f, char *buf, size_t size, const char *fmt, ...)
+{
+    va_list ap;
+    int n;
+
+    va_start(ap, fmt);
+    n = f(buf, size, fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+static void bench(void)
+{
+    static const vfmt_func funcs[] = {vsnprintf, tprintf_vsnprintf};
+    static const char *const names[] = {"glibc vsnprintf", "tprintf_vsnprintf"};
+    char buf[256];
+    volatile int sink = 0;
+    unsigned int k, r;
+    int c = 0;
+
+#define RUN(fmt, ...)                                                                                  \
+    for (k = 0; k < 2; k++)                                                                            \
+    {                                                                                                  \
+        uint64_t t0 = CYCLES();                                                                        \
+        int n = 0;                                                                                     \
+        for (r = 0; r < ROUNDS; r++)                                                                   \
+            n += wrap(funcs[k], buf, sizeof(buf), fmt, __VA_ARGS__);                                   \
+        sink += n;                                                                                     \
+        printf("case %d %-18s %7.1f %s/call  %6.1f chars/call\n", c, names[k],                         \
+               (double)(CYCLES() - t0) / ROUNDS, UNIT, (double)n / ROUNDS);                            \
+    }                                                                                                  \
+    c++;
+
+    CASES(RUN)
+#undef RUN
+    (void)sink;
+}
+
+/* stack high water mark of one formatting call */
+struct stack_job
+{
+    vfmt_func f;
+};
+
+static void *stack_thread(void *arg)
+{
+    struct stack_job *job = arg;
+    char buf[256];
+
+#define ONE(fmt, ...) wrap(job->f, buf, sizeof(buf), fmt, __VA_ARGS__);
+    CASES(ONE)
+#undef ONE
+    return NULL;
+}
+
+static size_t stack_use(vfmt_func f)
+{
+    static unsigned char stack[STACK_SIZE] __attribute__((aligned(64)));
+    struct stack_job job = {f};
+    pthread_attr_t attr;
+    pthread_t t;
+    size_t i;
+
+    memset(stack, STACK_FILL, sizeof(stack));
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, stack, sizeof(stack));
+    pthread_create(&t, &attr, stack_thread, &job);
+    pthread_join(t, NULL);
+    pthread_attr_destroy(&attr);
+
+    for (i = 0; i < sizeof(stack) && stack[i] == STACK_FILL; i++)
+        ;
+    return sizeof(stack) - i;
+}
+
+static void *empty_thread(void *arg)
+{
+    (void)arg;
+    return NULL;
+}
+
+static size_t stack_base(void)
+{
+    static unsigned char stack[STACK_SIZE] __attribute__((aligned(64)));
+    pthread_attr_t attr;
+    pthread_t t;
+    size_t i;
+
+    memset(stack, STACK_FILL, sizeof(stack));
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, stack, sizeof(stack));
+    pthread_create(&t, &attr, empty_thread, NULL);
+    pthread_join(t, NULL);
+    pthread_attr_destroy(&attr);
+
+    for (i = 0; i < sizeof(stack) && stack[i] == STACK_FILL; i++)
+        ;
+    return sizeof(stack) - i;
+}
+
+int main(void)
+{
+    size_t base, s_libc, s_tp;
+
+    check_all();
+    printf("output check: %u formats, %u mismatches\n", checks, errors);
+
+    bench();
+
+    base = stack_base();
+    s_libc = stack_use(vsnprintf);
+    s_tp = stack_use(tprintf_vsnprintf);
+    printf("stack: glibc vsnprintf %zu bytes, tprintf_vsnprintf %zu bytes (thread start %zu bytes subtracted)\n",
+           s_libc - base, s_tp - base, base);
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,54 @@
+#include <stdio.h>
+#include "tprintf.h"
+
+// 示例 1：输出函数，每一段结果直接写到控制台，不需要缓冲区
+static void console_sink(void *ctx, const char *s, unsigned int len)
+{
+    (void)ctx;
+    fwrite(s, 1, len, stdout);
+}
+
+void example_sink(void)
+{
+    printf("Example 1 输出函数\n");
+    tprintf_format(console_sink, NULL, "adc=%4u %4u id=%08lx err=%-5d|\n", 1023u, 4u, 0xdeadbeefUL, -22);
+    tprintf_format(console_sink, NULL, "p=%p len=%zu crc=%#06x f=%f\n", (void *)&example_sink, (size_t)4096, 0x1d0fu, 1.5);
+}
+
+// 示例 2：格式化到字符串，与 snprintf 相同
+void example_snprintf(void)
+{
+    char buf[16];
+    int n;
+
+    printf("Example 2 格式化到字符串\n");
+    n = tprintf_snprintf(buf, sizeof(buf), "%s:%d", "motor.c", 318);
+    printf("\"%s\" (%d)\n", buf, n);
+    n = tprintf_snprintf(buf, sizeof(buf), "t=%llu dt=%lld", 123456789012ULL, -987654321LL);
+    printf("\"%s\" (%d, 被截断)\n", buf, n);
+}
+
+#ifdef TPRINTF_KFIFO
+// 示例 3：直接写入 KFIFO
+void example_kfifo(void)
+{
+    DEFINE_KFIFO(fifo, char, 64);
+    char buf[64];
+    unsigned int n;
+
+    printf("Example 3 写入 KFIFO\n");
+    kfifo_printf(&fifo, "state=%s cnt=%u\n", "run", 12345u);
+    n = kfifo_out(&fifo, buf, sizeof(buf));
+    fwrite(buf, 1, n, stdout);
+}
+#endif
+
+int main(void)
+{
+    example_sink();
+    example_snprintf();
+#ifdef TPRINTF_KFIFO
+    example_kfifo();
+#endif
+    return 0;
+}
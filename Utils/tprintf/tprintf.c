@@ -0,0 +1,577 @@
+/**
+ * @file tprintf.c
+ * @brief 只支持整数的小型 printf 格式化引擎的实现文件。
+ *
+ * 格式化字符串中两个转换说明之间的普通字符整段交给输出函数；每个转换说明依次输出
+ * 左填充、符号/前缀、补零、数字、右填充，数字在栈上最多 24 字节的数组中从低位向高位生成。
+ * 除此之外不使用任何缓冲区，栈的使用量与结果的长度无关。
+ *
+ * @version 1.0.0
+ * @date 2026-10-16
+ * @author [Jia Zhenyu]
+ *
+ * @par Example
+ * @code
+ * // 直接输出到串口
+ * static void uart_sink(void *ctx, const char *s, unsigned int len)
+ * {
+ *     HAL_UART_Transmit((UART_HandleTypeDef *)ctx, (uint8_t *)s, len, HAL_MAX_DELAY);
+ * }
+ *
+ * tprintf_format(uart_sink, &huart1, "adc=%4u err=%-6d id=%08lx\r\n", adc, err, id);
+ *
+ * char buf[32];
+ * tprintf_snprintf(buf, sizeof(buf), "%s: %d", name, value);
+ * @endcode
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "tprintf.h"
+
+/* 标志 */
+#define TP_LEFT 0x01  // '-'：左对齐
+#define TP_ZERO 0x02  // '0'：用 0 填充
+#define TP_PLUS 0x04  // '+'：正数加 '+'
+#define TP_SPACE 0x08 // ' '：正数加空格
+#define TP_ALT 0x10   // '#'：十六进制加 0x，八进制加 0
+#define TP_UPPER 0x20 // %X
+#define TP_NEG 0x40   // 负数
+#define TP_PTR 0x80   // %p：总是加 0x
+
+/* 长度修饰符 */
+enum
+{
+    TP_LEN_INT = 0, // 无、h、hh
+    TP_LEN_LONG,    // l
+    TP_LEN_LLONG,   // ll、j
+    TP_LEN_SIZE,    // z、t
+};
+
+/**
+ * @brief 格式化过程中的输出状态
+ */
+struct tp_out
+{
+    tprintf_sink_func sink;
+    void *ctx;
+    int n; // 已输出的字符数
+};
+
+static inline void tp_put(struct tp_out *o, const char *s, unsigned int len)
+{
+    if (len)
+    {
+        o->sink(o->ctx, s, len);
+        o->n += len;
+    }
+}
+
+/**
+ * @brief 输出 n 个填充字符
+ */
+static void tp_pad(struct tp_out *o, char c, int n)
+{
+    static const char spaces[16] = "                ";
+    static const char zeros[16] = "0000000000000000";
+    const char *s = c == '0' ? zeros : spaces;
+
+    while (n > 0)
+    {
+        unsigned int l = n < (int)sizeof(spaces) ? (unsigned int)n : sizeof(spaces);
+
+        tp_put(o, s, l);
+        n -= l;
+    }
+}
+
+/**
+ * @brief 输出一段字符串，按宽度填充
+ */
+static void tp_field(struct tp_out *o, const char *s, unsigned int len, unsigned int flags, int width)
+{
+    int pad = width - (int)len;
+
+    if (!(flags & TP_LEFT))
+    {
+        tp_pad(o, ' ', pad);
+    }
+    tp_put(o, s, len);
+    if (flags & TP_LEFT)
+    {
+        tp_pad(o, ' ', pad);
+    }
+}
+
+/**
+ * @brief 输出一个整数
+ *
+ * @param[in] v 绝对值
+ * @param[in] base 进制（8、10、16）
+ * @param[in] flags 标志，TP_NEG 表示负数
+ * @param[in] width 宽度
+ * @param[in] prec 精度（最少数字个数），-1 表示未指定
+ * @param[in] is_signed 是否为有符号转换（决定 '+'、' ' 是否有效）
+ */
+static void tp_number(struct tp_out *o, unsigned long long v, unsigned int base, unsigned int flags,
+                      int width, int prec, int is_signed)
+{
+    const char *digits = (flags & TP_UPPER) ? "0123456789ABCDEF" : "0123456789abcdef";
+    char buf[24];
+    char *p = buf + sizeof(buf);
+    char prefix[2];
+    int plen = 0, ndig, zeros = 0, pad;
+
+    if (base == 16)
+    {
+        for (; v; v >>= 4)
+        {
+            *--p = digits[v & 15];
+        }
+    }
+    else if (base == 8)
+    {
+        for (; v; v >>= 3)
+        {
+            *--p = (char)('0' + (v & 7));
+        }
+    }
+    else
+    {
+        /* 大数先用 64 位除法降到 32 位以内，其余位数都用 32 位除法 */
+        while (v > 0xffffffffULL)
+        {
+            *--p = (char)('0' + v % 10);
+            v /= 10;
+        }
+        for (uint32_t w = (uint32_t)v; w; w /= 10)
+        {
+            *--p = (char)('0' + w % 10);
+        }
+    }
+    ndig = (int)(buf + sizeof(buf) - p);
+
+    /* 精度为 0 的 0 不输出数字，其他情况的 0 输出一个 '0' */
+    if (!ndig && prec != 0)
+    {
+        *--p = '0';
+        ndig = 1;
+    }
+
+    if (is_signed)
+    {
+        if (flags & TP_NEG)
+            prefix[plen++] = '-';
+        else if (flags & TP_PLUS)
+            prefix[plen++] = '+';
+        else if (flags & TP_SPACE)
+            prefix[plen++] = ' ';
+    }
+    else if ((flags & TP_PTR) || ((flags & TP_ALT) && base == 16 && ndig && *p != '0'))
+    {
+        prefix[plen++] = '0';
+        prefix[plen++] = (flags & TP_UPPER) ? 'X' : 'x';
+    }
+    else if ((flags & TP_ALT) && base == 8 && (!ndig || *p != '0') && prec <= ndig)
+    {
+        /* '#' 的八进制保证第一个数字是 0 */
+        prefix[plen++] = '0';
+    }
+
+    if (prec > ndig)
+    {
+        zeros = prec - ndig;
+    }
+    pad = width - plen - zeros - ndig;
+    if ((flags & (TP_ZERO | TP_LEFT)) == TP_ZERO && prec < 0 && pad > 0)
+    {
+        zeros += pad;
+        pad = 0;
+    }
+
+    if (!(flags & TP_LEFT))
+    {
+        tp_pad(o, ' ', pad);
+    }
+    tp_put(o, prefix, plen);
+    tp_pad(o, '0', zeros);
+    tp_put(o, p, ndig);
+    if (flags & TP_LEFT)
+    {
+        tp_pad(o, ' ', pad);
+    }
+}
+
+/**
+ * @brief 格式化并输出到输出函数
+ *
+ * @param[in] sink 输出函数
+ * @param[in] ctx 传给输出函数的上下文
+ * @param[in] fmt 格式化字符串
+ * @param[in] ap 可变参数
+ * @return 输出的字符数
+ */
+int tprintf_vformat(tprintf_sink_func sink, void *ctx, const char *fmt, va_list ap)
+{
+    struct tp_out o = {sink, ctx, 0};
+    const char *p = fmt;
+
+    for (;;)
+    {
+        const char *q = p;
+        unsigned int flags = 0, base = 10;
+        int width = 0, prec = -1, len = TP_LEN_INT, hh = 0, is_signed = 0;
+        unsigned long long v;
+
+        while (*q && *q != '%')
+        {
+            q++;
+        }
+        tp_put(&o, p, (unsigned int)(q - p));
+        if (!*q)
+        {
+            break;
+        }
+        p = q + 1;
+
+        /* 标志 */
+        for (;; p++)
+        {
+            if (*p == '-')
+                flags |= TP_LEFT;
+            else if (*p == '0')
+                flags |= TP_ZERO;
+            else if (*p == '+')
+                flags |= TP_PLUS;
+            else if (*p == ' ')
+                flags |= TP_SPACE;
+            else if (*p == '#')
+                flags |= TP_ALT;
+            else
+                break;
+        }
+
+        /* 宽度 */
+        if (*p == '*')
+        {
+            width = va_arg(ap, int);
+            if (width < 0)
+            {
+                flags |= TP_LEFT;
+                width = -width;
+            }
+            p++;
+        }
+        else
+        {
+            while (*p >= '0' && *p <= '9')
+            {
+                width = width * 10 + (*p++ - '0');
+            }
+        }
+
+        /* 精度，负数相当于未指定 */
+        if (*p == '.')
+        {
+            p++;
+            prec = 0;
+            if (*p == '*')
+            {
+                prec = va_arg(ap, int);
+                if (prec < 0)
+                {
+                    prec = -1;
+                }
+                p++;
+            }
+            else
+            {
+                while (*p >= '0' && *p <= '9')
+                {
+                    prec = prec * 10 + (*p++ - '0');
+                }
+            }
+        }
+
+        /* 长度修饰符 */
+        switch (*p)
+        {
+        case 'h':
+            hh = p[1] == 'h' ? 2 : 1;
+            p += hh;
+            break;
+        case 'l':
+            if (p[1] == 'l')
+            {
+                len = TP_LEN_LLONG;
+                p++;
+            }
+            else
+            {
+                len = TP_LEN_LONG;
+            }
+            p++;
+            break;
+        case 'j':
+            len = TP_LEN_LLONG;
+            p++;
+            break;
+        case 'z':
+        case 't':
+            len = TP_LEN_SIZE;
+            p++;
+            break;
+        case 'L':
+            len = TP_LEN_LLONG; // 只用于 %Lf 取出 long double
+            p++;
+            break;
+        default:
+            break;
+        }
+
+        switch (*p)
+        {
+        case 'd':
+        case 'i':
+        {
+            long long s;
+
+            if (len == TP_LEN_LLONG)
+                s = va_arg(ap, long long);
+            else if (len == TP_LEN_LONG)
+                s = va_arg(ap, long);
+            else if (len == TP_LEN_SIZE)
+                s = (long long)va_arg(ap, ptrdiff_t);
+            else
+                s = va_arg(ap, int);
+
+            if (hh == 1)
+                s = (short)s;
+            else if (hh == 2)
+                s = (signed char)s;
+
+            if (s < 0)
+            {
+                flags |= TP_NEG;
+                v = 0ULL - (unsigned long long)s;
+            }
+            else
+            {
+                v = (unsigned long long)s;
+            }
+            is_signed = 1;
+            goto number;
+        }
+
+        case 'X':
+            flags |= TP_UPPER;
+            /* fall through */
+        case 'x':
+            base = 16;
+            goto unsigned_arg;
+        case 'o':
+            base = 8;
+            /* fall through */
+        case 'u':
+        unsigned_arg:
+            if (len == TP_LEN_LLONG)
+                v = va_arg(ap, unsigned long long);
+            else if (len == TP_LEN_LONG)
+                v = va_arg(ap, unsigned long);
+            else if (len == TP_LEN_SIZE)
+                v = va_arg(ap, size_t);
+            else
+                v = va_arg(ap, unsigned int);
+
+            if (hh == 1)
+                v = (unsigned short)v;
+            else if (hh == 2)
+                v = (unsigned char)v;
+        number:
+            tp_number(&o, v, base, flags, width, prec, is_signed);
+            break;
+
+        case 'p':
+            v = (uintptr_t)va_arg(ap, void *);
+            tp_number(&o, v, 16, flags | TP_PTR, width, prec, 0);
+            break;
+
+        case 'c':
+        {
+            char c = (char)va_arg(ap, int);
+
+            tp_field(&o, &c, 1, flags, width);
+            break;
+        }
+
+        case 's':
+        {
+            const char *s = va_arg(ap, const char *);
+            unsigned int l = 0;
+
+            if (!s)
+            {
+                s = "(null)";
+            }
+            while ((prec < 0 || l < (unsigned int)prec) && s[l])
+            {
+                l++;
+            }
+            tp_field(&o, s, l, flags, width);
+            break;
+        }
+
+        case '%':
+            tp_put(&o, "%", 1);
+            break;
+
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            /* 不支持浮点数，取出参数以免之后的参数错位 */
+            if (len == TP_LEN_LLONG)
+                (void)va_arg(ap, long double);
+            else
+                (void)va_arg(ap, double);
+            tp_field(&o, "?", 1, flags, width);
+            break;
+
+        case 'n':
+            (void)va_arg(ap, void *);
+            break;
+
+        case '\0':
+            /* 格式化字符串以不完整的转换说明结束 */
+            tp_put(&o, q, (unsigned int)(p - q));
+            return o.n;
+
+        default:
+            tp_put(&o, q, (unsigned int)(p + 1 - q));
+            break;
+        }
+        p++;
+    }
+    return o.n;
+}
+
+/**
+ * @brief 格式化并输出到输出函数
+ *
+ * @param[in] sink 输出函数
+ * @param[in] ctx 传给输出函数的上下文
+ * @param[in] fmt 格式化字符串
+ * @param[in] ... 格式化字符串的可变参数
+ * @return 输出的字符数
+ */
+int tprintf_format(tprintf_sink_func sink, void *ctx, const char *fmt, ...)
+{
+    va_list ap;
+    int n;
+
+    va_start(ap, fmt);
+    n = tprintf_vformat(sink, ctx, fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+/**
+ * @brief 字符串输出的状态
+ */
+struct tp_buf
+{
+    char *p;
+    size_t room; // 剩余空间，不包括结尾的 '\0'
+};
+
+static void tp_buf_sink(void *ctx, const char *s, unsigned int len)
+{
+    struct tp_buf *b = ctx;
+    size_t l = len < b->room ? len : b->room;
+
+    memcpy(b->p, s, l);
+    b->p += l;
+    b->room -= l;
+}
+
+/**
+ * @brief 格式化到字符串
+ *
+ * @param[out] buf 字符串缓冲区
+ * @param[in] size 缓冲区大小
+ * @param[in] fmt 格式化字符串
+ * @param[in] ap 可变参数
+ * @return 完整结果的字符数（不包括 '\0'）
+ */
+int tprintf_vsnprintf(char *buf, size_t size, const char *fmt, va_list ap)
+{
+    struct tp_buf b = {buf, size ? size - 1 : 0};
+    int n = tprintf_vformat(tp_buf_sink, &b, fmt, ap);
+
+    if (size)
+    {
+        *b.p = '\0';
+    }
+    return n;
+}
+
+/**
+ * @brief 格式化到字符串
+ *
+ * @param[out] buf 字符串缓冲区
+ * @param[in] size 缓冲区大小
+ * @param[in] fmt 格式化字符串
+ * @param[in] ... 格式化字符串的可变参数
+ * @return 完整结果的字符数（不包括 '\0'）
+ */
+int tprintf_snprintf(char *buf, size_t size, const char *fmt, ...)
+{
+    va_list ap;
+    int n;
+
+    va_start(ap, fmt);
+    n = tprintf_vsnprintf(buf, size, fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+#ifdef TPRINTF_KFIFO
+/**
+ * @brief KFIFO 输出的状态
+ */
+struct tp_kfifo
+{
+    struct __kfifo *fifo;
+    int n; // 写入的字符数
+};
+
+static void tp_kfifo_sink(void *ctx, const char *s, unsigned int len)
+{
+    struct tp_kfifo *k = ctx;
+
+    k->n += (int)__kfifo_in(k->fifo, s, len);
+}
+
+/**
+ * @brief 格式化并写入 KFIFO
+ *
+ * @param[in] fifo KFIFO
+ * @param[in] fmt 格式化字符串
+ * @param[in] ... 格式化字符串的可变参数
+ * @return 写入 KFIFO 的字符数
+ */
+int tprintf_kfifo(struct __kfifo *fifo, const char *fmt, ...)
+{
+    struct tp_kfifo k = {fifo, 0};
+    va_list ap;
+
+    va_start(ap, fmt);
+    tprintf_vformat(tp_kfifo_sink, &k, fmt, ap);
+    va_end(ap);
+    return k.n;
+}
+#endif /* TPRINTF_KFIFO */
@@ -0,0 +1,134 @@
+/**
+ * @file tprintf.h
+ * @brief 只支持整数的小型 printf 格式化引擎的头文件。
+ *
+ * 日志和错误处理只用到整数、字符串和指针，libc 的 `vsnprintf` 却带着浮点支持，
+ * 占用 Flash、栈和时间。本文件提供一个只支持整数的格式化引擎，结果按段直接交给
+ * 调用者提供的输出函数（sink），或写入字符串、KFIFO，中间不经过缓冲区。
+ *
+ * @note
+ * - 转换说明：`%d %i %u %x %X %o %c %s %p %%`。
+ * - 标志 `- 0 + 空格 #`，宽度和精度（包括 `*`），长度修饰符 `hh h l ll z j t`。
+ * - 不支持浮点数：`%f %e %g %a` 取出一个 `double`（`L` 时为 `long double`）参数后输出 `?`；
+ *   `%n` 取出参数后忽略；其他不认识的转换说明原样输出。
+ * - `%p` 输出 `0x` 加十六进制地址（NULL 为 `0x0`），`%s` 的 NULL 输出 `(null)`。
+ * - 十进制转换在值不超过 32 位时使用 32 位除法，`%ll` 的大数才用到 64 位除法。
+ * - 定义 `TPRINTF_KFIFO` 后提供 `kfifo_printf`，需要编译 `kfifo.c`。
+ *
+ * @version 1.0.0
+ * @date 2026-10-16
+ * @author [Jia Zhenyu]
+ */
+
+#ifndef __TPRINTF_H__
+#define __TPRINTF_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdarg.h>
+#include <stddef.h>
+
+// #define TPRINTF_KFIFO               /* 提供写入 KFIFO 的 kfifo_printf，需要编译 kfifo.c */
+
+#ifdef TPRINTF_KFIFO
+#include "kfifo.h"
+#endif
+
+#if defined(__GNUC__)
+#define __TPRINTF_CHECK(f, a) __attribute__((format(printf, f, a)))
+#else
+#define __TPRINTF_CHECK(f, a)
+#endif
+
+/**
+ * @brief 输出函数类型
+ *
+ * 格式化结果按段（一段格式化字符串中的普通字符、一个数字、填充字符等）依次传入。
+ *
+ * @param[in] ctx 调用 `tprintf_format` 时传入的上下文
+ * @param[in] s 一段字符，不以 '\0' 结尾
+ * @param[in] len 字符数
+ */
+typedef void (*tprintf_sink_func)(void *ctx, const char *s, unsigned int len);
+
+/**
+ * @brief 格式化并输出到输出函数
+ *
+ * @param[in] sink 输出函数
+ * @param[in] ctx 传给输出函数的上下文
+ * @param[in] fmt 格式化字符串
+ * @param[in] ap 可变参数
+ * @return 输出的字符数
+ */
+int tprintf_vformat(tprintf_sink_func sink, void *ctx, const char *fmt, va_list ap);
+
+/**
+ * @brief 格式化并输出到输出函数
+ *
+ * @param[in] sink 输出函数
+ * @param[in] ctx 传给输出函数的上下文
+ * @param[in] fmt 格式化字符串
+ * @param[in] ... 格式化字符串的可变参数
+ * @return 输出的字符数
+ */
+int tprintf_format(tprintf_sink_func sink, void *ctx, const char *fmt, ...) __TPRINTF_CHECK(3, 4);
+
+/**
+ * @brief 格式化到字符串，与 `vsnprintf` 相同
+ *
+ * @param[out] buf 字符串缓冲区
+ * @param[in] size 缓冲区大小，结果超出时截断，总是以 '\0' 结尾（size 为 0 时不写入）
+ * @param[in] fmt 格式化字符串
+ * @param[in] ap 可变参数
+ * @return 完整结果的字符数（不包括 '\0'），大于等于 size 时说明被截断
+ */
+int tprintf_vsnprintf(char *buf, size_t size, const char *fmt, va_list ap);
+
+/**
+ * @brief 格式化到字符串，与 `snprintf` 相同
+ *
+ * @param[out] buf 字符串缓冲区
+ * @param[in] size 缓冲区大小
+ * @param[in] fmt 格式化字符串
+ * @param[in] ... 格式化字符串的可变参数
+ * @return 完整结果的字符数（不包括 '\0'）
+ */
+int tprintf_snprintf(char *buf, size_t size, const char *fmt, ...) __TPRINTF_CHECK(3, 4);
+
+#ifdef TPRINTF_KFIFO
+/**
+ * @brief 格式化并写入 KFIFO（由 `kfifo_printf` 调用）
+ *
+ * 每一段结果直接用 `__kfifo_in` 写入，空间不足时之后的字符被丢弃。
+ *
+ * @param[in] fifo KFIFO
+ * @param[in] fmt 格式化字符串
+ * @param[in] ... 格式化字符串的可变参数
+ * @return 写入 KFIFO 的字符数
+ */
+int tprintf_kfifo(struct __kfifo *fifo, const char *fmt, ...) __TPRINTF_CHECK(2, 3);
+
+/**
+ * @brief 格式化并写入元素为 1 字节的 KFIFO（不能是记录 FIFO）
+ *
+ * @param[in] fifo KFIFO 的地址
+ * @param[in] fmt 格式化字符串
+ * @param[in] ... 格式化字符串的可变参数
+ * @return 写入 KFIFO 的字符数
+ */
+#define kfifo_printf(fifo, fmt, ...)                                                       \
+    ({                                                                                     \
+        typeof((fifo) + 1) __tmp = (fifo);                                                 \
+        (void)sizeof(char[(sizeof(*__tmp->type) == 1 && !kfifo_recsize(__tmp)) ? 1 : -1]); \
+        tprintf_kfifo(&__tmp->kfifo, (fmt), ##__VA_ARGS__);                                \
+    })
+#endif /* TPRINTF_KFIFO */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TPRINTF_H__ */